@@ -6,10 +6,18 @@
  * @date 9.04.2020
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "gamma.h"
 #include <malloc.h>
-#include <math.h>
+#include <stdlib.h>
 #include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
 #include "gamma_field.h"
 
 /**
@@ -23,6 +31,119 @@
  */
 #define DEFAULT_PLAYER_IDENTIFIER '.'
 
+/**
+ * Liczba pól otaczających pole, czyli sąsiadujących z nim bokiem lub rogiem.
+ */
+#define RING_SIZE 8
+
+/**
+ * Maksymalna liczba przeszukiwań obszaru prowadzonych naprzemiennie
+ * po usunięciu pola, równa liczbie pól sąsiadujących z nim bokiem.
+ */
+#define SPLIT_SEARCHES_COUNT 4
+
+/**
+ * Logarytm ze stosunku liczby pól gęstej planszy do liczby dodatkowych
+ * węzłów find and union, które można jej przypisać, zanim zbiory
+ * wszystkich obszarów zostaną odbudowane.
+ */
+#define EXTRA_NODES_SHIFT 5
+
+/**
+ * Numer komórki planszy przypisany w rzadkiej planszy indeksom,
+ * które nie są polami, a jedynie dodatkowymi węzłami find and union.
+ */
+#define NO_FIELD_CELL UINT64_MAX
+
+/**
+ * Liczba zapisywana na początku stanu gry przez funkcję @ref gamma_save,
+ * odpowiadająca napisowi "GMSN". Pozwala rozpoznać format zapisu
+ * oraz to, czy zapisano go przy tej samej kolejności bajtów.
+ */
+#define SNAPSHOT_MAGIC 0x4E534D47u
+
+/**
+ * Wersja formatu zapisu stanu gry.
+ */
+#define SNAPSHOT_VERSION 5
+
+/**
+ * Liczba graczy lub indeksów kafelków zapisywanych i wczytywanych
+ * jednym wywołaniem systemowym.
+ */
+#define SNAPSHOT_PLAYERS_CHUNK 256
+
+/**
+ * Wyrównanie początku obrazów kafelków w zapisie stanu gry, równe
+ * rozmiarowi strony pamięci, aby funkcja @ref gamma_map mogła używać
+ * kafelków bezpośrednio z odwzorowanego pliku. Stosowane tylko wtedy,
+ * gdy węzły zajmują więcej niż jeden kafelek.
+ */
+#define SNAPSHOT_TILES_ALIGNMENT 4096
+
+/**
+ * Rodzaj wpisu dziennika zapisu z wyprzedzeniem oznaczający ruch.
+ */
+#define WAL_MOVE 1
+
+/**
+ * Rodzaj wpisu dziennika zapisu z wyprzedzeniem oznaczający złoty ruch.
+ */
+#define WAL_GOLDEN_MOVE 2
+
+/**
+ * Rodzaj wpisu dziennika zapisu z wyprzedzeniem rozpoczynającego segment
+ * dopisany przez jedno wywołanie funkcji @ref gamma_wal_open.
+ */
+#define WAL_SEGMENT 3
+
+/**
+ * Liczba najmłodszych bitów znacznika wpisu dziennika zawierających
+ * rodzaj wpisu; pozostałe bity zawierają sumę kontrolną.
+ */
+#define WAL_KIND_BITS 8
+
+/**
+ * Wersja formatu dziennika zapisu z wyprzedzeniem.
+ */
+#define WAL_VERSION 1
+
+/**
+ * Maksymalna liczba ruchów, których zapis może zostać odłożony
+ * do wspólnej synchronizacji dziennika.
+ */
+#define WAL_MAX_GROUP_MOVES ((uint32_t) 1 << 16)
+
+/**
+ * Liczba wpisów dziennika wczytywanych jednym wywołaniem systemowym.
+ */
+#define WAL_READ_CHUNK 256
+
+/**
+ * Rozmiar bufora, w którym funkcja @ref gamma_board_write składa opis
+ * planszy przed zapisaniem go jednym wywołaniem systemowym.
+ */
+#define BOARD_WRITE_CHUNK 65536
+
+/**
+ * Największa liczba graczy, dla której opisy pól kolejnych graczy są
+ * przygotowywane z góry w tablicy.
+ */
+#define OWNER_TOKENS_MAX_PLAYERS ((uint32_t) 1 << 20)
+
+/**
+ * Przesunięcia numerów kolumn pól otaczających pole, wymienionych
+ * kolejno dookoła niego. Każde dwa kolejne pola otoczenia sąsiadują bokiem,
+ * a pola o parzystych indeksach sąsiadują bokiem z polem środkowym.
+ */
+static const int32_t RING_DX[RING_SIZE] = {1, 1, 0, -1, -1, -1, 0, 1};
+
+/**
+ * Przesunięcia numerów wierszy pól otaczających pole,
+ * w tej samej kolejności co w @ref RING_DX.
+ */
+static const int32_t RING_DY[RING_SIZE] = {0, 1, 1, 1, 0, -1, -1, -1};
+
 /**
  * Struktura przechowująca dane o jednym graczu.
  */
@@ -33,22 +154,308 @@ typedef struct {
                                     ///< pionek bez zwiększania liczby obszarów
     bool has_golden_move_available; ///< zmienna mówiąca o tym, czy gracz
                                     ///< może jeszcze wykonać ruch
+    uint64_t golden_targets;        ///< liczba pól innych graczy sąsiadujących
+                                    ///< z polami gracza
+    uint64_t safe_golden_targets;   ///< liczba tych spośród @p golden_targets,
+                                    ///< których zajęcie na pewno nie podzieli
+                                    ///< obszaru ich właściciela
+    uint64_t journaled_move;        ///< numer ostatniego ruchu, przed którym
+                                    ///< stan gracza zapisano w dzienniku
 } player_t;
 
+/**
+ * Pola, od których można przejść wszystkie obszary jednego gracza.
+ * Każdy obszar gracza zawiera co najmniej jedno z pól tablicy @p fields,
+ * ale pola mogą się powtarzać w obrębie obszaru lub należeć już do innych
+ * graczy, bo przy zmianach właścicieli pola są jedynie dopisywane.
+ */
+typedef struct {
+    uint32_t *fields;               ///< indeksy pól lub NULL, jeśli pola
+                                    ///< obszarów gracza nie są znane
+    uint32_t count;                 ///< liczba indeksów w @p fields
+    uint32_t capacity;              ///< rozmiar tablicy @p fields
+} area_starts;
+
+/**
+ * Struktura przechowująca dane pola wykorzystywane przez przeszukiwanie
+ * obszaru w głąb w funkcji @ref compute_areas_after_removal.
+ */
+typedef struct {
+    uint32_t order;                 ///< numer pola w kolejności odwiedzania
+    uint32_t low;                   ///< najmniejszy numer pola osiągalnego
+                                    ///< z poddrzewa pola jedną krawędzią
+                                    ///< spoza drzewa przeszukiwania
+    uint8_t next_direction;         ///< indeks następnego sąsiada do sprawdzenia
+                                    ///< w tablicach @ref RING_DX i @ref RING_DY
+    uint8_t areas_after_removal;    ///< liczba obszarów, na które rozpadną się
+                                    ///< sąsiednie pola właściciela po usunięciu pola
+} dfs_field;
+
+/**
+ * Struktura przechowująca zapisany w dzienniku stan gracza sprzed ruchu.
+ */
+typedef struct {
+    uint32_t index;                 ///< indeks gracza
+    player_t player;                ///< stan gracza sprzed ruchu
+} player_change;
+
+/**
+ * Struktura przechowująca dane potrzebne do cofnięcia jednego ruchu.
+ */
+typedef struct {
+    uint64_t field_changes;         ///< liczba zmian w dzienniku zmian pól
+                                    ///< przed ruchem
+    uint64_t player_changes;        ///< liczba zapisanych stanów graczy
+                                    ///< przed ruchem
+    uint64_t free_fields;           ///< liczba wolnych pól przed ruchem
+    uint64_t nodes_count;           ///< liczba węzłów find and union
+                                    ///< przed ruchem
+    uint32_t players_with_fields;   ///< liczba graczy posiadających jakieś
+                                    ///< pole przed ruchem
+} move_record;
+
+/**
+ * Struktura przechowująca dziennik ruchów, które można cofnąć.
+ * Każdy ruch zapisuje jedynie zmienione przez siebie dane.
+ */
+typedef struct {
+    field_journal *fields;          ///< dziennik zmian pól i węzłów
+    player_change *players;         ///< stany graczy sprzed ich zmian
+    uint64_t players_count;         ///< liczba zapisanych stanów graczy
+    uint64_t players_capacity;      ///< rozmiar tablicy @p players
+    move_record *moves;             ///< ruchy, które można cofnąć
+    uint64_t moves_count;           ///< liczba ruchów, które można cofnąć
+    uint64_t moves_capacity;        ///< rozmiar tablicy @p moves
+    bool has_failed;                ///< zmienna mówiąca o tym, czy nie udało
+                                    ///< się zapisać zmiany w obecnym ruchu
+} undo_log;
+
+/**
+ * Struktura przechowująca stan naprzemiennych przeszukiwań obszaru
+ * po usunięciu pola, prowadzonych od pól sąsiadujących z nim bokiem.
+ */
+typedef struct {
+    uint32_t starts[SPLIT_SEARCHES_COUNT]; ///< pola, od których zaczynają się
+                                           ///< przeszukiwania
+    uint32_t group[SPLIT_SEARCHES_COUNT];  ///< rodzice przeszukiwań w ramach
+                                           ///< grup przeszukiwań, które
+                                           ///< dotarły do tego samego obszaru
+    uint64_t sizes[SPLIT_SEARCHES_COUNT];  ///< liczby odwiedzonych pól;
+                                           ///< po zakończeniu przeszukiwań
+                                           ///< reprezentant grupy przechowuje
+                                           ///< sumę dla całej grupy
+    uint32_t searches;                     ///< liczba przeszukiwań
+    uint32_t kept;                         ///< grupa, której obszar zachowuje
+                                           ///< dotychczasowy zbiór
+} split_search;
+
+/**
+ * Sposoby aktualizacji zbiorów find and union po usunięciu pionka z pola.
+ */
+typedef enum {
+    REMOVAL_LAST_FIELD,   ///< pole było jedynym polem swojego obszaru
+    REMOVAL_DETACH,       ///< obszar się nie dzieli, a pole dostaje nowy węzeł
+    REMOVAL_SPLIT,        ///< pola mniejszych obszarów po podziale
+                          ///< dostają nowe węzły
+    REMOVAL_REBUILD       ///< zabrakło miejsca na nowe węzły, więc zbiory
+                          ///< wszystkich obszarów są odbudowywane
+} removal_kind;
+
+/**
+ * Struktura przechowująca plan usunięcia pionka z pola, wyznaczony
+ * przed zmianą stanu gry.
+ */
+typedef struct {
+    removal_kind kind;    ///< sposób aktualizacji zbiorów find and union
+    uint32_t areas_count; ///< liczba obszarów gracza sąsiadujących z polem
+                          ///< po usunięciu pionka
+    split_search search;  ///< wynik przeszukiwań dla @ref REMOVAL_SPLIT
+} removal_plan;
+
+/**
+ * Nagłówek zapisu stanu gry. Za nagłówkiem znajdują się kolejno:
+ * @p players_count struktur @ref snapshot_player, w rzadkiej planszy
+ * @p nodes_count numerów komórek pól o kolejnych indeksach,
+ * @p field_nodes_count struktur @ref snapshot_node, rosnące indeksy
+ * @p tiles_count zaalokowanych kafelków tablicy pól typu uint64_t,
+ * zera dopełniające do wielokrotności @ref SNAPSHOT_TILES_ALIGNMENT,
+ * a następnie obrazy tych kafelków w postaci struktur @ref field_tile
+ * z licznikiem odwołań równym 1. Obraz ostatniego kafelka z wykorzystanymi
+ * węzłami jest obcięty do pól o indeksach mniejszych od @p nodes_count,
+ * więc zapis małej planszy nie zajmuje całego kafelka. Wszystkie liczby są zapisane
+ * w kolejności bajtów komputera, na którym zapisano stan gry.
+ */
+typedef struct {
+    uint32_t magic;                 ///< wartość @ref SNAPSHOT_MAGIC
+    uint32_t version;               ///< wartość @ref SNAPSHOT_VERSION
+    uint32_t board_width;           ///< liczba kolumn planszy
+    uint32_t board_height;          ///< liczba wierszy planszy
+    uint32_t players_count;         ///< liczba graczy
+    uint32_t max_areas;             ///< maksymalna liczba obszarów gracza
+    uint32_t players_with_fields;   ///< liczba graczy posiadających jakieś pole
+    uint32_t is_sparse;             ///< 1 dla rzadkiej planszy, 0 dla gęstej
+    uint64_t free_fields;           ///< liczba wolnych pól
+    uint64_t nodes_count;           ///< liczba wykorzystanych węzłów
+    uint64_t nodes_capacity;        ///< rozmiar tablicy pól
+    uint64_t tiles_count;           ///< liczba zapisanych kafelków
+    uint64_t applied_moves;         ///< liczba wykonanych ruchów
+    uint64_t field_nodes_count;     ///< liczba pól z dodatkowymi węzłami
+} snapshot_header;
+
+/**
+ * Zapis dodatkowego węzła find and union przypisanego polu.
+ */
+typedef struct {
+    uint32_t field;                 ///< indeks pola
+    uint32_t node;                  ///< indeks węzła pola
+} snapshot_node;
+
+/**
+ * Zapis stanu jednego gracza, bez danych dziennika cofania ruchów.
+ */
+typedef struct {
+    uint32_t number_of_areas;           ///< liczba obszarów gracza
+    uint32_t number_of_fields;          ///< liczba pól gracza
+    uint32_t adjacent_fields;           ///< liczba wolnych pól sąsiadujących
+                                        ///< z polami gracza
+    uint32_t has_golden_move_available; ///< 1, jeśli gracz może wykonać
+                                        ///< złoty ruch, 0 w przeciwnym wypadku
+    uint64_t golden_targets;            ///< liczba pól innych graczy
+                                        ///< sąsiadujących z polami gracza
+    uint64_t safe_golden_targets;       ///< liczba tych z nich, których zajęcie
+                                        ///< nie podzieli obszaru właściciela
+} snapshot_player;
+
+_Static_assert(sizeof(field_tile) ==
+                   sizeof(atomic_uint) + FIELD_TILE_SIZE * sizeof(gamma_field),
+               "obraz kafelka w zapisie stanu gry musi być strukturą field_tile");
+
+/**
+ * Wpis dziennika zapisu z wyprzedzeniem. Wpis rozpoczynający segment
+ * zawiera w polu @p player wersję formatu, a w polach @p x i @p y
+ * odpowiednio młodszą i starszą połowę numeru pierwszego ruchu segmentu.
+ * Suma kontrolna wpisu ruchu obejmuje też jego numer, więc wpisy
+ * pozostałe z wcześniejszej historii gry nie zostaną uznane za poprawne.
+ */
+typedef struct {
+    uint32_t tag;       ///< rodzaj wpisu na @ref WAL_KIND_BITS najmłodszych
+                        ///< bitach, a na pozostałych suma kontrolna
+    uint32_t player;    ///< numer gracza wykonującego ruch
+    uint32_t x;         ///< numer kolumny pola
+    uint32_t y;         ///< numer wiersza pola
+} wal_entry;
+
+/**
+ * Dziennik zapisu z wyprzedzeniem, do którego dopisywane są wykonane ruchy.
+ * Wpisy są zbierane w buforze i zapisywane wraz z synchronizacją pliku
+ * grupami, co @p group_moves ruchów lub gdy najstarszy niezapisany ruch
+ * czeka co najmniej @p group_ns nanosekund.
+ */
+typedef struct {
+    int fd;                     ///< deskryptor pliku dziennika
+    int error;                  ///< wartość @p errno pierwszego błędu zapisu
+    bool has_failed;            ///< czy zapis dziennika się nie powiódł;
+                                ///< kolejne ruchy nie są wtedy zapisywane
+    uint32_t group_moves;       ///< maksymalna liczba wpisów w buforze
+    uint32_t pending_count;     ///< liczba wpisów w buforze
+    uint64_t group_ns;          ///< maksymalny czas oczekiwania wpisu
+                                ///< w buforze lub 0, jeśli nieograniczony
+    uint64_t first_pending_ns;  ///< czas dodania najstarszego wpisu bufora
+    wal_entry *pending;         ///< bufor niezapisanych wpisów
+} move_wal;
+
+/**
+ * Zapis rozgrywki pozwalający odtworzyć stan gry po dowolnym ruchu.
+ * Co @p interval ruchów przechowywana jest kopia stanu gry współdzieląca
+ * niezmienione kafelki tablicy pól z kolejnymi kopiami, więc każda kopia
+ * zajmuje jedynie tablicę wskaźników na kafelki, graczy oraz kafelki
+ * zmienione od poprzedniej kopii.
+ */
+struct gamma_replay {
+    gamma_t *head;              ///< stan gry po wszystkich zapisanych ruchach
+    gamma_t *cursor;            ///< stan gry zwrócony przez ostatnie
+                                ///< wywołanie @ref gamma_replay_seek lub NULL
+    uint64_t cursor_moves;      ///< liczba ruchów wykonanych na @p cursor
+                                ///< przez @ref gamma_replay_seek
+    gamma_t **checkpoints;      ///< kopie stanu gry po wielokrotnościach
+                                ///< @p interval ruchów, rosnąco według
+                                ///< liczby ruchów, bez tych, których nie
+                                ///< udało się utworzyć, i bez struktur
+                                ///< pomocniczych przeszukiwań
+    uint64_t checkpoints_count; ///< liczba kopii stanu gry
+    uint64_t checkpoints_capacity; ///< rozmiar tablicy @p checkpoints
+    wal_entry *moves;           ///< zapisane ruchy, z rodzajem ruchu
+                                ///< w składowej @p tag
+    uint64_t moves_capacity;    ///< rozmiar tablicy @p moves
+    uint32_t interval;          ///< liczba ruchów między kopiami stanu gry
+};
+
 /**
  * Struktura przechowująca stan gry.
  */
 struct gamma {
     player_t *players;            ///< tablica przechowująca informacje o graczach
-    gamma_field **fields;         ///< tablica przechowująca informacje o polach
-    bool **visited_fields_board;  ///< tablica odwiedzonych pól, wykorzystywana
-                                  ///< podczas przechodzenia planszy w funkcji
-                                  ///< @ref set_field_as_set_root
+    field_board fields;           ///< tablica przechowująca informacje o polach,
+                                  ///< pole (x, y) ma indeks y * board_width + x;
+                                  ///< za polami planszy znajdują się dodatkowe
+                                  ///< węzły find and union; kafelki tablicy
+                                  ///< mogą być współdzielone z kopiami gry
+    uint64_t nodes_count;         ///< liczba wykorzystanych węzłów w @p fields
+    uint64_t nodes_capacity;      ///< rozmiar tablicy @p fields
+    field_map *sparse_fields;     ///< w rzadkiej planszy mapa z numerów komórek
+                                  ///< y * board_width + x w indeksy pól
+                                  ///< w @p fields, a w gęstej planszy NULL;
+                                  ///< pola i dodatkowe węzły rzadkiej planszy
+                                  ///< dzielą numerację w @p fields
+    uint64_t *field_cells;        ///< w rzadkiej planszy numery komórek pól
+                                  ///< o kolejnych indeksach lub
+                                  ///< @ref NO_FIELD_CELL dla dodatkowych węzłów
+    field_map *field_nodes;       ///< mapa z indeksów pól w indeksy
+                                  ///< przypisanych im dodatkowych węzłów
+                                  ///< find and union; pozostałym polom
+                                  ///< odpowiada węzeł o indeksie pola
+    uint32_t *visited_fields_board; ///< tablica odwiedzonych pól, wykorzystywana
+                                  ///< podczas przechodzenia planszy; pole jest
+                                  ///< odwiedzone, jeśli jego wartość jest
+                                  ///< równa składowej @p visited_epoch
+    uint32_t visited_epoch;       ///< numer obecnego przejścia planszy
+    field_queue *queue;           ///< kolejka wykorzystywana przez algorytm BFS,
+                                  ///< mieści indeksy wszystkich pól planszy
+    field_queue *split_queues[SPLIT_SEARCHES_COUNT]; ///< kolejki przeszukiwań
+                                  ///< obszaru po usunięciu pola, alokowane
+                                  ///< przy pierwszym użyciu
+    dfs_field *dfs_fields;        ///< dane pól dla przeszukiwania w głąb,
+                                  ///< alokowane przy pierwszym użyciu
+    uint32_t *dfs_stack;          ///< stos przeszukiwania w głąb,
+                                  ///< alokowany razem z @p dfs_fields
+    undo_log *undo;               ///< dziennik ruchów lub NULL, jeśli cofanie
+                                  ///< ruchów jest wyłączone
+    uint64_t move_number;         ///< numer ostatniego ruchu zapisanego
+                                  ///< w dzienniku
+    uint64_t applied_moves;       ///< liczba wykonanych i niecofniętych ruchów,
+                                  ///< czyli numer następnego ruchu
+    move_wal *wal;                ///< dziennik zapisu z wyprzedzeniem lub NULL
+    char *rendered_board;         ///< opis planszy zwracany przez funkcję
+                                  ///< @ref gamma_board_view, aktualizowany
+                                  ///< przy każdej zmianie właściciela pola,
+                                  ///< lub NULL, jeśli jeszcze go nie utworzono
+    char *owner_tokens;           ///< opisy pól kolejnych graczy zwracane
+                                  ///< przez funkcję @ref owner_tokens lub NULL
+    area_starts *area_starts;     ///< pola obszarów kolejnych graczy,
+                                  ///< aktualizowane przy każdej zmianie
+                                  ///< właściciela pola, lub NULL, jeśli
+                                  ///< jeszcze ich nie wyszukano
+    uint64_t split_checks;        ///< liczba sprawdzeń, czy usunięcie pola
+                                  ///< podzieli obszar jego właściciela
+    uint64_t split_checks_resolved_locally; ///< liczba tych sprawdzeń
+                                  ///< rozstrzygniętych na podstawie otoczenia
+                                  ///< pola, bez przechodzenia obszaru
     uint32_t board_width;         ///< liczba kolumn planszy
     uint32_t board_height;        ///< liczba wierszy planszy
     uint32_t max_areas;           ///< maksymalna liczba obszarów, jakie
                                   ///< jeden gracz może kontrolować
     uint32_t players_count;       ///< liczba graczy
+    uint32_t players_with_fields; ///< liczba graczy posiadających jakieś pole
     uint64_t free_fields;         ///< pola na planszy nienależące do żadnego gracza
 };
 
@@ -66,65 +473,307 @@ static inline bool are_gamma_new_parameters_valid(uint32_t width, uint32_t heigh
     return !(width == 0 || height == 0 || players == 0 || areas == 0);
 }
 
-/** @brief Zwalnia zaalokowaną pamięć w dwuwymiarowej tablicy gamma_field.
- * Zwalnia pamięć zaalokowaną na pierwsze @p columns_count wskaźników w tablicy
- * @p fields oraz zwalnia pamięć zaalokowaną na wskaźnik @p fields.
- * @param[in] fields         – dwuwymiarowa tablica zmiennych typu gamma_field
- * @param[in] columns_count  – liczba zaalokowanych wskaźników w tablicy fields.
+/** @brief Podaje liczbę pól na planszy.
+ * @param[in] board      – wskaźnik na strukturę przechowującą dane gry.
+ * @return Iloczyn szerokości i wysokości planszy.
+ */
+static inline uint64_t fields_count(gamma_t *board) {
+    return (uint64_t) board->board_width * (uint64_t) board->board_height;
+}
+
+/** @brief Podaje rozmiar tablicy pól gęstej planszy.
+ * Za polami planszy znajduje się miejsce na dodatkowe węzły find and union,
+ * których jest 2^@ref EXTRA_NODES_SHIFT razy mniej niż pól,
+ * ale nie mniej niż pól w jednym kafelku.
+ * @param[in] count      – liczba pól planszy.
+ * @return Rozmiar tablicy pól.
+ */
+static inline uint64_t dense_nodes_capacity(uint64_t count) {
+    uint64_t extra_nodes = count >> EXTRA_NODES_SHIFT;
+    return count + ((extra_nodes < FIELD_TILE_SIZE) ? FIELD_TILE_SIZE : extra_nodes);
+}
+
+/** @brief Sprawdza, czy plansza jest przechowywana rzadko.
+ * @param[in] g      – wskaźnik na strukturę przechowującą dane gry.
+ * @return Wartość @p true, jeśli przechowywane są jedynie pola, do których
+ * coś zapisano, lub @p false, jeśli przechowywane są wszystkie pola.
+ */
+static inline bool is_board_sparse(const gamma_t *g) {
+    return g->sparse_fields != NULL;
+}
+
+/** @brief Podaje liczbę indeksów pól, które mogą wystąpić w przejściu planszy.
+ * Od tej liczby zależy rozmiar mapy odwiedzonych pól i kolejek.
+ * @param[in] g      – wskaźnik na strukturę przechowującą dane gry.
+ * @return Liczba pól gęstej planszy lub rozmiar tablicy @p fields
+ * rzadkiej planszy.
+ */
+static inline uint64_t indices_count(gamma_t *g) {
+    return is_board_sparse(g) ? g->nodes_capacity : fields_count(g);
+}
+
+/** @brief Podaje indeks pola w tablicy pól.
+ * @param[in] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] x      – numer kolumny, mniejszy od składowej @p board_width,
+ * @param[in] y      – numer wiersza, mniejszy od składowej @p board_height.
+ * @return Indeks pola (@p x, @p y) w tablicy @p fields lub
+ * @ref FIELD_MAP_ABSENT, jeśli plansza jest rzadka, a do pola
+ * nic nie zapisano.
  */
-static void free_board(gamma_field **fields, uint32_t columns_count) {
-    for (uint32_t i = 0; i < columns_count; i++) {
-        free(fields[i]);
+static inline uint32_t field_index(gamma_t *g, uint32_t x, uint32_t y) {
+    if (is_board_sparse(g)) {
+        return field_map_find(g->sparse_fields, (uint64_t) y * g->board_width + x);
     }
-    free(fields);
+    return y * g->board_width + x;
+}
+
+/** @brief Podaje współrzędne pola o danym indeksie.
+ * @param[in] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index  – indeks pola,
+ * @param[out] x     – numer kolumny pola,
+ * @param[out] y     – numer wiersza pola.
+ */
+static inline void field_coordinates(gamma_t *g, uint32_t index,
+                                     uint32_t *x, uint32_t *y) {
+    uint64_t cell = is_board_sparse(g) ? g->field_cells[index] : index;
+    *x = cell % g->board_width;
+    *y = cell / g->board_width;
+}
+
+/** @brief Daje wskaźnik na pole o danych współrzędnych.
+ * @param[in] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] x      – numer kolumny, mniejszy od składowej @p board_width,
+ * @param[in] y      – numer wiersza, mniejszy od składowej @p board_height.
+ * @return Wskaźnik na pole (@p x, @p y).
+ */
+static inline const gamma_field *get_field(gamma_t *g, uint32_t x, uint32_t y) {
+    uint32_t index = field_index(g, x, y);
+    return (index == FIELD_MAP_ABSENT) ? &FREE_FIELD
+                                       : field_board_get(&g->fields, index);
+}
+
+/** @brief Daje wskaźnik na pole lub węzeł o danym indeksie do odczytu.
+ * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks pola lub węzła.
+ * @return Wskaźnik na pole lub węzeł o indeksie @p index.
+ */
+static inline const gamma_field *field_at(gamma_t *g, uint32_t index) {
+    return field_board_get(&g->fields, index);
+}
+
+/** @brief Daje wskaźnik na pole lub węzeł o danym indeksie do zapisu.
+ * Kafelek z polem musi być wcześniej przygotowany do zapisu,
+ * patrz @ref field_board_get_for_write.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks pola lub węzła.
+ * @return Wskaźnik na pole lub węzeł o indeksie @p index.
+ */
+static inline gamma_field *field_for_write(gamma_t *g, uint32_t index) {
+    return field_board_get_for_write(&g->fields, index);
 }
 
-/** @brief Zwalnia zaalokowaną pamięć w dwuwymiarowej tablicy gamma_field.
- * Zwalnia pamięć zaalokowaną na pierwsze @p columns_count wskaźników w tablicy
- * @p map oraz zwalnia pamięć zaalokowaną na wskaźnik @p map.
- * @param[in] map            – tablica "odwiedzonych" przez algorytm BFS pól,
- * @param[in] columns_count  – liczba zaalokowanych wskaźników w tablicy map.
+/** @brief Podaje indeksy pól sąsiadujących bokiem z danym polem.
+ * Pomija pola spoza planszy, a w rzadkiej planszy także pola,
+ * do których nic nie zapisano, więc żadne z nich nie należy do gracza.
+ * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks pola,
+ * @param[out] adjacent  – tablica na co najmniej cztery indeksy pól.
+ * @return Liczba indeksów zapisanych w tablicy @p adjacent.
  */
-static void free_visited_map(bool **map, uint32_t columns_count) {
-    for (uint32_t i = 0; i < columns_count; i++) {
-        free(map[i]);
+static inline uint32_t adjacent_field_indices(gamma_t *g, uint32_t index,
+                                              uint32_t *adjacent) {
+    uint32_t width = g->board_width;
+    uint32_t count = 0;
+    if (!is_board_sparse(g)) {
+        uint32_t curr_x = index % width;
+        if (curr_x + 1 < width) {
+            adjacent[count++] = index + 1;
+        }
+        if (curr_x > 0) {
+            adjacent[count++] = index - 1;
+        }
+        if (index + (uint64_t) width < fields_count(g)) {
+            adjacent[count++] = index + width;
+        }
+        if (index >= width) {
+            adjacent[count++] = index - width;
+        }
+        return count;
     }
-    free(map);
+
+    uint32_t x, y;
+    field_coordinates(g, index, &x, &y);
+    for (int32_t i = 0; i < RING_SIZE; i += 2) {
+        uint32_t adjacent_x = x + RING_DX[i];
+        uint32_t adjacent_y = y + RING_DY[i];
+        if (adjacent_x < width && adjacent_y < g->board_height) {
+            uint32_t adjacent_index = field_index(g, adjacent_x, adjacent_y);
+            if (adjacent_index != FIELD_MAP_ABSENT) {
+                adjacent[count++] = adjacent_index;
+            }
+        }
+    }
+    return count;
 }
 
-/** @brief Alokuje pamięć potrzebną do przechowywania danych o polach.
- * Alokuje pamięć potrzebną do przechowywania danych o polach w składowej fields
- * zmiennej @p board i ustawia domyślne wartości każdego z pól. W przypadku
- * niepowodzenia, zwalnia dotychczas zaalokowaną w tej funkcji pamięć.
- * @param[in,out] board      – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] width          – szerokość planszy, liczba dodatnia,
- * @param[in] height         – wysokość planszy, liczba dodatnia.
- * @return Wartość @p true jeśli alokacja się powiodła i @p false w przeciwnym
- * wypadku.
+/** @brief Podaje węzeł find and union przypisany polu.
+ * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks pola.
+ * @return Indeks węzła pola w tablicy @p fields.
+ */
+static inline uint32_t field_node(gamma_t *g, uint32_t index) {
+    uint32_t node = field_map_find(g->field_nodes, index);
+    return (node == FIELD_MAP_ABSENT) ? index : node;
+}
+
+/** @brief Podaje dziennik zmian pól.
+ * @param[in] g          – wskaźnik na strukturę przechowującą dane gry.
+ * @return Wskaźnik na dziennik zmian pól lub @p NULL, jeśli cofanie
+ * ruchów jest wyłączone.
+ */
+static inline field_journal *fields_journal(gamma_t *g) {
+    return (g->undo == NULL) ? NULL : g->undo->fields;
+}
+
+/** @brief Zapisuje zmianę pola lub węzła w dzienniku ruchów.
+ * Nic nie robi, jeśli cofanie ruchów jest wyłączone.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] kind       – rodzaj zmiany,
+ * @param[in] index      – indeks pola lub węzła,
+ * @param[in] old_value  – wartość sprzed zmiany.
+ */
+static inline void record_field_change(gamma_t *g, field_change_kind kind,
+                                       uint32_t index, uint32_t old_value) {
+    if (g->undo != NULL) {
+        field_journal_record(g->undo->fields, kind, index, old_value);
+    }
+}
+
+/** @brief Zmienia rodzica węzła find and union.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] node       – indeks węzła,
+ * @param[in] parent     – nowa wartość składowej @p parent węzła.
+ */
+static inline void set_node_parent(gamma_t *g, uint32_t node, uint32_t parent) {
+    gamma_field *field = field_for_write(g, node);
+    record_field_change(g, FIELD_PARENT_CHANGE, node, field->parent);
+    field->parent = parent;
+}
+
+/** @brief Przypisuje polu węzeł find and union w mapie węzłów.
+ * Węzeł o indeksie pola nie zajmuje miejsca w mapie. Dodatkowy węzeł
+ * nie może wymagać powiększenia mapy, patrz @ref field_map_set.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks pola,
+ * @param[in] node       – indeks węzła.
+ */
+static inline void assign_field_node(gamma_t *g, uint32_t index, uint32_t node) {
+    if (node == index) {
+        field_map_erase(g->field_nodes, index);
+    }
+    else {
+        field_map_set(g->field_nodes, index, node);
+    }
+}
+
+/** @brief Zmienia węzeł find and union przypisany polu.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks pola,
+ * @param[in] node       – indeks nowego węzła pola.
  */
-static bool allocate_board(gamma_t *board, uint32_t width, uint32_t height) {
-    board->fields = malloc(width * sizeof(gamma_field *));
-    if (board->fields == NULL) {
+static inline void set_field_node(gamma_t *g, uint32_t index, uint32_t node) {
+    record_field_change(g, FIELD_NODE_CHANGE, index, field_node(g, index));
+    assign_field_node(g, index, node);
+}
+
+/** @brief Podwaja rozmiar tablicy dziennika ruchów.
+ * @param[in, out] array     – wskaźnik na tablicę,
+ * @param[in, out] capacity  – wskaźnik na rozmiar tablicy,
+ * @param[in] element_size   – rozmiar elementu tablicy.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku, wtedy tablica pozostaje bez zmian.
+ */
+static bool grow_undo_array(void **array, uint64_t *capacity, size_t element_size) {
+    uint64_t new_capacity = (*capacity == 0) ? 16 : 2 * *capacity;
+    void *new_array = realloc(*array, new_capacity * element_size);
+    if (new_array == NULL) {
         return false;
     }
+    *array = new_array;
+    *capacity = new_capacity;
+    return true;
+}
 
-    for (uint32_t i = 0; i < width; i++) {
-        board->fields[i] = malloc(height * sizeof(gamma_field));
-        if (board->fields[i] == NULL) {
-            free_board(board->fields, i);
-            return false;
+/** @brief Podaje gracza, którego dane zostaną zmienione.
+ * Jeśli cofanie ruchów jest włączone, a stan gracza nie został jeszcze
+ * zapisany w dzienniku w obecnym ruchu, zapisuje go.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] player     – indeks gracza, liczba dodatnia
+ *                         i niewiększa od składowej @p players_count.
+ * @return Wskaźnik na dane gracza.
+ */
+static player_t *player_for_update(gamma_t *g, uint32_t player) {
+    player_t *p = &g->players[player - 1];
+    undo_log *undo = g->undo;
+    if (undo != NULL && p->journaled_move != g->move_number) {
+        if (undo->players_count == undo->players_capacity &&
+            !grow_undo_array((void **) &undo->players, &undo->players_capacity,
+                             sizeof(player_change))) {
+            undo->has_failed = true;
         }
         else {
-            for (uint32_t j = 0; j < height; j++) {
-                board->fields[i][j].owner_index = DEFAULT_PLAYER_NUMBER;
-                board->fields[i][j].parent_x = i;
-                board->fields[i][j].parent_y = j;
-                board->fields[i][j].this_x = i;
-                board->fields[i][j].this_y = j;
-                board->fields[i][j].rank = 0;
-            }
+            undo->players[undo->players_count].index = player;
+            undo->players[undo->players_count].player = *p;
+            (undo->players_count)++;
         }
+        p->journaled_move = g->move_number;
+    }
+    return p;
+}
+
+/** @brief Zwalnia pamięć przechowującą dane o polach.
+ * Zwalnia tablicę pól oraz, w przypadku rzadkiej planszy, mapę z numerów
+ * komórek w indeksy pól i tablicę numerów komórek.
+ * @param[in,out] board      – wskaźnik na strukturę przechowującą dane gry.
+ */
+static void free_board(gamma_t *board) {
+    field_board_clear(&board->fields);
+    field_map_clear(&board->field_nodes);
+    field_map_clear(&board->sparse_fields);
+    free(board->field_cells);
+    board->field_cells = NULL;
+}
+
+/** @brief Tworzy kopię danych o polach.
+ * Kopia tablicy pól współdzieli z oryginałem kafelki, a mapa rzadkiej
+ * planszy i tablica numerów komórek są kopiowane.
+ * @param[out] copy          – wskaźnik na strukturę kopii gry,
+ * @param[in] board          – wskaźnik na strukturę kopiowanej gry.
+ * @return Wartość @p true jeśli alokacja się powiodła i @p false w przeciwnym
+ * wypadku.
+ */
+static bool clone_board(gamma_t *copy, const gamma_t *board) {
+    copy->sparse_fields = NULL;
+    copy->field_cells = NULL;
+    if (!field_map_clone(&copy->field_nodes, board->field_nodes)) {
+        return false;
+    }
+    else if (!field_board_clone(&copy->fields, &board->fields)) {
+        field_map_clear(&copy->field_nodes);
+        return false;
+    }
+    else if (!is_board_sparse(board)) {
+        return true;
     }
+
+    copy->field_cells = malloc(board->nodes_capacity * sizeof(uint64_t));
+    if (copy->field_cells == NULL ||
+        !field_map_clone(&copy->sparse_fields, board->sparse_fields)) {
+        free_board(copy);
+        return false;
+    }
+    memcpy(copy->field_cells, board->field_cells,
+           board->nodes_count * sizeof(uint64_t));
     return true;
 }
 
@@ -146,92 +795,195 @@ static bool allocate_players(gamma_t *board, uint32_t players) {
             board->players[i].number_of_fields = 0;
             board->players[i].adjacent_fields = 0;
             board->players[i].has_golden_move_available = true;
+            board->players[i].golden_targets = 0;
+            board->players[i].safe_golden_targets = 0;
+            board->players[i].journaled_move = 0;
         }
     }
     return true;
 }
 
 /** @brief Alokuje pamięć potrzebną do przechowywania mapy odwiedzonych pól.
- * Alokuje dwuwymiarową tablicę w składowej map zmiennej @p board. Tablica
- * ma wymiary @p board_width i @p board_height będące składowymi zmiennej @p board.
+ * Alokuje jednowymiarową tablicę w składowej visited_fields_board zmiennej
+ * @p board, o rozmiarze równym liczbie pól planszy, i zeruje ją.
+ * Numer pierwszego przejścia planszy to 1, więc żadne pole
+ * nie jest początkowo odwiedzone.
  * @param[in,out] board      – wskaźnik na strukturę przechowującą dane gry,.
  * @return Wartość @p true jeśli alokacja się powiodła i @p false w przeciwnym
  * wypadku.
  */
 static bool allocate_visited_map(gamma_t *board) {
-    board->visited_fields_board = malloc(board->board_width * sizeof(bool *));
+    uint64_t count = indices_count(board);
+    board->visited_fields_board = calloc(count, sizeof(uint32_t));
     if (board->visited_fields_board == NULL) {
         return false;
     }
-
-    for (uint32_t i = 0; i < board->board_width; i++) {
-        board->visited_fields_board[i] = malloc(board->board_height * sizeof(gamma_field));
-        if (board->visited_fields_board[i] == NULL) {
-            free_visited_map(board->visited_fields_board, i);
-            return false;
-        }
-        else {
-            for (uint32_t j = 0; j < board->board_height; j++) {
-                board->visited_fields_board[i][j] = false;
-            }
-        }
-    }
+    board->visited_epoch = 1;
     return true;
 }
 
-/** @brief Ustawia wszystkie wartości mapy odwiedzonych pól na @p false.
- * Ustawia wszystkie pola dwuwymiarowej tablicy @p map, będącej składową
- * zmiennej @p board na @p false.
- * @param[in,out] board      – wskaźnik na strukturę przechowującą dane gry,
+/** @brief Alokuje pamięć potrzebną do przechodzenia planszy.
+ * Jeśli składowe @p visited_fields_board i @p queue nie zostały jeszcze
+ * zaalokowane, alokuje je. Kopie gry alokują je dopiero przy pierwszym
+ * przejściu planszy, więc kopia, która nie przechodzi planszy,
+ * nie zajmuje pamięci proporcjonalnej do jej rozmiaru.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry.
+ * @return Wartość @p true jeśli pamięć jest dostępna
+ * lub @p false w przeciwnym wypadku.
  */
-static void reset_visited_map(gamma_t *board) {
-    for (uint32_t i = 0; i < board->board_width; i++) {
-        for (uint32_t j = 0; j < board->board_height; j++) {
-            board->visited_fields_board[i][j] = false;
-        }
+static bool allocate_search_arrays(gamma_t *g) {
+    if (g->queue != NULL) {
+        return true;
+    }
+    else if (!allocate_visited_map(g)) {
+        return false;
+    }
+    else if (!field_queue_init(&g->queue, indices_count(g))) {
+        free(g->visited_fields_board);
+        g->visited_fields_board = NULL;
+        return false;
     }
+    return true;
 }
 
-/** @brief Alokuje pamięć potrzebną do przechowywania tablic w zmiennej @p board.
- * Alokuje pamięć do składowych @p players, @p fields i @p map zmiennej @p board.
- * W przypadku niepowodzenia, zwalnia całą zaalokowaną w zmiennej @p board pamięć
- * i ustawia wartość @p errno na ENOMEM.
- * @param[in,out] board      – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] width          – szerokość planszy, liczba dodatnia,
- * @param[in] height         – wysokość planszy, liczba dodatnia,
- * @param[in] players        – liczba graczy, liczba dodatnia.
+/** @brief Alokuje pamięć potrzebną do przechowywania danych o polach.
+ * Alokuje jednowymiarową tablicę pól w składowej fields zmiennej @p board,
+ * w której każde pole ma domyślne wartości, więc każdemu polu przypisany
+ * jest węzeł o jego indeksie. Za polami rezerwuje miejsce na dodatkowe
+ * węzły find and union, patrz @ref dense_nodes_capacity, a przypisania
+ * dodatkowych węzłów polom przechowuje w osobnej mapie, więc pole
+ * zajmuje tylko dwie liczby. Domyślne wartości odpowiadają
+ * wyzerowanej pamięci, więc kafelki pól i węzłów są alokowane dopiero
+ * przy pierwszym zapisie, a czas tworzenia nie zależy od rozmiaru planszy.
+ * Alokuje też tablicę odwiedzonych pól i kolejkę, patrz
+ * @ref allocate_search_arrays. Jeśli indeksy wszystkich węzłów nie mieszczą
+ * się w @ref MAX_FIELDS_COUNT lub nie uda się zaalokować tablic o rozmiarze
+ * planszy, tworzy rzadką planszę, w której pola otrzymują indeksy dopiero
+ * przy pierwszym zapisie, więc zajęta pamięć rośnie z liczbą zajętych pól,
+ * a nie z rozmiarem planszy.
+ * @param[in,out] board      – wskaźnik na strukturę przechowującą dane gry.
  * @return Wartość @p true jeśli alokacja się powiodła i @p false w przeciwnym
  * wypadku.
  */
-static gamma_t *allocate_board_arrays(gamma_t *board, uint32_t width,
-                                      uint32_t height, uint32_t players) {
-    bool was_creating_successful = allocate_board(board, width, height);
-    if (!was_creating_successful) {
-        free(board);
-        errno = ENOMEM;
-        return NULL;
+static bool allocate_board(gamma_t *board) {
+    uint64_t count = fields_count(board);
+    board->sparse_fields = NULL;
+    board->field_cells = NULL;
+    board->visited_fields_board = NULL;
+    board->queue = NULL;
+    if (!field_map_init(&board->field_nodes)) {
+        return false;
     }
-
-    was_creating_successful = allocate_visited_map(board);
-    if (!was_creating_successful) {
-        free_board(board->fields, width);
-        free(board);
-        errno = ENOMEM;
-        return NULL;
+    if (dense_nodes_capacity(count) <= MAX_FIELDS_COUNT &&
+        field_board_init(&board->fields, dense_nodes_capacity(count))) {
+        board->nodes_count = count;
+        board->nodes_capacity = dense_nodes_capacity(count);
+        if (allocate_search_arrays(board)) {
+            return true;
+        }
+        field_board_clear(&board->fields);
     }
 
-    was_creating_successful = allocate_players(board, players);
-    if (!was_creating_successful) {
-        free_board(board->fields, width);
-        free_visited_map(board->visited_fields_board, width);
-        free(board);
-        errno = ENOMEM;
-        return NULL;
+    if (!field_board_init(&board->fields, FIELD_TILE_SIZE)) {
+        field_map_clear(&board->field_nodes);
+        return false;
     }
-
-    return board;
-}
-
+    board->field_cells = malloc(FIELD_TILE_SIZE * sizeof(uint64_t));
+    if (board->field_cells == NULL || !field_map_init(&board->sparse_fields)) {
+        free(board->field_cells);
+        field_board_clear(&board->fields);
+        field_map_clear(&board->field_nodes);
+        return false;
+    }
+    board->nodes_count = 0;
+    board->nodes_capacity = FIELD_TILE_SIZE;
+    if (!allocate_search_arrays(board)) {
+        free_board(board);
+        return false;
+    }
+    return true;
+}
+
+/** @brief Zwiększa numer przejścia planszy o @p steps.
+ * Przejścia o numerach od @p visited_epoch do
+ * @p visited_epoch + @ref SPLIT_SEARCHES_COUNT - 1 mogą być prowadzone
+ * jednocześnie, więc gdy te numery nie mieszczą się w zakresie licznika,
+ * zeruje całą tablicę @p visited_fields_board i zaczyna numerację od 1.
+ * @param[in,out] board      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] steps          – liczba zakończonych przejść planszy.
+ */
+static void advance_visited_epoch(gamma_t *board, uint32_t steps) {
+    if (UINT32_MAX - board->visited_epoch < steps + SPLIT_SEARCHES_COUNT) {
+        uint64_t count = indices_count(board);
+        for (uint64_t i = 0; i < count; i++) {
+            board->visited_fields_board[i] = 0;
+        }
+        board->visited_epoch = 1;
+    }
+    else {
+        board->visited_epoch += steps;
+    }
+}
+
+/** @brief Oznacza wszystkie pola jako nieodwiedzone.
+ * Rozpoczyna nowe przejście planszy poprzez zwiększenie numeru
+ * @p visited_epoch, więc działa w czasie stałym. Jedynie po przepełnieniu
+ * licznika zeruje całą tablicę @p visited_fields_board.
+ * @param[in,out] board      – wskaźnik na strukturę przechowującą dane gry,
+ */
+static void reset_visited_map(gamma_t *board) {
+    advance_visited_epoch(board, 1);
+}
+
+/** @brief Sprawdza, czy pole zostało odwiedzone w obecnym przejściu planszy.
+ * @param[in] board          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index          – indeks pola.
+ * @return Wartość @p true jeśli pole zostało odwiedzone
+ * lub @p false w przeciwnym wypadku.
+ */
+static inline bool is_field_visited(gamma_t *board, uint32_t index) {
+    return board->visited_fields_board[index] == board->visited_epoch;
+}
+
+/** @brief Oznacza pole jako odwiedzone w obecnym przejściu planszy.
+ * @param[in,out] board      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index          – indeks pola.
+ */
+static inline void mark_field_visited(gamma_t *board, uint32_t index) {
+    board->visited_fields_board[index] = board->visited_epoch;
+}
+
+/** @brief Alokuje pamięć potrzebną do przechowywania tablic w zmiennej @p board.
+ * Alokuje pamięć do składowych @p players, @p fields, @p visited_fields_board
+ * i @p queue zmiennej @p board.
+ * W przypadku niepowodzenia, zwalnia całą zaalokowaną w zmiennej @p board pamięć
+ * i ustawia wartość @p errno na ENOMEM.
+ * @param[in,out] board      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] players        – liczba graczy, liczba dodatnia.
+ * @return Wartość @p true jeśli alokacja się powiodła i @p false w przeciwnym
+ * wypadku.
+ */
+static gamma_t *allocate_board_arrays(gamma_t *board, uint32_t players) {
+    bool was_creating_successful = allocate_board(board);
+    if (!was_creating_successful) {
+        free(board);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    was_creating_successful = allocate_players(board, players);
+    if (!was_creating_successful) {
+        free_board(board);
+        free(board->visited_fields_board);
+        field_queue_clear(&board->queue);
+        free(board);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    return board;
+}
+
 gamma_t *gamma_new(uint32_t width, uint32_t height,
                    uint32_t players, uint32_t areas) {
     if (!are_gamma_new_parameters_valid(width, height, players, areas)) {
@@ -248,22 +1000,283 @@ gamma_t *gamma_new(uint32_t width, uint32_t height,
     new_board->board_height = height;
     new_board->free_fields = ((uint64_t) width) * ((uint64_t) height);
     new_board->players_count = players;
+    new_board->players_with_fields = 0;
+    new_board->dfs_fields = NULL;
+    new_board->dfs_stack = NULL;
+    for (uint32_t i = 0; i < SPLIT_SEARCHES_COUNT; i++) {
+        new_board->split_queues[i] = NULL;
+    }
+    new_board->undo = NULL;
+    new_board->move_number = 0;
+    new_board->applied_moves = 0;
+    new_board->wal = NULL;
+    new_board->rendered_board = NULL;
+    new_board->owner_tokens = NULL;
+    new_board->area_starts = NULL;
+    new_board->split_checks = 0;
+    new_board->split_checks_resolved_locally = 0;
     new_board->max_areas = areas;
 
-    new_board = allocate_board_arrays(new_board, width, height, players);
+    new_board = allocate_board_arrays(new_board, players);
 
     return new_board;
 }
 
+/** @brief Kopiuje stan gry.
+ * Tworzy kopię gry współdzielącą z nią kafelki tablicy pól. Tablica
+ * odwiedzonych pól i kolejka kopii są alokowane dopiero przy pierwszym
+ * przejściu planszy, patrz @ref allocate_search_arrays.
+ * @param[in] g              – wskaźnik na strukturę przechowującą dane gry.
+ * @return Wskaźnik na kopię lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+static gamma_t *clone_game(const gamma_t *g) {
+    gamma_t *copy = malloc(sizeof(gamma_t));
+    if (copy == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    *copy = *g;
+    copy->dfs_fields = NULL;
+    copy->dfs_stack = NULL;
+    for (uint32_t i = 0; i < SPLIT_SEARCHES_COUNT; i++) {
+        copy->split_queues[i] = NULL;
+    }
+    copy->undo = NULL;
+    copy->wal = NULL;
+    copy->rendered_board = NULL;
+    copy->owner_tokens = NULL;
+    copy->area_starts = NULL;
+    copy->visited_fields_board = NULL;
+    copy->queue = NULL;
+    copy->players = NULL;
+
+    if (!clone_board(copy, g)) {
+        free(copy);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    copy->players = malloc(g->players_count * sizeof(player_t));
+    if (copy->players == NULL) {
+        gamma_delete(copy);
+        errno = ENOMEM;
+        return NULL;
+    }
+    memcpy(copy->players, g->players, g->players_count * sizeof(player_t));
+
+    return copy;
+}
+
+gamma_t *gamma_clone(const gamma_t *g) {
+    if (g == NULL) {
+        return NULL;
+    }
+    return clone_game(g);
+}
+
 void gamma_delete(gamma_t *g) {
     if (g != NULL) {
-        free_board(g->fields, g->board_width);
-        free_visited_map(g->visited_fields_board, g->board_width);
+        free_board(g);
+        free(g->visited_fields_board);
+        field_queue_clear(&g->queue);
+        for (uint32_t i = 0; i < SPLIT_SEARCHES_COUNT; i++) {
+            field_queue_clear(&g->split_queues[i]);
+        }
+        free(g->dfs_fields);
+        free(g->dfs_stack);
+        gamma_undo_enable(g, false);
+        gamma_wal_close(g);
+        free(g->rendered_board);
+        free(g->owner_tokens);
+        if (g->area_starts != NULL) {
+            for (uint32_t i = 0; i < g->players_count; i++) {
+                free(g->area_starts[i].fields);
+            }
+            free(g->area_starts);
+        }
         free(g->players);
         free(g);
     }
 }
 
+/** @brief Zapisuje cały bufor do deskryptora pliku.
+ * Ponawia zapis po częściowym zapisie lub przerwaniu przez sygnał.
+ * @param[in] fd         – deskryptor pliku otwartego do zapisu,
+ * @param[in] buffer     – zapisywane dane,
+ * @param[in] size       – liczba bajtów do zapisania.
+ * @return Wartość @p true, jeśli zapisano wszystkie dane, lub @p false,
+ * jeśli wystąpił błąd, wtedy @p errno opisuje ten błąd.
+ */
+static bool write_all(int fd, const void *buffer, size_t size) {
+    const char *data = buffer;
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (written < 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+/** @brief Wczytuje z deskryptora pliku co najwyżej @p size bajtów.
+ * Ponawia odczyt po częściowym odczycie lub przerwaniu przez sygnał,
+ * aż wczyta @p size bajtów lub plik się skończy.
+ * @param[in] fd         – deskryptor pliku otwartego do odczytu,
+ * @param[out] buffer    – bufor na co najmniej @p size bajtów,
+ * @param[in] size       – maksymalna liczba bajtów do wczytania.
+ * @return Liczba wczytanych bajtów, mniejsza od @p size jedynie wtedy,
+ * gdy plik się skończył, lub -1, jeśli wystąpił błąd, wtedy @p errno
+ * opisuje ten błąd.
+ */
+static ssize_t read_full(int fd, void *buffer, size_t size) {
+    char *data = buffer;
+    size_t total = 0;
+    while (total < size) {
+        ssize_t read_bytes = read(fd, data + total, size - total);
+        if (read_bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (read_bytes < 0) {
+            return -1;
+        }
+        else if (read_bytes == 0) {
+            break;
+        }
+        total += read_bytes;
+    }
+    return total;
+}
+
+/** @brief Wczytuje z deskryptora pliku dokładnie @p size bajtów.
+ * Ponawia odczyt po częściowym odczycie lub przerwaniu przez sygnał.
+ * @param[in] fd         – deskryptor pliku otwartego do odczytu,
+ * @param[out] buffer    – bufor na co najmniej @p size bajtów,
+ * @param[in] size       – liczba bajtów do wczytania.
+ * @return Wartość @p true, jeśli wczytano wszystkie bajty, lub @p false,
+ * jeśli wystąpił błąd, wtedy @p errno opisuje ten błąd, albo plik się
+ * skończył, wtedy @p errno ma wartość EINVAL.
+ */
+static bool read_all(int fd, void *buffer, size_t size) {
+    ssize_t read_bytes = read_full(fd, buffer, size);
+    if (read_bytes >= 0 && (size_t) read_bytes < size) {
+        errno = EINVAL;
+    }
+    return (read_bytes >= 0 && (size_t) read_bytes == size);
+}
+
+/** @brief Podaje bieżący czas monotoniczny.
+ * @return Liczba nanosekund od nieokreślonej chwili w przeszłości.
+ */
+static inline uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+/** @brief Oblicza sumę kontrolną wpisu dziennika zapisu z wyprzedzeniem.
+ * @param[in] sequence   – numer ruchu zapisanego we wpisie
+ *                         lub 0 dla wpisu rozpoczynającego segment,
+ * @param[in] entry      – wskaźnik na wpis z ustawionym rodzajem.
+ * @return Suma kontrolna, mieszcząca się na bitach znacznika wpisu
+ * powyżej @ref WAL_KIND_BITS.
+ */
+static uint32_t wal_checksum(uint64_t sequence, const wal_entry *entry) {
+    uint32_t words[] = {entry->tag & ((1u << WAL_KIND_BITS) - 1),
+                        entry->player, entry->x, entry->y};
+    uint64_t hash = sequence;
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        hash = (hash ^ words[i]) * 0x9E3779B97F4A7C15u;
+        hash ^= hash >> 29;
+    }
+    return hash >> (64 - (32 - WAL_KIND_BITS));
+}
+
+/** @brief Wypełnia wpis dziennika zapisu z wyprzedzeniem.
+ * @param[out] entry     – wskaźnik na wypełniany wpis,
+ * @param[in] kind       – rodzaj wpisu,
+ * @param[in] sequence   – numer ruchu zapisanego we wpisie
+ *                         lub 0 dla wpisu rozpoczynającego segment,
+ * @param[in] player     – numer gracza lub wersja formatu,
+ * @param[in] x          – numer kolumny lub młodsza połowa numeru ruchu,
+ * @param[in] y          – numer wiersza lub starsza połowa numeru ruchu.
+ */
+static void set_wal_entry(wal_entry *entry, uint32_t kind, uint64_t sequence,
+                          uint32_t player, uint32_t x, uint32_t y) {
+    entry->tag = kind;
+    entry->player = player;
+    entry->x = x;
+    entry->y = y;
+    entry->tag |= wal_checksum(sequence, entry) << WAL_KIND_BITS;
+}
+
+/** @brief Sprawdza, czy suma kontrolna wpisu dziennika jest poprawna.
+ * @param[in] entry      – wskaźnik na wpis,
+ * @param[in] sequence   – oczekiwany numer ruchu zapisanego we wpisie
+ *                         lub 0 dla wpisu rozpoczynającego segment.
+ * @return Wartość @p true, jeśli suma kontrolna się zgadza, lub @p false
+ * w przeciwnym wypadku.
+ */
+static inline bool is_wal_entry_valid(const wal_entry *entry, uint64_t sequence) {
+    return (entry->tag >> WAL_KIND_BITS) == wal_checksum(sequence, entry);
+}
+
+/** @brief Zapisuje i synchronizuje bufor dziennika zapisu z wyprzedzeniem.
+ * Synchronizacja pliku, który jej nie obsługuje, na przykład potoku,
+ * jest pomijana. Po pierwszym błędzie dziennik przestaje zapisywać wpisy.
+ * @param[in,out] wal    – wskaźnik na dziennik.
+ * @return Wartość @p true, jeśli wszystkie dotychczasowe wpisy zostały
+ * zapisane, lub @p false w przeciwnym wypadku, wtedy @p errno opisuje
+ * pierwszy błąd.
+ */
+static bool flush_wal(move_wal *wal) {
+    if (!wal->has_failed && wal->pending_count > 0 &&
+        (!write_all(wal->fd, wal->pending, wal->pending_count * sizeof(wal_entry)) ||
+         (fdatasync(wal->fd) != 0 && errno != EINVAL))) {
+        wal->has_failed = true;
+        wal->error = errno;
+    }
+    wal->pending_count = 0;
+    if (wal->has_failed) {
+        errno = wal->error;
+    }
+    return !wal->has_failed;
+}
+
+/** @brief Zapamiętuje wykonany ruch.
+ * Zwiększa licznik wykonanych ruchów i, jeśli gra ma dziennik zapisu
+ * z wyprzedzeniem, dodaje ruch do jego bufora, zapisując bufor, gdy jest
+ * pełny lub najstarszy wpis czeka zbyt długo.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] kind       – rodzaj ruchu, @ref WAL_MOVE lub @ref WAL_GOLDEN_MOVE,
+ * @param[in] player     – numer gracza,
+ * @param[in] x          – numer kolumny,
+ * @param[in] y          – numer wiersza.
+ */
+static void count_move(gamma_t *g, uint32_t kind, uint32_t player,
+                       uint32_t x, uint32_t y) {
+    move_wal *wal = g->wal;
+    uint64_t sequence = (g->applied_moves)++;
+    if (wal == NULL || wal->has_failed) {
+        return;
+    }
+
+    set_wal_entry(&wal->pending[wal->pending_count], kind, sequence, player, x, y);
+    if (wal->pending_count++ == 0 && wal->group_ns != 0) {
+        wal->first_pending_ns = monotonic_ns();
+    }
+    if (wal->pending_count == wal->group_moves ||
+        (wal->group_ns != 0 &&
+         monotonic_ns() - wal->first_pending_ns >= wal->group_ns)) {
+        flush_wal(wal);
+    }
+}
+
 /** @brief Sprawdza, czy parametr @p player jest poprawny.
  * Sprawdza, czy parametr @p player jest różny od zera
  * i niewiększy od wartości @p players_count ze zmiennej @p g.
@@ -313,16 +1326,16 @@ static inline bool are_gamma_move_parameters_valid(gamma_t *g, uint32_t player,
  */
 static bool does_player_own_adjacent_fields(gamma_t *board, uint32_t player,
                                             uint32_t x, uint32_t y) {
-    if (x + 1 < board->board_width && board->fields[x + 1][y].owner_index == player) {
+    if (x + 1 < board->board_width && get_field(board, x + 1, y)->owner_index == player) {
         return true;
     }
-    if (x > 0 && board->fields[x - 1][y].owner_index == player) {
+    if (x > 0 && get_field(board, x - 1, y)->owner_index == player) {
         return true;
     }
-    if (y + 1 < board->board_height && board->fields[x][y + 1].owner_index == player) {
+    if (y + 1 < board->board_height && get_field(board, x, y + 1)->owner_index == player) {
         return true;
     }
-    if (y > 0 && board->fields[x][y - 1].owner_index == player) {
+    if (y > 0 && get_field(board, x, y - 1)->owner_index == player) {
         return true;
     }
 
@@ -350,25 +1363,25 @@ static uint32_t how_many_adjacent_fields_added(gamma_t *board, uint32_t player,
     uint32_t new_fields_count = 0;
 
     if (x + 1 < board->board_width &&
-        board->fields[x + 1][y].owner_index == DEFAULT_PLAYER_NUMBER &&
+        get_field(board, x + 1, y)->owner_index == DEFAULT_PLAYER_NUMBER &&
         !does_player_own_adjacent_fields(board, player, x + 1, y)) {
             new_fields_count++;
     }
 
     if (x > 0 &&
-        board->fields[x - 1][y].owner_index == DEFAULT_PLAYER_NUMBER &&
+        get_field(board, x - 1, y)->owner_index == DEFAULT_PLAYER_NUMBER &&
         !does_player_own_adjacent_fields(board, player, x - 1, y)) {
             new_fields_count++;
     }
 
     if (y + 1 < board->board_height &&
-        board->fields[x][y + 1].owner_index == DEFAULT_PLAYER_NUMBER &&
+        get_field(board, x, y + 1)->owner_index == DEFAULT_PLAYER_NUMBER &&
         !does_player_own_adjacent_fields(board, player, x, y + 1)) {
             new_fields_count++;
     }
 
     if (y > 0 &&
-        board->fields[x][y - 1].owner_index == DEFAULT_PLAYER_NUMBER &&
+        get_field(board, x, y - 1)->owner_index == DEFAULT_PLAYER_NUMBER &&
         !does_player_own_adjacent_fields(board, player, x, y - 1)) {
             new_fields_count++;
     }
@@ -394,26 +1407,13 @@ static uint32_t how_many_adjacent_fields_added(gamma_t *board, uint32_t player,
 static uint32_t add_and_unite_field(gamma_t *g, uint32_t player,
                                     uint32_t x, uint32_t y) {
     uint32_t united_sets = 0;
-    if (x + 1 < g->board_width && g->fields[x + 1][y].owner_index == player) {
-        if (unite_fields(&g->fields[x][y], &g->fields[x + 1][y], g->fields)) {
-            united_sets++;
-        }
-    }
-
-    if (x > 0 && g->fields[x - 1][y].owner_index == player) {
-        if (unite_fields(&g->fields[x][y], &g->fields[x - 1][y], g->fields)) {
-            united_sets++;
-        }
-    }
-
-    if (y + 1 < g->board_height && g->fields[x][y + 1].owner_index == player) {
-        if (unite_fields(&g->fields[x][y], &g->fields[x][y + 1], g->fields)) {
-            united_sets++;
-        }
-    }
-
-    if (y > 0 && g->fields[x][y - 1].owner_index == player) {
-        if (unite_fields(&g->fields[x][y], &g->fields[x][y - 1], g->fields)) {
+    uint32_t index = field_index(g, x, y);
+    uint32_t adjacent[SPLIT_SEARCHES_COUNT];
+    uint32_t adjacent_count = adjacent_field_indices(g, index, adjacent);
+    for (uint32_t i = 0; i < adjacent_count; i++) {
+        if (field_at(g, adjacent[i])->owner_index == player &&
+            unite_fields(&g->fields, field_node(g, index),
+                         field_node(g, adjacent[i]), fields_journal(g))) {
             united_sets++;
         }
     }
@@ -431,7 +1431,7 @@ static uint32_t add_and_unite_field(gamma_t *g, uint32_t player,
  * @return Wartość @p true jeśli pole należy do innego gracza
  *         lub wartość @p false w przeciwnym wypadku.
  */
-static inline bool does_field_belong_to_other_player(gamma_field *field, uint32_t player) {
+static inline bool does_field_belong_to_other_player(const gamma_field *field, uint32_t player) {
     return (field->owner_index != DEFAULT_PLAYER_NUMBER &&
             field->owner_index != player);
 }
@@ -478,533 +1478,695 @@ static void update_other_players_adjacent_fields_after_move(gamma_t *g, uint32_t
     uint32_t players_checked[3];
     uint32_t players_count = 0;
     if (x + 1 < g->board_width &&
-        does_field_belong_to_other_player(&g->fields[x + 1][y], player)) {
-        (g->players[g->fields[x + 1][y].owner_index - 1].adjacent_fields)--;
-        players_checked[players_count] = g->fields[x + 1][y].owner_index;
+        does_field_belong_to_other_player(get_field(g, x + 1, y), player)) {
+        (player_for_update(g, get_field(g, x + 1, y)->owner_index)->adjacent_fields)--;
+        players_checked[players_count] = get_field(g, x + 1, y)->owner_index;
         players_count++;
     }
 
     if (x > 0 &&
-        does_field_belong_to_other_player(&g->fields[x - 1][y], player) &&
-        !was_player_adjacent_already_updated(g->fields[x - 1][y].owner_index,
+        does_field_belong_to_other_player(get_field(g, x - 1, y), player) &&
+        !was_player_adjacent_already_updated(get_field(g, x - 1, y)->owner_index,
                                              players_checked, players_count)) {
-        (g->players[g->fields[x - 1][y].owner_index - 1].adjacent_fields)--;
-        players_checked[players_count] = g->fields[x - 1][y].owner_index;
+        (player_for_update(g, get_field(g, x - 1, y)->owner_index)->adjacent_fields)--;
+        players_checked[players_count] = get_field(g, x - 1, y)->owner_index;
         players_count++;
     }
 
     if (y + 1 < g->board_height &&
-        does_field_belong_to_other_player(&g->fields[x][y + 1], player) &&
-        !was_player_adjacent_already_updated(g->fields[x][y + 1].owner_index,
+        does_field_belong_to_other_player(get_field(g, x, y + 1), player) &&
+        !was_player_adjacent_already_updated(get_field(g, x, y + 1)->owner_index,
                                              players_checked, players_count)) {
-        (g->players[g->fields[x][y + 1].owner_index - 1].adjacent_fields)--;
-        players_checked[players_count] = g->fields[x][y + 1].owner_index;
+        (player_for_update(g, get_field(g, x, y + 1)->owner_index)->adjacent_fields)--;
+        players_checked[players_count] = get_field(g, x, y + 1)->owner_index;
         players_count++;
     }
 
     if (y > 0 &&
-        does_field_belong_to_other_player(&g->fields[x][y - 1], player) &&
-        !was_player_adjacent_already_updated(g->fields[x][y - 1].owner_index,
+        does_field_belong_to_other_player(get_field(g, x, y - 1), player) &&
+        !was_player_adjacent_already_updated(get_field(g, x, y - 1)->owner_index,
                                              players_checked, players_count)) {
-        (g->players[g->fields[x][y - 1].owner_index - 1].adjacent_fields)--;
+        (player_for_update(g, get_field(g, x, y - 1)->owner_index)->adjacent_fields)--;
     }
 }
 
-bool gamma_move(gamma_t *g, uint32_t player,
-                uint32_t x, uint32_t y) {
-    if (!are_gamma_move_parameters_valid(g, player, x, y) ||
-        g->fields[x][y].owner_index != DEFAULT_PLAYER_NUMBER) {
-        return false;
+/** @brief Sprawdza, czy pola właściciela wokół danego pola są połączone.
+ * Sprawdza, czy wszystkie pola sąsiadujące bokiem z polem (@p x, @p y)
+ * i należące do jego właściciela są połączone ze sobą przez należące
+ * do właściciela pola otaczające pole (@p x, @p y). Jeśli tak, usunięcie
+ * pola (@p x, @p y) nie podzieli obszaru, do którego należy.
+ * Wynik @p false nie oznacza, że obszar zostanie podzielony, gdyż pola
+ * mogą być połączone poza otoczeniem pola.
+ * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] x          – numer kolumny, mniejszy od składowej
+ *                         @p board_width ze zmiennej @p g,
+ * @param[in] y          – numer wiersza, mniejszy od składowej
+ *                         @p board_height ze zmiennej @p g.
+ * @return Wartość @p true, jeśli pola są połączone w obrębie otoczenia
+ * lub @p false w przeciwnym wypadku.
+ */
+static bool is_area_connected_around_field(gamma_t *g, uint32_t x, uint32_t y) {
+    uint32_t owner = get_field(g, x, y)->owner_index;
+    bool is_owned[RING_SIZE];
+    int32_t not_owned = -1;
+    for (int32_t i = 0; i < RING_SIZE; i++) {
+        uint32_t ring_x = x + RING_DX[i];
+        uint32_t ring_y = y + RING_DY[i];
+        is_owned[i] = (ring_x < g->board_width && ring_y < g->board_height &&
+                       get_field(g, ring_x, ring_y)->owner_index == owner);
+        if (!is_owned[i]) {
+            not_owned = i;
+        }
     }
-    player_t *curr_player = &g->players[player - 1];
 
-    bool is_creating_new_area = !does_player_own_adjacent_fields(g, player, x, y);
-    if (curr_player->number_of_areas == g->max_areas &&
-        is_creating_new_area) {
-        return false;
+    if (not_owned == -1) {
+        return true;
     }
 
-    (curr_player->number_of_fields)++;
-    (curr_player->adjacent_fields) += how_many_adjacent_fields_added(g, player, x, y);
-    (g->free_fields)--;
-    if (is_creating_new_area) {
-        curr_player->number_of_areas++;
-    }
-    else {
-        uint32_t united_fields = add_and_unite_field(g, player, x, y);
-        (curr_player->number_of_areas) -= united_fields;
-        (curr_player->number_of_areas) += 1;
-        (curr_player->adjacent_fields)--;
+    // Zliczamy spójne fragmenty otoczenia, które zawierają sąsiada
+    // pola, zaczynając tuż za polem nienależącym do właściciela.
+    uint32_t groups = 0;
+    bool has_neighbour = false;
+    for (int32_t j = 1; j <= RING_SIZE; j++) {
+        int32_t i = (not_owned + j) % RING_SIZE;
+        if (is_owned[i]) {
+            has_neighbour = has_neighbour || (i % 2 == 0);
+        }
+        else {
+            if (has_neighbour) {
+                groups++;
+            }
+            has_neighbour = false;
+        }
     }
-    g->fields[x][y].owner_index = player;
 
-    update_other_players_adjacent_fields_after_move(g, player, x, y);
-    return true;
+    return groups <= 1;
 }
 
-/** @brief Sprawdza, czy parametry funkcji @ref gamma_golden_move śa prawidłowe.
- * Sprawdza, czy parametry @p player, @p x i @p y mieszczą się w zakresach
- * ustalanych przez składowe zmiennej @p board, odpowiednio @p players_count,
- * @p board_width i @p board_height.
- * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] player     – indeks gracza, liczba dodatnia
- *                         i niewiększa od składowej @p players
- *                         ze zmiennej @p g,
+/** @brief Sprawdza na podstawie otoczenia, czy usunięcie pola nie podzieli obszaru.
+ * Wywołuje funkcję @ref is_area_connected_around_field, zliczając
+ * przy tym w strukturze @p g wszystkie wywołania oraz te, w których
+ * sprawdzenie otoczenia pozwoliło uniknąć przechodzenia obszaru.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
  * @param[in] x          – numer kolumny, mniejszy od składowej
  *                         @p board_width ze zmiennej @p g,
  * @param[in] y          – numer wiersza, mniejszy od składowej
  *                         @p board_height ze zmiennej @p g.
- * @return
+ * @return Wartość @p true, jeśli usunięcie pola na pewno nie podzieli obszaru
+ * lub @p false, jeśli potrzebne jest przejście obszaru.
  */
-static bool are_golden_move_parameters_valid(gamma_t *g, uint32_t player,
-                                             uint32_t x, uint32_t y) {
-    if (g == NULL || x >= g->board_width || y >= g->board_height) {
-        return false;
+static bool is_removal_resolved_locally(gamma_t *g, uint32_t x, uint32_t y) {
+    (g->split_checks)++;
+    if (is_area_connected_around_field(g, x, y)) {
+        (g->split_checks_resolved_locally)++;
+        return true;
     }
-
-    uint32_t field_owner = g->fields[x][y].owner_index;
-    return (gamma_golden_possible(g, player) &&
-            field_owner != DEFAULT_PLAYER_NUMBER &&
-            field_owner != player);
+    return false;
 }
 
-/** @brief Ustawia sąsiednie pola należące do gracza jako korzenie w ramach find and union.
- * Jeśli pola (@p x + 1, @p y), (@p x - 1, @p y), (@p x, @p y + 1), (@p x, @p y - 1)
- * należą do gracza @p player, zostają ustanowione jako korzenie w ramach algorytmu
- * find and union. Jest to przygotowanie do przejścia planszy za pomocą
- * algorytmu BFS.
+/** @brief Aktualizuje liczbę celów złotego ruchu, którymi jest dane pole.
+ * Dla każdego gracza innego niż właściciel pola (@p x, @p y), który posiada
+ * pole sąsiednie, zwiększa lub zmniejsza liczniki @p golden_targets
+ * oraz, jeśli pole spełnia warunek funkcji @ref is_area_connected_around_field,
+ * @p safe_golden_targets. Nic nie robi dla wolnego pola.
  * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] player     – indeks gracza, liczba dodatnia
- *                         i niewiększa od składowej @p players
- *                         ze zmiennej @p g,
  * @param[in] x          – numer kolumny, mniejszy od składowej
  *                         @p board_width ze zmiennej @p g,
  * @param[in] y          – numer wiersza, mniejszy od składowej
- *                         @p board_height ze zmiennej @p g.
+ *                         @p board_height ze zmiennej @p g,
+ * @param[in] add        – @p true, jeśli liczniki należy zwiększyć
+ *                         lub @p false, jeśli należy je zmniejszyć.
  */
-static void set_adjacent_fields_as_root(gamma_t *g, uint32_t player,
-                                        uint32_t x, uint32_t y) {
-    if (x + 1 < g->board_width && g->fields[x + 1][y].owner_index == player) {
-        g->fields[x + 1][y].parent_x = g->fields[x + 1][y].this_x;
-        g->fields[x + 1][y].parent_y = g->fields[x + 1][y].this_y;
+static void update_golden_targets_of_field(gamma_t *g, uint32_t x, uint32_t y,
+                                           bool add) {
+    uint32_t owner = get_field(g, x, y)->owner_index;
+    if (owner == DEFAULT_PLAYER_NUMBER) {
+        return;
     }
 
-    if (x > 0 && g->fields[x - 1][y].owner_index == player) {
-        g->fields[x - 1][y].parent_x = g->fields[x - 1][y].this_x;
-        g->fields[x - 1][y].parent_y = g->fields[x - 1][y].this_y;
+    uint32_t players_checked[4];
+    uint32_t players_count = 0;
+    for (int32_t i = 0; i < RING_SIZE; i += 2) {
+        uint32_t adjacent_x = x + RING_DX[i];
+        uint32_t adjacent_y = y + RING_DY[i];
+        if (adjacent_x < g->board_width && adjacent_y < g->board_height) {
+            uint32_t adjacent_owner = get_field(g, adjacent_x, adjacent_y)->owner_index;
+            if (adjacent_owner != DEFAULT_PLAYER_NUMBER && adjacent_owner != owner &&
+                !was_player_adjacent_already_updated(adjacent_owner, players_checked,
+                                                     players_count)) {
+                players_checked[players_count] = adjacent_owner;
+                players_count++;
+            }
+        }
     }
 
-    if (y + 1 < g->board_height && g->fields[x][y + 1].owner_index == player) {
-        g->fields[x][y + 1].parent_x = g->fields[x][y + 1].this_x;
-        g->fields[x][y + 1].parent_y = g->fields[x][y + 1].this_y;
+    bool is_safe = players_count > 0 && is_area_connected_around_field(g, x, y);
+    for (uint32_t i = 0; i < players_count; i++) {
+        player_t *adjacent_player = player_for_update(g, players_checked[i]);
+        if (add) {
+            (adjacent_player->golden_targets)++;
+            adjacent_player->safe_golden_targets += is_safe;
+        }
+        else {
+            (adjacent_player->golden_targets)--;
+            adjacent_player->safe_golden_targets -= is_safe;
+        }
     }
+}
 
-    if (y > 0 && g->fields[x][y - 1].owner_index == player) {
-        g->fields[x][y - 1].parent_x = g->fields[x][y - 1].this_x;
-        g->fields[x][y - 1].parent_y = g->fields[x][y - 1].this_y;
+/** @brief Aktualizuje liczby celów złotego ruchu w otoczeniu pola.
+ * Wywołuje funkcję @ref update_golden_targets_of_field dla pola
+ * (@p x, @p y) oraz wszystkich pól, które je otaczają, czyli wszystkich pól,
+ * których wkład do liczników zależy od właściciela pola (@p x, @p y).
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] x          – numer kolumny, mniejszy od składowej
+ *                         @p board_width ze zmiennej @p g,
+ * @param[in] y          – numer wiersza, mniejszy od składowej
+ *                         @p board_height ze zmiennej @p g,
+ * @param[in] add        – @p true, jeśli liczniki należy zwiększyć
+ *                         lub @p false, jeśli należy je zmniejszyć.
+ */
+static void update_golden_targets_around_field(gamma_t *g, uint32_t x, uint32_t y,
+                                               bool add) {
+    update_golden_targets_of_field(g, x, y, add);
+    for (int32_t i = 0; i < RING_SIZE; i++) {
+        uint32_t ring_x = x + RING_DX[i];
+        uint32_t ring_y = y + RING_DY[i];
+        if (ring_x < g->board_width && ring_y < g->board_height) {
+            update_golden_targets_of_field(g, ring_x, ring_y, add);
+        }
     }
 }
 
-/** @brief Sprawdza, czy dane pole powinno zostać odwiedzone podczas przechodzenia planszy.
- * Sprawdza, czy dane pole spełnia następujące warunki:
- * nie zostało jeszcze odwiedzone,
- * należy do danego gracza.
- * @param[in] field       – wskaźnik na strukturę przechowującą dane pola,
- * @param[in] player      – indeks gracza, liczba dodatnia,
- * @param[in] visited_map – dwuwymiarowa tablica przechowująca informacje
- *                          o tym, czy pola zostały już odwiedzone.
- * @return Wartosć @p true jeśli pole spełnia powyższe warunki
- *         lub wartość @p false, jeśli ich nie spełnia.
+/** @brief Zamienia cyfrę na odpowiadający jej znak typu char.
+ * Do kodu znaku '0' zostaje dodana liczba odpowiadająca cyfrze @p digit.
+ * @param[in] digit   – cyfra
+ * @return Znak odpowiadający cyfrze @p digit.
  */
-static inline bool should_field_be_visited(gamma_field *field, uint32_t player,
-                                           bool **visited_map) {
-    return (field->owner_index == player &&
-            !visited_map[field->this_x][field->this_y]);
+static inline char digit_to_char(uint32_t digit) {
+    return (char) (digit + (uint32_t) '0');
 }
 
-/** @brief Dodaje do kolejki sąsiednie pola w ramach algorytmu BFS.
- * Dodaje do kolejki @p queue pola o współrzędnych
- * (@p field->this_x + 1, @p field->this_y), (@p field->this_x - 1, @p field->this_y),
- * (@p field->this_x, @p field->this_y + 1), (@p field->this_x, @p field->this_y - 1),
- * jeśli nie zostały one odwiedzone i należą do gracza o indeksie @p field->owner_index.
- * @param[in, out] queue – wskaźnik na strukturę reprezentującą kolejkę
- *                         danych typu gamma_field,
- * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] field      – wskaźnik na strukturę przechowującą dane pola,
+/** @brief Podaje liczbę cyfr dziesiętnych liczby.
+ * @param[in] number  – liczba.
+ * @return Liczba cyfr zapisu dziesiętnego @p number, co najmniej 1.
  */
-static void add_adjacent_fields_to_queue(field_queue *queue, gamma_t *g,
-                                         gamma_field *field) {
-    uint32_t curr_x = field->this_x;
-    uint32_t curr_y = field->this_y;
-
-    if (curr_x + 1 < g->board_width &&
-        should_field_be_visited(&g->fields[curr_x + 1][curr_y],
-                                field->owner_index, g->visited_fields_board)) {
-        field_queue_push(queue, &g->fields[curr_x + 1][curr_y]);
-        g->visited_fields_board[curr_x + 1][curr_y] = true;
+static inline uint32_t decimal_digits(uint32_t number) {
+    uint32_t digits = 1;
+    while (number >= 10) {
+        number /= 10;
+        digits++;
     }
+    return digits;
+}
 
-    if (curr_x > 0 &&
-        should_field_be_visited(&g->fields[curr_x - 1][curr_y],
-                                field->owner_index, g->visited_fields_board)) {
-        field_queue_push(queue, &g->fields[curr_x - 1][curr_y]);
-        g->visited_fields_board[curr_x - 1][curr_y] = true;
+/** @brief Umieszcza w tablicy opis właściciela pola.
+ * Zapisuje numer gracza @p owner, a dla @ref DEFAULT_PLAYER_NUMBER znak
+ * @ref DEFAULT_PLAYER_IDENTIFIER, dopełniony spacjami do długości
+ * @p field_width.
+ * @param[out] s            – tablica na co najmniej @p field_width znaków,
+ * @param[in] owner         – indeks właściciela pola lub
+ *                            @ref DEFAULT_PLAYER_NUMBER,
+ * @param[in] field_width   – szerokość opisu pola.
+ */
+static void format_owner(char *s, uint32_t owner, uint32_t field_width) {
+    uint32_t digits = 1;
+    if (owner == DEFAULT_PLAYER_NUMBER) {
+        s[0] = DEFAULT_PLAYER_IDENTIFIER;
     }
-
-    if (curr_y + 1 < g->board_height &&
-        should_field_be_visited(&g->fields[curr_x][curr_y + 1],
-                                field->owner_index, g->visited_fields_board)) {
-        field_queue_push(queue, &g->fields[curr_x][curr_y + 1]);
-        g->visited_fields_board[curr_x][curr_y + 1] = true;
+    else {
+        digits = decimal_digits(owner);
+        for (uint32_t i = digits; i > 0; i--) {
+            s[i - 1] = digit_to_char(owner % 10);
+            owner /= 10;
+        }
     }
-
-    if (curr_y > 0 &&
-        should_field_be_visited(&g->fields[curr_x][curr_y - 1],
-                                field->owner_index, g->visited_fields_board)) {
-        field_queue_push(queue, &g->fields[curr_x][curr_y - 1]);
-        g->visited_fields_board[curr_x][curr_y - 1] = true;
+    for (uint32_t i = digits; i < field_width; i++) {
+        s[i] = ' ';
     }
 }
 
-/** @brief Ustawia dane pole jako korzeń swojego zbioru w ramach find and union.
- * Korzystając z algorytmu BFS, ustawia współrzędne korzenia wszystkich elementów
- * zbioru na (@p x, @p y). Aktualizowany zbiór jest zbiorem, do którego należy
- * pole o współrzędnych (@p x, @p y).
- * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] x          – numer kolumny, mniejszy od składowej
- *                         @p board_width ze zmiennej @p g,
- * @param[in] y          – numer wiersza, mniejszy od składowej
- *                         @p board_height ze zmiennej @p g.
+/** @brief Oblicza rozmiar tablicy znaków do wypisania.
+ * Oblicza rozmiar tablicy znaków opisującej planszę @p g,
+ * biorąc pod uwagę wielocyfrowe indeksy graczy,
+ * znaki końca linii oraz znak '\0' na końcu tablicy.
+ * @param[in] g     – wskaźnik na strukturę przechowującą dane o grze.
+ * @return Liczba symbolizująca docelowy rozmiar tablicy znaków
+ * reprezentującej planszę @p g lub zero, jeśli nie mieści się on
+ * w zmiennej typu uint64_t.
  */
-static void set_field_as_set_root(gamma_t *g, uint32_t x, uint32_t y) {
-    field_queue *queue;
-    field_queue_init(&queue);
-    field_queue_push(queue, &g->fields[x][y]);
-    g->visited_fields_board[x][y] = true;
+static uint64_t how_many_characters_will_map_have(gamma_t *g) {
+    // Każdy gracz zajmie tyle znaków, ile znaków
+    // ma gracz o największym numerze. Jeśli
+    // graczy jest przynajmniej 10, po każdym
+    // wystąpi jeszcze jedna spacja.
+    uint64_t size = ((uint64_t) g->board_height * (uint64_t) (g->board_width));
+    if(g->players_count >= 10) {
+        uint32_t multiplier = decimal_digits(g->players_count) + 1;
+        // Opis ogromnej rzadkiej planszy może nie mieścić się w pamięci.
+        if (size > (UINT64_MAX - g->board_height - 1) / multiplier) {
+            return 0;
+        }
+        size *= multiplier;
+    }
 
-    while (!field_queue_is_empty(queue)) {
-        gamma_field *curr_field = field_queue_pop(queue);
+    // Miejsce na kolumnę znaków \n.
+    size += g->board_height;
+    //Jedna komórka dla znaku '\0'
+    size++;
 
-        curr_field->parent_x = x;
-        curr_field->parent_y = y;
+    return size;
+}
 
-        add_adjacent_fields_to_queue(queue, g, curr_field);
-    }
-    reset_visited_map(g);
-    field_queue_clear(&queue);
+/** @brief Podaje szerokość opisu jednego pola w opisie planszy.
+ * @param[in] g      – wskaźnik na strukturę przechowującą dane gry.
+ * @return Liczba cyfr numeru ostatniego gracza, powiększona o spację
+ * oddzielającą pola, jeśli graczy jest przynajmniej 10.
+ */
+static inline uint32_t rendered_field_width(const gamma_t *g) {
+    uint32_t player_width = decimal_digits(g->players_count);
+    return (g->players_count > 9) ? player_width + 1 : player_width;
 }
 
-/** @brief Aktualizuje liczbę obszarów w posiadaniu gracza po usunięciu pola.
- * Aktualizuje liczbę obszarów, które posiada gracz o indeksie @p player,
- * w chwili wywołania funkcji każde należące do gracza @p player
- * pole o współrzędnych:
- * (@p x + 1, @p y), (@p x - 1, @p y), (@p x, @p y + 1), (@p x, @p y - 1)
- * ma zmienną @p parent_x równą @p this_x oraz @p parent_y równą @p this_y,
- * następnie te pola zostają ustanowione korzeniami w swoich zbiorach.
- * Jeśli przed tym ustaniowieniem dane pole nie jest już swoim korzeniem,
- * oznacza to że należy do jednego z poprzednio sprawdzonych obszarów,
- * więc liczba obszarów, na które podzielono poprzednio istniejący obszar
- * nie zwiększa się.
- * W przeciwnym wypadku, zwiększa wartość zmiennej @p areas_count,
- * co oznacza, że dane pole należało do nowego, niezbadanego jeszcze
- * obszaru.
- * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] player     – indeks gracza, liczba dodatnia
- *                         i niewiększa od składowej @p players
- *                         ze zmiennej @p g,
- * @param[in] x          – numer kolumny, mniejszy od składowej
- *                         @p board_width ze zmiennej @p g,
- * @param[in] y          – numer wiersza, mniejszy od składowej
- *                         @p board_height ze zmiennej @p g.
- * @return Liczba w zakresie 0-4 oznaczająca liczbę różnych obszarów,
- * do których należą należące do gracza @p player pola sąsiednie
- * do pola o współrzędnych (@p x, @p y).
+/** @brief Daje tablicę opisów właścicieli pól.
+ * Przy pierwszym wywołaniu tworzy tablicę, w której kolejne fragmenty
+ * długości @ref rendered_field_width zawierają gotowe opisy pól należących
+ * do kolejnych graczy, poczynając od pola niczyjego.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry.
+ * @return Wskaźnik na tablicę lub NULL, jeśli graczy jest więcej niż
+ * @ref OWNER_TOKENS_MAX_PLAYERS lub nie udało się zaalokować pamięci.
  */
-static uint32_t update_areas_after_removal(gamma_t *g, uint32_t player,
-                                           uint32_t x, uint32_t y) {
-    int areas_count = 0;
-    if (x + 1 < g->board_width && g->fields[x + 1][y].owner_index == player) {
-        set_field_as_set_root(g, x + 1, y);
-        areas_count++;
-    }
-
-    if (x > 0 && g->fields[x - 1][y].owner_index == player) {
-        if (is_field_root(&g->fields[x - 1][y])) {
-            set_field_as_set_root(g, x - 1, y);
-            areas_count++;
+static const char *owner_tokens(gamma_t *g) {
+    if (g->owner_tokens == NULL &&
+        g->players_count <= OWNER_TOKENS_MAX_PLAYERS) {
+        uint32_t field_width = rendered_field_width(g);
+        g->owner_tokens = malloc(((size_t) g->players_count + 1) * field_width);
+        if (g->owner_tokens != NULL) {
+            for (uint32_t i = 0; i <= g->players_count; i++) {
+                format_owner(g->owner_tokens + (size_t) i * field_width, i,
+                             field_width);
+            }
         }
     }
+    return g->owner_tokens;
+}
 
-    if (y + 1 < g->board_height && g->fields[x][y + 1].owner_index == player) {
-        if (is_field_root(&g->fields[x][y + 1])) {
-            set_field_as_set_root(g, x, y + 1);
-            areas_count++;
-        }
+/** @brief Wpisuje właściciela pola do opisu planszy.
+ * @param[in,out] board      – opis planszy,
+ * @param[in] offset         – położenie opisu pola w @p board,
+ * @param[in] owner          – indeks właściciela pola lub
+ *                             @ref DEFAULT_PLAYER_NUMBER,
+ * @param[in] field_width    – szerokość opisu pola,
+ * @param[in] tokens         – tablica zwrócona przez funkcję
+ *                             @ref owner_tokens lub NULL.
+ */
+static inline void render_field(char *board, uint64_t offset, uint32_t owner,
+                                uint32_t field_width, const char *tokens) {
+    if (tokens != NULL) {
+        memcpy(board + offset, tokens + (size_t) owner * field_width,
+               field_width);
+    }
+    else {
+        format_owner(board + offset, owner, field_width);
     }
+}
 
-    if (y > 0 && g->fields[x][y - 1].owner_index == player) {
-        if (is_field_root(&g->fields[x][y - 1])) {
-            set_field_as_set_root(g, x, y - 1);
-            areas_count++;
-        }
+/** @brief Aktualizuje opis planszy po zmianie właściciela pola.
+ * Przepisuje jedynie opis zmienionego pola, którego położenie wynika
+ * ze stałej szerokości opisu pola. Nic nie robi, jeśli opis planszy
+ * nie został jeszcze utworzony.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] x          – numer kolumny pola,
+ * @param[in] y          – numer wiersza pola,
+ * @param[in] owner      – indeks nowego właściciela pola lub
+ *                         @ref DEFAULT_PLAYER_NUMBER.
+ */
+static void update_rendered_board(gamma_t *g, uint32_t x, uint32_t y,
+                                  uint32_t owner) {
+    if (g->rendered_board == NULL) {
+        return;
     }
+    uint32_t field_width = rendered_field_width(g);
+    uint64_t row_length = (uint64_t) g->board_width * field_width + 1;
+    uint64_t offset = (uint64_t) (g->board_height - 1 - y) * row_length +
+                      (uint64_t) x * field_width;
+    render_field(g->rendered_board, offset, owner, field_width,
+                 owner_tokens(g));
+}
 
-    return areas_count;
+/** @brief Zapomina pola obszarów gracza.
+ * Zwalnia tablicę pól gracza w składowej @p area_starts, więc zostaną one
+ * wyszukane od nowa przy następnym przejściu obszarów gracza.
+ * @param[in, out] starts – wskaźnik na pola obszarów gracza.
+ */
+static void forget_area_starts(area_starts *starts) {
+    free(starts->fields);
+    starts->fields = NULL;
+    starts->count = 0;
+    starts->capacity = 0;
 }
 
-/** @brief Po usunięciu, aktualizuje liczbę pól sąsiednich do pól innych graczy.
- * Sprawdza, czy pola sąsiednie do pola o współrzędnych (@p x, @p y)
- * należą do innego gracza, niż tego o indeksie @p player. Jeśli tak,
- * aktualizuje dla każdego danego gracza całkowitą ilość pól sąsiadujących
- * z jego polami. Jeśli danemu graczowi już tę liczbę zaktualizowano,
- * pomija dane pole.
+/** @brief Dopisuje pole do pól obszarów gracza.
+ * Nic nie robi, jeśli pola obszarów gracza nie są znane. Jeśli nie udało się
+ * powiększyć tablicy albo nieaktualne pola zajęłyby ponad dwukrotnie więcej
+ * miejsca niż pola gracza, zapomina pola jego obszarów, bo są one jedynie
+ * przyspieszeniem przeszukiwania.
  * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ *                         ze składową @p area_starts różną od NULL,
  * @param[in] player     – indeks gracza, liczba dodatnia
  *                         i niewiększa od składowej @p players
  *                         ze zmiennej @p g,
- * @param[in] x          – numer kolumny, mniejszy od składowej
- *                         @p board_width ze zmiennej @p g,
- * @param[in] y          – numer wiersza, mniejszy od składowej
- *                         @p board_height ze zmiennej @p g.
+ * @param[in] index      – indeks pola należącego do gracza.
  */
-static void update_other_players_adjacent_fields_after_removing(gamma_t *g,
-                                                                uint32_t player,
-                                                                uint32_t x, uint32_t y) {
-    uint32_t players_checked[3];
-    uint32_t players_count = 0;
-    if (x + 1 < g->board_width &&
-        does_field_belong_to_other_player(&g->fields[x + 1][y], player)) {
-        (g->players[g->fields[x + 1][y].owner_index - 1].adjacent_fields)++;
-        players_checked[players_count] = g->fields[x + 1][y].owner_index;
-        players_count++;
+static void add_area_start(gamma_t *g, uint32_t player, uint32_t index) {
+    area_starts *starts = &g->area_starts[player - 1];
+    if (starts->fields == NULL) {
+        return;
     }
 
-    if (x > 0 &&
-        does_field_belong_to_other_player(&g->fields[x - 1][y], player) &&
-        !was_player_adjacent_already_updated(g->fields[x - 1][y].owner_index,
-                                             players_checked, players_count)) {
-        (g->players[g->fields[x - 1][y].owner_index - 1].adjacent_fields)++;
-        players_checked[players_count] = g->fields[x - 1][y].owner_index;
-        players_count++;
+    if (starts->count == starts->capacity) {
+        uint64_t capacity = 2 * (uint64_t) starts->capacity;
+        uint32_t *fields = NULL;
+        if (capacity <= 2 * (uint64_t) g->players[player - 1].number_of_fields + 4) {
+            fields = realloc(starts->fields, capacity * sizeof(uint32_t));
+        }
+        if (fields == NULL) {
+            forget_area_starts(starts);
+            return;
+        }
+        starts->fields = fields;
+        starts->capacity = capacity;
     }
+    starts->fields[starts->count] = index;
+    (starts->count)++;
+}
 
-    if (y + 1 < g->board_height &&
-        does_field_belong_to_other_player(&g->fields[x][y + 1], player) &&
-        !was_player_adjacent_already_updated(g->fields[x][y + 1].owner_index,
-                                             players_checked, players_count)) {
-        (g->players[g->fields[x][y + 1].owner_index - 1].adjacent_fields)++;
-        players_checked[players_count] = g->fields[x][y + 1].owner_index;
-        players_count++;
+/** @brief Aktualizuje pola obszarów graczy po zmianie właściciela pola.
+ * Dopisuje pole o indeksie @p index do pól obszarów nowego właściciela,
+ * a sąsiednie pola dotychczasowego właściciela do jego pól obszarów, bo po
+ * utracie pola każdy z jego obszarów przy tym polu zawiera któreś z nich.
+ * Dzięki temu każdy obszar gracza zawiera co najmniej jedno z jego pól.
+ * @param[in, out] g       – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index        – indeks pola,
+ * @param[in] old_owner    – indeks dotychczasowego właściciela pola lub
+ *                           @ref DEFAULT_PLAYER_NUMBER,
+ * @param[in] new_owner    – indeks nowego właściciela pola lub
+ *                           @ref DEFAULT_PLAYER_NUMBER.
+ */
+static void update_area_starts(gamma_t *g, uint32_t index,
+                               uint32_t old_owner, uint32_t new_owner) {
+    if (g->area_starts == NULL) {
+        return;
     }
 
-    if (y > 0 &&
-        does_field_belong_to_other_player(&g->fields[x][y - 1], player) &&
-        !was_player_adjacent_already_updated(g->fields[x][y - 1].owner_index,
-                                             players_checked, players_count)) {
-        (g->players[g->fields[x][y - 1].owner_index - 1].adjacent_fields)++;
+    if (new_owner != DEFAULT_PLAYER_NUMBER) {
+        add_area_start(g, new_owner, index);
+    }
+    if (old_owner != DEFAULT_PLAYER_NUMBER) {
+        uint32_t adjacent[4];
+        uint32_t adjacent_count = adjacent_field_indices(g, index, adjacent);
+        for (uint32_t i = 0; i < adjacent_count; i++) {
+            if (field_at(g, adjacent[i])->owner_index == old_owner) {
+                add_area_start(g, old_owner, adjacent[i]);
+            }
+        }
     }
 }
 
-/** @brief Aktulizuje liczbę sąsiednich pól gracza po usunięciu pola.
- * Po usunięciu pola o współrzędnych (@p x, @p y),
- * sprawdza ile pustych pól sąsiadowało tylko z tym polem
- * spośród pól należących do gracza o indeksie @p player,
- * a następnie aktualizuje liczbę sąsiednich pól w tablicy
- * @p g->players dla danego gracza.
+/** @brief Zmienia właściciela pola.
+ * Ustawia właściciela pola (@p x, @p y) na @p owner, aktualizując
+ * przy tym liczniki celów złotego ruchu graczy, pola ich obszarów
+ * oraz liczbę graczy posiadających jakieś pole. Nie zmienia pozostałych danych o graczach.
  * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] player     – indeks gracza, liczba dodatnia
- *                         i niewiększa od składowej @p players
- *                         ze zmiennej @p g,
  * @param[in] x          – numer kolumny, mniejszy od składowej
  *                         @p board_width ze zmiennej @p g,
  * @param[in] y          – numer wiersza, mniejszy od składowej
- *                         @p board_height ze zmiennej @p g.
-*/
-static void update_player_adjacent_fields_after_removing(gamma_t *g, uint32_t player,
-                                                         uint32_t x, uint32_t y) {
-    uint32_t removed_fields = how_many_adjacent_fields_added(g, player, x, y);
-    g->players[player - 1].adjacent_fields -= removed_fields;
+ *                         @p board_height ze zmiennej @p g,
+ * @param[in] owner      – indeks nowego właściciela pola lub
+ *                         @ref DEFAULT_PLAYER_NUMBER.
+ */
+static void set_field_owner(gamma_t *g, uint32_t x, uint32_t y, uint32_t owner) {
+    update_golden_targets_around_field(g, x, y, false);
+    uint32_t index = field_index(g, x, y);
+    gamma_field *field = field_for_write(g, index);
+    uint32_t old_owner = field->owner_index;
+    record_field_change(g, FIELD_OWNER_CHANGE, index, old_owner);
+    field->owner_index = owner;
+    update_rendered_board(g, x, y, owner);
+    update_area_starts(g, index, old_owner, owner);
+    update_golden_targets_around_field(g, x, y, true);
 }
 
-/** @brief Usuwa pionek gracza z danego pola.
- * Usuwa pionek gracza @p player z pola (@p x, @p y).
- * Aktualizuje też liczbę obszarów i sąsiednich pól, które posiada
- * dany gracz.
+/** @brief Powiększa rzadką planszę.
+ * Co najmniej podwaja rozmiar tablicy @p fields, tak aby zmieściła
+ * @p needed kolejnych indeksów, i powiększa razem z nią zaalokowane tablice,
+ * których rozmiar zależy od liczby indeksów. Kolejki i tablice przeszukiwania
+ * w głąb są alokowane od nowa, więc żadne przeszukiwanie nie może być
+ * w tym czasie w toku.
  * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] player     – indeks gracza, liczba dodatnia
- *                         i niewiększa od składowej @p players
- *                         ze zmiennej @p g,
- * @param[in] x          – numer kolumny, mniejszy od składowej
- *                         @p board_width ze zmiennej @p g,
- * @param[in] y          – numer wiersza, mniejszy od składowej
- *                         @p board_height ze zmiennej @p g.
- * @return Wartość @p true jeśli usunięcie było legalne
- * lub wartość @p false w przeciwnym wypadku.
+ * @param[in] needed     – liczba potrzebnych indeksów.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku, wtedy rozmiar planszy się nie zmienia.
  */
-static bool remove_field_ownership(gamma_t *g, uint32_t player,
-                                   uint32_t x, uint32_t y) {
-    gamma_field *curr_field = &g->fields[x][y];
-    curr_field->owner_index = DEFAULT_PLAYER_NUMBER;
-    bool is_removal_legal = true;
+static bool grow_sparse_board(gamma_t *g, uint64_t needed) {
+    uint64_t capacity = 2 * g->nodes_capacity;
+    while (capacity < g->nodes_count + needed) {
+        capacity *= 2;
+    }
+    if (capacity > MAX_FIELDS_COUNT) {
+        capacity = MAX_FIELDS_COUNT;
+    }
+    if (g->nodes_count + needed > capacity ||
+        !field_board_grow(&g->fields, capacity)) {
+        return false;
+    }
 
-    set_adjacent_fields_as_root(g, player, x, y);
+    uint64_t *field_cells = realloc(g->field_cells, capacity * sizeof(uint64_t));
+    if (field_cells == NULL) {
+        return false;
+    }
+    g->field_cells = field_cells;
 
-    curr_field->parent_x = x;
-    curr_field->parent_y = y;
+    if (g->queue != NULL) {
+        uint32_t *visited = realloc(g->visited_fields_board,
+                                    capacity * sizeof(uint32_t));
+        if (visited == NULL) {
+            return false;
+        }
+        memset(visited + g->nodes_capacity, 0,
+               (capacity - g->nodes_capacity) * sizeof(uint32_t));
+        g->visited_fields_board = visited;
 
-    int area_count = update_areas_after_removal(g, player, x, y);
-    if ((g->players[player - 1].number_of_areas) + (area_count - 1) > g->max_areas) {
-        is_removal_legal = false;
+        field_queue *queue;
+        if (!field_queue_init(&queue, capacity)) {
+            return false;
+        }
+        field_queue_clear(&g->queue);
+        g->queue = queue;
     }
-    (g->players[player - 1].number_of_areas) += (area_count - 1);
-    (g->players[player - 1].number_of_fields)--;
-    (g->free_fields)++;
-    update_player_adjacent_fields_after_removing(g, player, x, y);
-    update_other_players_adjacent_fields_after_removing(g, player, x, y);
-    if (area_count > 0) {
-        // Jeśli pole nie było jedynym elementem obszaru, teraz
-        // staje się wolnym, sąsiednim polem dla danego gracza.
-        (g->players[player - 1].adjacent_fields)++;
+    for (uint32_t i = 0; i < SPLIT_SEARCHES_COUNT; i++) {
+        field_queue_clear(&g->split_queues[i]);
     }
+    free(g->dfs_fields);
+    free(g->dfs_stack);
+    g->dfs_fields = NULL;
+    g->dfs_stack = NULL;
 
-    return is_removal_legal;
+    g->nodes_capacity = capacity;
+    return true;
 }
 
-bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    if (!are_golden_move_parameters_valid(g, player, x, y) ||
-        (g->players[player - 1].number_of_areas == g->max_areas &&
-         !does_player_own_adjacent_fields(g, player, x, y))) {
+/** @brief Sprawdza, czy jest miejsce na nowe węzły find and union.
+ * Przygotowuje do zapisu kafelki, w których znajdą się nowe węzły,
+ * a w razie potrzeby powiększa rzadką planszę.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] needed     – liczba potrzebnych węzłów.
+ * @return Wartość @p true, jeśli tablica @p fields zmiennej @p g mieści
+ * @p needed kolejnych węzłów lub @p false w przeciwnym wypadku.
+ */
+static inline bool has_room_for_field_nodes(gamma_t *g, uint64_t needed) {
+    if (g->nodes_count + needed > g->nodes_capacity &&
+        !(is_board_sparse(g) && grow_sparse_board(g, needed))) {
         return false;
     }
+    return field_board_reserve(&g->fields, g->nodes_count, needed) &&
+           field_map_reserve(g->field_nodes, needed);
+}
 
-    uint32_t target_player = g->fields[x][y].owner_index;
-    bool was_removing_successful = remove_field_ownership(g, target_player, x, y);
-    if (was_removing_successful) {
-        gamma_move(g, player, x, y);
-        g->players[player - 1].has_golden_move_available = false;
+/** @brief Zapewnia, że pole ma indeks w tablicy pól.
+ * W rzadkiej planszy przypisuje polu (@p x, @p y), do którego nic jeszcze
+ * nie zapisano, kolejny indeks w tablicy @p fields. W gęstej planszy
+ * każde pole ma już indeks.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] x          – numer kolumny, mniejszy od składowej
+ *                         @p board_width ze zmiennej @p g,
+ * @param[in] y          – numer wiersza, mniejszy od składowej
+ *                         @p board_height ze zmiennej @p g.
+ * @return Wartość @p true, jeśli pole ma indeks, lub @p false,
+ * jeśli nie udało się zaalokować dla niego pamięci.
+ */
+static bool ensure_field_index(gamma_t *g, uint32_t x, uint32_t y) {
+    if (field_index(g, x, y) != FIELD_MAP_ABSENT) {
         return true;
     }
-    else {
-        //Jeśli usuwanie pola było nielegalne, przywraca stan sprzed usunięcia.
-        gamma_move(g, target_player, x, y);
+
+    uint64_t cell = (uint64_t) y * g->board_width + x;
+    uint32_t index = g->nodes_count;
+    if (!has_room_for_field_nodes(g, 1) ||
+        !field_map_insert(g->sparse_fields, cell, index)) {
         return false;
     }
+    (g->nodes_count)++;
+    g->field_cells[index] = cell;
+    gamma_field *field = field_for_write(g, index);
+    field->owner_index = DEFAULT_PLAYER_NUMBER;
+    set_field_as_root(field);
+    return true;
 }
 
-uint64_t gamma_busy_fields(gamma_t *g, uint32_t player) {
-    if (g == NULL || !is_player_parameter_valid(g, player)) {
-        return 0;
+/** @brief Rozpoczyna zapisywanie ruchu w dzienniku.
+ * Zapamiętuje dane potrzebne do cofnięcia ruchu, który zaraz zostanie
+ * wykonany. Nic nie robi, jeśli cofanie ruchów jest wyłączone.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry.
+ */
+static void begin_journaled_move(gamma_t *g) {
+    undo_log *undo = g->undo;
+    if (undo == NULL) {
+        return;
     }
-    else {
-        return g->players[player - 1].number_of_fields;
+
+    (g->move_number)++;
+    if (undo->moves_count == undo->moves_capacity &&
+        !grow_undo_array((void **) &undo->moves, &undo->moves_capacity,
+                         sizeof(move_record))) {
+        undo->has_failed = true;
+        return;
     }
+
+    move_record *record = &undo->moves[undo->moves_count];
+    record->field_changes = field_journal_size(undo->fields);
+    record->player_changes = undo->players_count;
+    record->free_fields = g->free_fields;
+    record->nodes_count = g->nodes_count;
+    record->players_with_fields = g->players_with_fields;
+    (undo->moves_count)++;
 }
 
-uint64_t gamma_free_fields(gamma_t *g, uint32_t player) {
-    if (g == NULL || !is_player_parameter_valid(g, player)) {
-        return 0;
-    }
-    else if (g->players[player - 1].number_of_areas < g->max_areas) {
-        return g->free_fields;
-    }
-    else {
-        return g->players[player - 1].adjacent_fields;
+/** @brief Kończy zapisywanie ruchu w dzienniku.
+ * Jeśli którejś zmiany nie udało się zapisać, ruchu nie da się cofnąć,
+ * a więc nie da się też cofnąć żadnego wcześniejszego ruchu,
+ * więc dziennik zostaje opróżniony.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry.
+ */
+static void end_journaled_move(gamma_t *g) {
+    undo_log *undo = g->undo;
+    if (undo != NULL &&
+        (undo->has_failed || field_journal_has_failed(undo->fields))) {
+        field_journal_reset(undo->fields);
+        undo->players_count = 0;
+        undo->moves_count = 0;
+        undo->has_failed = false;
     }
 }
 
-/** @brief Przechodzi pola danego gracza w obrębie jednej składowej.
- * Przechodzi wszystkie pola danego gracza, które
- * po złotym ruchu należałyby do jednej składowej
- * oraz łączą się z polem o współrzędnych (@p x, @p y).
- * Uwaga - nie resetuje mapy odwiedzonych pól w strukturze @p g.
- * @param[in, out] g        – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] x             – numer kolumny, mniejszy od składowej
- *                          @p board_width ze zmiennej @p g,
- * @param[in] y             – numer wiersza, mniejszy od składowej
- *                          @p board_height ze zmiennej @p g.
+/** @brief Przygotowuje do zapisu kafelki zmieniane przez postawienie pionka.
+ * Przygotowuje kafelek pola o indeksie @p index oraz kafelki ścieżek
+ * do korzeni węzła tego pola i węzłów sąsiednich pól gracza @p player,
+ * do których piszą funkcje @ref set_field_owner i @ref add_and_unite_field.
+ * Nie zmienia stanu gry, więc ruch, którego nie udało się przygotować,
+ * można po prostu odrzucić.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] player     – indeks gracza, liczba dodatnia
+ *                         i niewiększa od składowej @p players_count,
+ * @param[in] index      – indeks pola.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku.
  */
-static void traverse_player_fields(gamma_t *g, uint32_t x, uint32_t y) {
-    field_queue *queue = NULL;
-    field_queue_init(&queue);
-    field_queue_push(queue, &g->fields[x][y]);
-    g->visited_fields_board[x][y] = true;
+static bool reserve_pawn_placement(gamma_t *g, uint32_t player, uint32_t index) {
+    if (!field_board_reserve(&g->fields, index, 1) ||
+        !field_board_reserve_path(&g->fields, field_node(g, index))) {
+        return false;
+    }
 
-    while (!field_queue_is_empty(queue)) {
-        gamma_field *curr_field = field_queue_pop(queue);
-        add_adjacent_fields_to_queue(queue, g, curr_field);
+    uint32_t adjacent[SPLIT_SEARCHES_COUNT];
+    uint32_t adjacent_count = adjacent_field_indices(g, index, adjacent);
+    for (uint32_t i = 0; i < adjacent_count; i++) {
+        if (field_at(g, adjacent[i])->owner_index == player &&
+            !field_board_reserve_path(&g->fields, field_node(g, adjacent[i]))) {
+            return false;
+        }
     }
-    field_queue_clear(&queue);
+    return true;
 }
 
-/** @brief Sprawdza, czy gracz może wykonać złoty ruch na dane pole.
- * Sprawdza, czy gracz o indekse @p player może wykonać
- * złoty ruch na pole o współrzędnych (@p x, @p y)
- * bez zwiększania liczby swoich obszarów.
- * @param[in, out] g        – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] owner_index   – indeks gracza, liczba dodatnia
- *                          i niewiększa od składowej @p players
- *                          ze zmiennej @p g,
- * @param[in] x             – numer kolumny, mniejszy od składowej
- *                          @p board_width ze zmiennej @p g,
- * @param[in] y             – numer wiersza, mniejszy od składowej
- *                          @p board_height ze zmiennej @p g.
- * @return Wartość @p true, jeśli gracz może wykonać złoty ruch
- * lub @p false w przeciwnym wypadku.
+/** @brief Stawia pionek gracza na wolnym polu.
+ * Aktualizuje dane gracza @p player i pozostałych graczy oraz zbiory
+ * find and union. Zakłada, że ruch jest legalny.
+ * @param[in, out] g              – wskaźnik na strukturę przechowującą
+ *                                  dane gry,
+ * @param[in] player              – indeks gracza, liczba dodatnia
+ *                                  i niewiększa od składowej @p players_count,
+ * @param[in] x                   – numer kolumny, mniejszy od składowej
+ *                                  @p board_width,
+ * @param[in] y                   – numer wiersza, mniejszy od składowej
+ *                                  @p board_height,
+ * @param[in] is_creating_new_area – zmienna mówiąca o tym, czy gracz
+ *                                  nie posiada pól sąsiednich do (@p x, @p y).
  */
-static uint32_t areas_left_after_golden_move(gamma_t *g, uint32_t owner_index,
-                                             uint32_t x, uint32_t y) {
-    uint32_t areas = 0;
-    g->visited_fields_board[x][y] = true;
+static void place_pawn(gamma_t *g, uint32_t player, uint32_t x, uint32_t y,
+                       bool is_creating_new_area) {
+    player_t *curr_player = player_for_update(g, player);
 
-    if(x + 1 < g->board_width &&
-       should_field_be_visited(&g->fields[x + 1][y], owner_index, g->visited_fields_board)) {
-        areas++;
-        traverse_player_fields(g, x + 1, y);
-    }
-    if(x > 0 &&
-       should_field_be_visited(&g->fields[x - 1][y], owner_index, g->visited_fields_board)) {
-        areas++;
-        traverse_player_fields(g, x - 1, y);
+    (curr_player->number_of_fields)++;
+    if (curr_player->number_of_fields == 1) {
+        (g->players_with_fields)++;
     }
-    if(y + 1 < g->board_height &&
-       should_field_be_visited(&g->fields[x][y + 1], owner_index, g->visited_fields_board)) {
-        areas++;
-        traverse_player_fields(g, x, y + 1);
+    (curr_player->adjacent_fields) += how_many_adjacent_fields_added(g, player, x, y);
+    (g->free_fields)--;
+    if (is_creating_new_area) {
+        curr_player->number_of_areas++;
     }
-    if(y > 0 &&
-       should_field_be_visited(&g->fields[x][y - 1], owner_index, g->visited_fields_board)) {
-        areas++;
-        traverse_player_fields(g, x, y - 1);
+    else {
+        uint32_t united_fields = add_and_unite_field(g, player, x, y);
+        (curr_player->number_of_areas) -= united_fields;
+        (curr_player->number_of_areas) += 1;
+        (curr_player->adjacent_fields)--;
     }
+    set_field_owner(g, x, y, player);
 
-    return areas;
+    update_other_players_adjacent_fields_after_move(g, player, x, y);
 }
 
-/** @brief Sprawdza, czy złoty ruch gracza na dane pole byłby legalny.
- * Sprawdza, czy można wykonać legalny złoty ruch
- * na pole o współrzędnych (@p x, @p y).
- * Funkcja zakłada, że pole należy do jakiegoś gracza.
- * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
- * @param[in] x          – numer kolumny, mniejszy od składowej
- *                         @p board_width ze zmiennej @p g,
- * @param[in] y          – numer wiersza, mniejszy od składowej
- *                         @p board_height ze zmiennej @p g.
- * @return Wartość @p true, jeśli gracz może wykonać złoty ruch
- * lub @p false w przeciwnym wypadku.
- */
-static bool would_golden_move_be_legal(gamma_t *g, uint32_t x, uint32_t y) {
-    uint32_t owner_index = g->fields[x][y].owner_index;
-    uint32_t new_areas_count = areas_left_after_golden_move(g, owner_index, x, y) - 1;
+bool gamma_move(gamma_t *g, uint32_t player,
+                uint32_t x, uint32_t y) {
+    if (!are_gamma_move_parameters_valid(g, player, x, y) ||
+        get_field(g, x, y)->owner_index != DEFAULT_PLAYER_NUMBER) {
+        return false;
+    }
 
-    reset_visited_map(g);
-    return (g->players[owner_index - 1].number_of_areas + new_areas_count <= g->max_areas);
+    bool is_creating_new_area = !does_player_own_adjacent_fields(g, player, x, y);
+    if (g->players[player - 1].number_of_areas == g->max_areas &&
+        is_creating_new_area) {
+        return false;
+    }
+
+    if (!ensure_field_index(g, x, y) ||
+        !reserve_pawn_placement(g, player, field_index(g, x, y))) {
+        return false;
+    }
+
+    begin_journaled_move(g);
+    place_pawn(g, player, x, y, is_creating_new_area);
+    end_journaled_move(g);
+    count_move(g, WAL_MOVE, player, x, y);
+    return true;
 }
 
-/** @brief Sprawdza, czy gracz może wykonać złoty ruch na dane pole.
- * Sprawdza, czy gracz o indekse @p player może wykonać
- * złoty ruch na pole o współrzędnych (@p x, @p y)
- * bez zwiększania liczby swoich obszarów.
- * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+/** @brief Sprawdza, czy parametry funkcji @ref gamma_golden_move śa prawidłowe.
+ * Sprawdza, czy parametry @p player, @p x i @p y mieszczą się w zakresach
+ * ustalanych przez składowe zmiennej @p board, odpowiednio @p players_count,
+ * @p board_width i @p board_height.
+ * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
  * @param[in] player     – indeks gracza, liczba dodatnia
  *                         i niewiększa od składowej @p players
  *                         ze zmiennej @p g,
@@ -1012,193 +2174,2348 @@ static bool would_golden_move_be_legal(gamma_t *g, uint32_t x, uint32_t y) {
  *                         @p board_width ze zmiennej @p g,
  * @param[in] y          – numer wiersza, mniejszy od składowej
  *                         @p board_height ze zmiennej @p g.
- * @return Wartość @p true, jeśli gracz może wykonać złoty ruch
- * lub @p false w przeciwnym wypadku.
+ * @return
  */
-static bool can_player_use_golden_move_on_this_field(gamma_t  *g, uint32_t player,
-                                                     uint32_t  x, uint32_t y) {
-    if(does_field_belong_to_other_player(&g->fields[x][y], player) &&
-       does_player_own_adjacent_fields(g, player, x, y)) {
-        return would_golden_move_be_legal(g, x, y);
+static bool are_golden_move_parameters_valid(gamma_t *g, uint32_t player,
+                                             uint32_t x, uint32_t y) {
+    if (g == NULL || x >= g->board_width || y >= g->board_height) {
+        return false;
     }
 
-    return false;
+    uint32_t field_owner = get_field(g, x, y)->owner_index;
+    return (gamma_golden_possible(g, player) &&
+            field_owner != DEFAULT_PLAYER_NUMBER &&
+            field_owner != player);
 }
 
-/** @brief Sprawdza, czy istnieje pole, na które gracz może wykonać złoty ruch.
- * Sprawdza, czy istnieje pole innego gracza niż ten o indeksie @p player,
- * na które dany gracz może wykonać złoty ruch bez zwiększenia liczby
- * swoich obszarów oraz nie sprawiając, że inny gracz po takim ruchu
- * będzie miał za dużą liczbę obszaróœ.
- * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
- * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
- *                      @p players z funkcji @ref gamma_new.
- * @return Wartość @p true, jeśli takie pole istnieje
- * lub @p false w przeciwnym wypadku.
+/** @brief Sprawdza, czy dane pole powinno zostać odwiedzone podczas przechodzenia planszy.
+ * Sprawdza, czy pole o indeksie @p index spełnia następujące warunki:
+ * nie zostało jeszcze odwiedzone,
+ * należy do danego gracza.
+ * @param[in] g           – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index       – indeks pola,
+ * @param[in] player      – indeks gracza, liczba dodatnia.
+ * @return Wartosć @p true jeśli pole spełnia powyższe warunki
+ *         lub wartość @p false, jeśli ich nie spełnia.
  */
-static bool can_player_use_golden_move(gamma_t *g, uint32_t player) {
-    for(uint32_t i = 0; i < g->board_width; i++) {
-        for(uint32_t j = 0; j < g->board_height; j++) {
-            if(can_player_use_golden_move_on_this_field(g, player, i, j)) {
-                return true;
-            }
+static inline bool should_field_be_visited(gamma_t *g, uint32_t index,
+                                           uint32_t player) {
+    return (field_at(g, index)->owner_index == player &&
+            !is_field_visited(g, index));
+}
+
+/** @brief Dodaje pole do kolejki, jeśli powinno zostać odwiedzone.
+ * Jeśli pole o indeksie @p index nie zostało odwiedzone i należy
+ * do gracza @p player, oznacza je jako odwiedzone i dodaje do kolejki.
+ * @param[in, out] queue – wskaźnik na strukturę reprezentującą kolejkę
+ *                         indeksów pól,
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks pola,
+ * @param[in] player     – indeks gracza, liczba dodatnia.
+ */
+static inline void visit_field(field_queue *queue, gamma_t *g,
+                               uint32_t index, uint32_t player) {
+    if (should_field_be_visited(g, index, player)) {
+        field_queue_push(queue, index);
+        mark_field_visited(g, index);
+    }
+}
+
+/** @brief Dodaje do kolejki sąsiednie pola w ramach algorytmu BFS.
+ * Dodaje do kolejki @p queue pola sąsiednie do pola o indeksie @p index,
+ * jeśli nie zostały one odwiedzone i należą do tego samego gracza,
+ * co pole o indeksie @p index.
+ * @param[in, out] queue – wskaźnik na strukturę reprezentującą kolejkę
+ *                         indeksów pól,
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks pola.
+ */
+static void add_adjacent_fields_to_queue(field_queue *queue, gamma_t *g,
+                                         uint32_t index) {
+    uint32_t owner = field_at(g, index)->owner_index;
+    uint32_t adjacent[SPLIT_SEARCHES_COUNT];
+    uint32_t adjacent_count = adjacent_field_indices(g, index, adjacent);
+    for (uint32_t i = 0; i < adjacent_count; i++) {
+        visit_field(queue, g, adjacent[i], owner);
+    }
+}
+
+/** @brief Przypisuje polu nowy węzeł find and union.
+ * Nowy węzeł jest korzeniem jednoelementowego zbioru. Poprzedni węzeł pola
+ * pozostaje w drzewie swojego zbioru, więc ścieżki pozostałych pól
+ * do korzenia nie ulegają zmianie. W tablicy @p fields musi być
+ * miejsce na nowy węzeł.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks pola.
+ * @return Indeks nowego węzła.
+ */
+static uint32_t add_field_node(gamma_t *g, uint32_t index) {
+    uint32_t node = g->nodes_count;
+    (g->nodes_count)++;
+    if (is_board_sparse(g)) {
+        g->field_cells[node] = NO_FIELD_CELL;
+    }
+    set_field_node(g, index, node);
+    // Nowy węzeł nie był dotąd używany, więc jego zmiana nie jest zapisywana.
+    set_field_as_root(field_for_write(g, node));
+    return node;
+}
+
+/** @brief Ustanawia nowy zbiór find and union dla obszaru.
+ * Korzystając z algorytmu BFS, odwiedza obszar, do którego należy pole
+ * o indeksie @p start, i podpina węzły wszystkich jego pól bezpośrednio
+ * pod węzeł tego pola. Jeśli @p use_new_nodes ma wartość @p true,
+ * każde pole obszaru otrzymuje nowy węzeł, w przeciwnym wypadku
+ * wykorzystywane są węzły o indeksach pól.
+ * Uwaga - nie resetuje mapy odwiedzonych pól w strukturze @p g.
+ * @param[in, out] g        – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] start         – indeks pola,
+ * @param[in] use_new_nodes – zmienna mówiąca o tym, czy pola mają
+ *                            otrzymać nowe węzły.
+ */
+static void relabel_area(gamma_t *g, uint32_t start, bool use_new_nodes) {
+    field_queue *queue = g->queue;
+    field_queue_push(queue, start);
+    mark_field_visited(g, start);
+    uint32_t root = use_new_nodes ? add_field_node(g, start) : start;
+    bool has_children = false;
+
+    while (!field_queue_is_empty(queue)) {
+        uint32_t curr_field = field_queue_pop(queue);
+
+        if (curr_field != start) {
+            uint32_t node = use_new_nodes ? add_field_node(g, curr_field) : curr_field;
+            set_node_parent(g, node, FIELD_PARENT_FLAG | root);
+            has_children = true;
+        }
+
+        add_adjacent_fields_to_queue(queue, g, curr_field);
+    }
+    // Korzeń z dziećmi ma rangę 1.
+    set_node_parent(g, root, has_children);
+}
+
+/** @brief Odbudowuje zbiory find and union wszystkich obszarów.
+ * Przypisuje każdemu polu węzeł o jego indeksie, zwalniając wszystkie
+ * dodatkowe węzły, i ustanawia od nowa zbiór każdego obszaru na planszy.
+ * W rzadkiej planszy indeksy dodatkowych węzłów przeplatają się z indeksami
+ * pól, więc nie są zwalniane, ale odbudowa nie potrzebuje nowych węzłów.
+ * Działa w czasie liniowym względem liczby pól, więc jest wywoływana
+ * jedynie po wyczerpaniu limitu węzłów. Pisze jedynie do zaalokowanych
+ * kafelków, które muszą być przygotowane do zapisu.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry.
+ */
+static void rebuild_all_areas(gamma_t *g) {
+    bool is_sparse = is_board_sparse(g);
+    uint64_t count = is_sparse ? g->nodes_count : fields_count(g);
+    for (uint64_t i = 0; i < count; i++) {
+        if ((!is_sparse || g->field_cells[i] != NO_FIELD_CELL) &&
+            field_node(g, i) != i) {
+            set_field_node(g, i, i);
+        }
+    }
+    if (!is_sparse) {
+        g->nodes_count = count;
+    }
+
+    for (uint64_t i = 0; i < count; i++) {
+        if (is_sparse && g->field_cells[i] == NO_FIELD_CELL) {
+            continue;
+        }
+        else if (field_at(g, i)->owner_index == DEFAULT_PLAYER_NUMBER) {
+            // Pola z niezaalokowanych kafelków są już korzeniami.
+            if (field_at(g, i)->parent != FIELD_SINGLE_ROOT) {
+                set_node_parent(g, i, FIELD_SINGLE_ROOT);
+            }
+        }
+        else if (!is_field_visited(g, i)) {
+            relabel_area(g, i, false);
+        }
+    }
+    reset_visited_map(g);
+}
+
+/** @brief Alokuje kolejki przeszukiwań obszaru po usunięciu pola.
+ * Jeśli kolejki nie zostały jeszcze zaalokowane, alokuje
+ * @ref SPLIT_SEARCHES_COUNT kolejek mieszczących indeksy wszystkich pól.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry.
+ * @return Wartość @p true, jeśli kolejki są zaalokowane
+ * lub @p false, jeśli alokacja się nie powiodła.
+ */
+static bool allocate_split_queues(gamma_t *g) {
+    if (g->split_queues[SPLIT_SEARCHES_COUNT - 1] != NULL) {
+        return true;
+    }
+
+    for (uint32_t i = 0; i < SPLIT_SEARCHES_COUNT; i++) {
+        if (!field_queue_init(&g->split_queues[i], indices_count(g))) {
+            for (uint32_t j = 0; j < i; j++) {
+                field_queue_clear(&g->split_queues[j]);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Znajduje grupę, do której należy przeszukiwanie.
+ * Przeszukiwania, które dotarły do tego samego obszaru, tworzą grupę.
+ * @param[in] search     – wskaźnik na stan przeszukiwań,
+ * @param[in] i          – numer przeszukiwania.
+ * @return Numer przeszukiwania reprezentującego grupę.
+ */
+static inline uint32_t split_search_group(const split_search *search, uint32_t i) {
+    while (search->group[i] != i) {
+        i = search->group[i];
+    }
+    return i;
+}
+
+/** @brief Wykonuje jeden krok przeszukiwania obszaru po usunięciu pola.
+ * Wyjmuje pole z kolejki przeszukiwania @p i i oznacza jego nieodwiedzone
+ * sąsiednie pola tego samego gracza, z wyjątkiem pola @p removed,
+ * numerem przejścia @p base + @p i. Jeśli sąsiednie pole zostało odwiedzone
+ * przez inne przeszukiwanie, łączy grupy obu przeszukiwań.
+ * @param[in, out] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in, out] search – wskaźnik na stan przeszukiwań,
+ * @param[in] i           – numer przeszukiwania, którego kolejka nie jest pusta,
+ * @param[in] base        – numer przejścia planszy przeszukiwania 0,
+ * @param[in] removed     – indeks usuwanego pola.
+ */
+static void expand_split_search(gamma_t *g, split_search *search, uint32_t i,
+                                uint32_t base, uint32_t removed) {
+    field_queue *queue = g->split_queues[i];
+    uint32_t index = field_queue_pop(queue);
+    uint32_t owner = field_at(g, index)->owner_index;
+
+    uint32_t adjacent[SPLIT_SEARCHES_COUNT];
+    uint32_t adjacent_count = adjacent_field_indices(g, index, adjacent);
+
+    for (uint32_t j = 0; j < adjacent_count; j++) {
+        uint32_t next = adjacent[j];
+        if (field_at(g, next)->owner_index != owner || next == removed) {
+            continue;
+        }
+
+        // Pola nieodwiedzone mają numer przejścia mniejszy od base.
+        uint32_t other = g->visited_fields_board[next] - base;
+        if (other < search->searches) {
+            uint32_t group1 = split_search_group(search, i);
+            uint32_t group2 = split_search_group(search, other);
+            if (group1 < group2) {
+                search->group[group2] = group1;
+            }
+            else {
+                search->group[group1] = group2;
+            }
+        }
+        else {
+            g->visited_fields_board[next] = base + i;
+            field_queue_push(queue, next);
+            (search->sizes[i])++;
+        }
+    }
+}
+
+/** @brief Wyznacza obszary, na które rozpadnie się obszar po usunięciu pola.
+ * Prowadzi naprzemiennie przeszukiwania od każdego należącego do gracza
+ * @p player pola sąsiadującego bokiem z polem (@p x, @p y), pomijając
+ * to pole i łącząc przeszukiwania, które się spotkały. Kończy, gdy
+ * co najwyżej jedna grupa przeszukiwań nie przeszła jeszcze całego swojego
+ * obszaru, więc koszt jest proporcjonalny do rozmiaru mniejszych obszarów.
+ * Nie zmienia stanu gry, a jedynie mapę odwiedzonych pól i kolejki
+ * przeszukiwań, które muszą być zaalokowane.
+ * @param[in, out] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] player      – indeks gracza, liczba dodatnia
+ *                          i niewiększa od składowej @p players
+ *                          ze zmiennej @p g,
+ * @param[in] x           – numer kolumny, mniejszy od składowej
+ *                          @p board_width ze zmiennej @p g,
+ * @param[in] y           – numer wiersza, mniejszy od składowej
+ *                          @p board_height ze zmiennej @p g,
+ * @param[out] search     – wskaźnik na stan przeszukiwań; składowa @p kept
+ *                          wskazuje grupę, której obszar jest największy
+ *                          lub nie został przejrzany do końca.
+ * @return Liczba w zakresie 0-4 oznaczająca liczbę różnych obszarów,
+ * do których należą należące do gracza @p player pola sąsiednie
+ * do pola o współrzędnych (@p x, @p y).
+ */
+static uint32_t explore_areas_after_removal(gamma_t *g, uint32_t player,
+                                            uint32_t x, uint32_t y,
+                                            split_search *search) {
+    uint32_t removed = field_index(g, x, y);
+    uint32_t base = g->visited_epoch;
+    search->searches = 0;
+    for (int32_t i = 0; i < RING_SIZE; i += 2) {
+        uint32_t adjacent_x = x + RING_DX[i];
+        uint32_t adjacent_y = y + RING_DY[i];
+        if (adjacent_x < g->board_width && adjacent_y < g->board_height &&
+            get_field(g, adjacent_x, adjacent_y)->owner_index == player) {
+            uint32_t index = field_index(g, adjacent_x, adjacent_y);
+            uint32_t searches = search->searches;
+            search->starts[searches] = index;
+            search->group[searches] = searches;
+            search->sizes[searches] = 1;
+            g->visited_fields_board[index] = base + searches;
+            field_queue_push(g->split_queues[searches], index);
+            (search->searches)++;
+        }
+    }
+
+    uint32_t searches = search->searches;
+    uint32_t areas_count = searches;
+    uint32_t unfinished_areas = searches;
+    while (unfinished_areas > 1) {
+        for (uint32_t i = 0; i < searches; i++) {
+            if (!field_queue_is_empty(g->split_queues[i])) {
+                expand_split_search(g, search, i, base, removed);
+            }
+        }
+
+        areas_count = 0;
+        unfinished_areas = 0;
+        for (uint32_t i = 0; i < searches; i++) {
+            if (split_search_group(search, i) != i) {
+                continue;
+            }
+            areas_count++;
+            for (uint32_t j = 0; j < searches; j++) {
+                if (split_search_group(search, j) == i &&
+                    !field_queue_is_empty(g->split_queues[j])) {
+                    unfinished_areas++;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Wyróżnia obszar, którego przeszukiwanie trwa,
+    // a jeśli wszystkie się zakończyły, największy obszar.
+    search->kept = searches;
+    for (uint32_t i = 0; i < searches; i++) {
+        uint32_t group = split_search_group(search, i);
+        if (group != i) {
+            search->sizes[group] += search->sizes[i];
+        }
+        if (!field_queue_is_empty(g->split_queues[i])) {
+            search->kept = group;
+        }
+        field_queue_reset(g->split_queues[i]);
+    }
+    bool are_all_searches_finished = (search->kept == searches);
+    for (uint32_t i = 0; i < searches && are_all_searches_finished; i++) {
+        if (split_search_group(search, i) == i &&
+            (search->kept == searches ||
+             search->sizes[search->kept] < search->sizes[i])) {
+            search->kept = i;
+        }
+    }
+    advance_visited_epoch(g, SPLIT_SEARCHES_COUNT);
+
+    return areas_count;
+}
+
+/** @brief Aktualizuje zbiory find and union po podziale obszaru.
+ * Obszar, który według przeszukiwań @p search jest największy lub nie został
+ * przejrzany do końca, zachowuje dotychczasowy zbiór, a pola pozostałych
+ * obszarów oraz pole o indeksie @p index otrzymują nowe węzły, więc koszt
+ * jest proporcjonalny do rozmiaru mniejszych obszarów. Miejsce na nowe
+ * węzły musi być wcześniej zapewnione, patrz @ref plan_field_removal.
+ * Pole o indeksie @p index nie może należeć do żadnego gracza.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks usuniętego pola,
+ * @param[in] search     – wskaźnik na wynik funkcji
+ *                         @ref explore_areas_after_removal.
+ */
+static void split_area_after_removal(gamma_t *g, uint32_t index,
+                                     const split_search *search) {
+    for (uint32_t i = 0; i < search->searches; i++) {
+        if (split_search_group(search, i) == i && i != search->kept) {
+            relabel_area(g, search->starts[i], true);
+        }
+    }
+    reset_visited_map(g);
+    add_field_node(g, index);
+}
+
+/** @brief Po usunięciu, aktualizuje liczbę pól sąsiednich do pól innych graczy.
+ * Sprawdza, czy pola sąsiednie do pola o współrzędnych (@p x, @p y)
+ * należą do innego gracza, niż tego o indeksie @p player. Jeśli tak,
+ * aktualizuje dla każdego danego gracza całkowitą ilość pól sąsiadujących
+ * z jego polami. Jeśli danemu graczowi już tę liczbę zaktualizowano,
+ * pomija dane pole.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] player     – indeks gracza, liczba dodatnia
+ *                         i niewiększa od składowej @p players
+ *                         ze zmiennej @p g,
+ * @param[in] x          – numer kolumny, mniejszy od składowej
+ *                         @p board_width ze zmiennej @p g,
+ * @param[in] y          – numer wiersza, mniejszy od składowej
+ *                         @p board_height ze zmiennej @p g.
+ */
+static void update_other_players_adjacent_fields_after_removing(gamma_t *g,
+                                                                uint32_t player,
+                                                                uint32_t x, uint32_t y) {
+    uint32_t players_checked[3];
+    uint32_t players_count = 0;
+    if (x + 1 < g->board_width &&
+        does_field_belong_to_other_player(get_field(g, x + 1, y), player)) {
+        (player_for_update(g, get_field(g, x + 1, y)->owner_index)->adjacent_fields)++;
+        players_checked[players_count] = get_field(g, x + 1, y)->owner_index;
+        players_count++;
+    }
+
+    if (x > 0 &&
+        does_field_belong_to_other_player(get_field(g, x - 1, y), player) &&
+        !was_player_adjacent_already_updated(get_field(g, x - 1, y)->owner_index,
+                                             players_checked, players_count)) {
+        (player_for_update(g, get_field(g, x - 1, y)->owner_index)->adjacent_fields)++;
+        players_checked[players_count] = get_field(g, x - 1, y)->owner_index;
+        players_count++;
+    }
+
+    if (y + 1 < g->board_height &&
+        does_field_belong_to_other_player(get_field(g, x, y + 1), player) &&
+        !was_player_adjacent_already_updated(get_field(g, x, y + 1)->owner_index,
+                                             players_checked, players_count)) {
+        (player_for_update(g, get_field(g, x, y + 1)->owner_index)->adjacent_fields)++;
+        players_checked[players_count] = get_field(g, x, y + 1)->owner_index;
+        players_count++;
+    }
+
+    if (y > 0 &&
+        does_field_belong_to_other_player(get_field(g, x, y - 1), player) &&
+        !was_player_adjacent_already_updated(get_field(g, x, y - 1)->owner_index,
+                                             players_checked, players_count)) {
+        (player_for_update(g, get_field(g, x, y - 1)->owner_index)->adjacent_fields)++;
+    }
+}
+
+/** @brief Aktulizuje liczbę sąsiednich pól gracza po usunięciu pola.
+ * Po usunięciu pola o współrzędnych (@p x, @p y),
+ * sprawdza ile pustych pól sąsiadowało tylko z tym polem
+ * spośród pól należących do gracza o indeksie @p player,
+ * a następnie aktualizuje liczbę sąsiednich pól w tablicy
+ * @p g->players dla danego gracza.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] player     – indeks gracza, liczba dodatnia
+ *                         i niewiększa od składowej @p players
+ *                         ze zmiennej @p g,
+ * @param[in] x          – numer kolumny, mniejszy od składowej
+ *                         @p board_width ze zmiennej @p g,
+ * @param[in] y          – numer wiersza, mniejszy od składowej
+ *                         @p board_height ze zmiennej @p g.
+*/
+static void update_player_adjacent_fields_after_removing(gamma_t *g, uint32_t player,
+                                                         uint32_t x, uint32_t y) {
+    uint32_t removed_fields = how_many_adjacent_fields_added(g, player, x, y);
+    player_for_update(g, player)->adjacent_fields -= removed_fields;
+}
+
+/** @brief Usuwa pionek gracza z danego pola.
+ * Usuwa pionek gracza @p player z pola (@p x, @p y) zgodnie z planem
+ * wyznaczonym przez funkcję @ref plan_field_removal.
+ * Aktualizuje też liczbę obszarów i sąsiednich pól, które posiada
+ * dany gracz.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] player     – indeks gracza, liczba dodatnia
+ *                         i niewiększa od składowej @p players
+ *                         ze zmiennej @p g,
+ * @param[in] x          – numer kolumny, mniejszy od składowej
+ *                         @p board_width ze zmiennej @p g,
+ * @param[in] y          – numer wiersza, mniejszy od składowej
+ *                         @p board_height ze zmiennej @p g,
+ * @param[in] plan       – wskaźnik na plan usunięcia pionka.
+ */
+static void remove_field_ownership(gamma_t *g, uint32_t player,
+                                   uint32_t x, uint32_t y,
+                                   const removal_plan *plan) {
+    uint32_t index = field_index(g, x, y);
+    set_field_owner(g, x, y, DEFAULT_PLAYER_NUMBER);
+
+    uint32_t area_count = plan->areas_count;
+    if (plan->kind == REMOVAL_LAST_FIELD) {
+        // Pole było jedynym elementem swojego zbioru.
+        set_node_parent(g, field_node(g, index), FIELD_SINGLE_ROOT);
+    }
+    else if (plan->kind == REMOVAL_DETACH) {
+        // Obszar się nie dzieli, więc jego zbiór pozostaje bez zmian.
+        add_field_node(g, index);
+    }
+    else if (plan->kind == REMOVAL_SPLIT) {
+        split_area_after_removal(g, index, &plan->search);
+    }
+    else {
+        rebuild_all_areas(g);
+    }
+    player_t *curr_player = player_for_update(g, player);
+    (curr_player->number_of_areas) += (area_count - 1);
+    (curr_player->number_of_fields)--;
+    if (curr_player->number_of_fields == 0) {
+        (g->players_with_fields)--;
+    }
+    (g->free_fields)++;
+    update_player_adjacent_fields_after_removing(g, player, x, y);
+    update_other_players_adjacent_fields_after_removing(g, player, x, y);
+    if (area_count > 0) {
+        // Jeśli pole nie było jedynym elementem obszaru, teraz
+        // staje się wolnym, sąsiednim polem dla danego gracza.
+        (curr_player->adjacent_fields)++;
+    }
+}
+
+uint64_t gamma_busy_fields(gamma_t *g, uint32_t player) {
+    if (g == NULL || !is_player_parameter_valid(g, player)) {
+        return 0;
+    }
+    else {
+        return g->players[player - 1].number_of_fields;
+    }
+}
+
+uint64_t gamma_free_fields(gamma_t *g, uint32_t player) {
+    if (g == NULL || !is_player_parameter_valid(g, player)) {
+        return 0;
+    }
+    else if (g->players[player - 1].number_of_areas < g->max_areas) {
+        return g->free_fields;
+    }
+    else {
+        return g->players[player - 1].adjacent_fields;
+    }
+}
+
+/** @brief Przechodzi pola danego gracza w obrębie jednej składowej.
+ * Przechodzi wszystkie pola danego gracza, które
+ * po złotym ruchu należałyby do jednej składowej
+ * oraz łączą się z polem o indeksie @p index.
+ * Uwaga - nie resetuje mapy odwiedzonych pól w strukturze @p g.
+ * @param[in, out] g        – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index         – indeks pola.
+ */
+static void traverse_player_fields(gamma_t *g, uint32_t index) {
+    field_queue *queue = g->queue;
+    field_queue_push(queue, index);
+    mark_field_visited(g, index);
+
+    while (!field_queue_is_empty(queue)) {
+        uint32_t curr_field = field_queue_pop(queue);
+        add_adjacent_fields_to_queue(queue, g, curr_field);
+    }
+}
+
+/** @brief Sprawdza, czy gracz może wykonać złoty ruch na dane pole.
+ * Sprawdza, czy gracz o indekse @p player może wykonać
+ * złoty ruch na pole o współrzędnych (@p x, @p y)
+ * bez zwiększania liczby swoich obszarów.
+ * @param[in, out] g        – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] owner_index   – indeks gracza, liczba dodatnia
+ *                          i niewiększa od składowej @p players
+ *                          ze zmiennej @p g,
+ * @param[in] x             – numer kolumny, mniejszy od składowej
+ *                          @p board_width ze zmiennej @p g,
+ * @param[in] y             – numer wiersza, mniejszy od składowej
+ *                          @p board_height ze zmiennej @p g.
+ * @return Wartość @p true, jeśli gracz może wykonać złoty ruch
+ * lub @p false w przeciwnym wypadku.
+ */
+static uint32_t areas_left_after_golden_move(gamma_t *g, uint32_t owner_index,
+                                             uint32_t x, uint32_t y) {
+    uint32_t areas = 0;
+    uint32_t index = field_index(g, x, y);
+    mark_field_visited(g, index);
+
+    uint32_t adjacent[SPLIT_SEARCHES_COUNT];
+    uint32_t adjacent_count = adjacent_field_indices(g, index, adjacent);
+    for (uint32_t i = 0; i < adjacent_count; i++) {
+        if (should_field_be_visited(g, adjacent[i], owner_index)) {
+            areas++;
+            traverse_player_fields(g, adjacent[i]);
+        }
+    }
+
+    return areas;
+}
+
+/** @brief Sprawdza, czy złoty ruch gracza na dane pole byłby legalny.
+ * Sprawdza, czy można wykonać legalny złoty ruch
+ * na pole o współrzędnych (@p x, @p y), nie zmieniając stanu gry.
+ * Przechodzi jedynie mniejsze z obszarów, na które rozpadłby się
+ * obszar właściciela pola.
+ * Funkcja zakłada, że pole należy do jakiegoś gracza.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] x          – numer kolumny, mniejszy od składowej
+ *                         @p board_width ze zmiennej @p g,
+ * @param[in] y          – numer wiersza, mniejszy od składowej
+ *                         @p board_height ze zmiennej @p g.
+ * @return Wartość @p true, jeśli gracz może wykonać złoty ruch
+ * lub @p false w przeciwnym wypadku.
+ */
+static bool would_golden_move_be_legal(gamma_t *g, uint32_t x, uint32_t y) {
+    uint32_t owner_index = get_field(g, x, y)->owner_index;
+    uint32_t owner_areas = g->players[owner_index - 1].number_of_areas;
+    // Usunięcie pola zwiększa liczbę obszarów właściciela co najwyżej o 3.
+    if (g->max_areas - owner_areas >= 3 || is_removal_resolved_locally(g, x, y)) {
+        return true;
+    }
+
+    uint32_t areas;
+    if (allocate_split_queues(g)) {
+        split_search search;
+        areas = explore_areas_after_removal(g, owner_index, x, y, &search);
+    }
+    else {
+        areas = areas_left_after_golden_move(g, owner_index, x, y);
+        reset_visited_map(g);
+    }
+    return (areas == 0 || owner_areas + areas - 1 <= g->max_areas);
+}
+
+/** @brief Przygotowuje usunięcie pionka z pola.
+ * Wyznacza, jak zmienią się zbiory find and union obszaru gracza @p player
+ * po usunięciu jego pionka z pola (@p x, @p y), i przygotowuje całą pamięć
+ * potrzebną do tej zmiany oraz do postawienia na tym polu pionka gracza
+ * @p mover, więc po powodzeniu złoty ruch nie alokuje już pamięci.
+ * Jeśli zabraknie miejsca na nowe węzły, planuje odbudowę zbiorów
+ * wszystkich obszarów, która pisze jedynie do zaalokowanych kafelków.
+ * Nie zmienia stanu gry. Tablica odwiedzonych pól i kolejka muszą być
+ * zaalokowane.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] player     – indeks właściciela pola,
+ * @param[in] mover      – indeks gracza wykonującego złoty ruch,
+ * @param[in] x          – numer kolumny, mniejszy od składowej
+ *                         @p board_width ze zmiennej @p g,
+ * @param[in] y          – numer wiersza, mniejszy od składowej
+ *                         @p board_height ze zmiennej @p g,
+ * @param[out] plan      – wskaźnik na plan usunięcia pionka.
+ * @return Wartość @p true, jeśli pamięć została przygotowana,
+ * lub @p false w przeciwnym wypadku.
+ */
+static bool plan_field_removal(gamma_t *g, uint32_t player, uint32_t mover,
+                               uint32_t x, uint32_t y, removal_plan *plan) {
+    uint64_t needed_nodes = 0;
+    if (!does_player_own_adjacent_fields(g, player, x, y)) {
+        plan->kind = REMOVAL_LAST_FIELD;
+        plan->areas_count = 0;
+    }
+    else if (is_removal_resolved_locally(g, x, y)) {
+        plan->kind = REMOVAL_DETACH;
+        plan->areas_count = 1;
+        needed_nodes = 1;
+    }
+    else if (allocate_split_queues(g)) {
+        plan->kind = REMOVAL_SPLIT;
+        plan->areas_count = explore_areas_after_removal(g, player, x, y,
+                                                        &plan->search);
+        needed_nodes = 1;
+        for (uint32_t i = 0; i < plan->search.searches; i++) {
+            if (split_search_group(&plan->search, i) == i &&
+                i != plan->search.kept) {
+                needed_nodes += plan->search.sizes[i];
+            }
+        }
+    }
+    else {
+        plan->kind = REMOVAL_REBUILD;
+        plan->areas_count = areas_left_after_golden_move(g, player, x, y);
+        reset_visited_map(g);
+    }
+
+    if (needed_nodes > 0 && !has_room_for_field_nodes(g, needed_nodes)) {
+        plan->kind = REMOVAL_REBUILD;
+    }
+    if (plan->kind == REMOVAL_REBUILD) {
+        // Po odbudowie węzły wszystkich zajętych pól leżą
+        // w zaalokowanych kafelkach.
+        return field_board_reserve_allocated(&g->fields);
+    }
+    return reserve_pawn_placement(g, mover, field_index(g, x, y));
+}
+
+bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    if (!are_golden_move_parameters_valid(g, player, x, y) ||
+        (g->players[player - 1].number_of_areas == g->max_areas &&
+         !does_player_own_adjacent_fields(g, player, x, y))) {
+        return false;
+    }
+
+    // Nielegalny złoty ruch nie zmienia stanu gry.
+    if (!allocate_search_arrays(g) || !would_golden_move_be_legal(g, x, y)) {
+        return false;
+    }
+
+    uint32_t target_player = get_field(g, x, y)->owner_index;
+    removal_plan plan;
+    if (!plan_field_removal(g, target_player, player, x, y, &plan)) {
+        return false;
+    }
+
+    begin_journaled_move(g);
+    remove_field_ownership(g, target_player, x, y, &plan);
+    place_pawn(g, player, x, y, !does_player_own_adjacent_fields(g, player, x, y));
+    player_for_update(g, player)->has_golden_move_available = false;
+    end_journaled_move(g);
+    count_move(g, WAL_GOLDEN_MOVE, player, x, y);
+    return true;
+}
+
+bool gamma_undo_enable(gamma_t *g, bool enable) {
+    if (g == NULL) {
+        return false;
+    }
+    else if (!enable) {
+        if (g->undo != NULL) {
+            field_journal_clear(&g->undo->fields);
+            free(g->undo->players);
+            free(g->undo->moves);
+            free(g->undo);
+            g->undo = NULL;
+        }
+        return true;
+    }
+    else if (g->undo != NULL) {
+        return true;
+    }
+
+    undo_log *undo = malloc(sizeof(undo_log));
+    if (undo == NULL) {
+        return false;
+    }
+    if (!field_journal_init(&undo->fields)) {
+        free(undo);
+        return false;
+    }
+    undo->players = NULL;
+    undo->players_count = 0;
+    undo->players_capacity = 0;
+    undo->moves = NULL;
+    undo->moves_count = 0;
+    undo->moves_capacity = 0;
+    undo->has_failed = false;
+    g->undo = undo;
+    return true;
+}
+
+bool gamma_undo(gamma_t *g) {
+    if (g == NULL || g->undo == NULL || g->undo->moves_count == 0 ||
+        g->wal != NULL) {
+        return false;
+    }
+
+    undo_log *undo = g->undo;
+    move_record *record = &undo->moves[undo->moves_count - 1];
+    // Kafelki są przygotowywane przed cofnięciem pierwszej zmiany,
+    // więc brak pamięci nie przerywa cofania ruchu w połowie.
+    for (uint64_t i = record->field_changes;
+         i < field_journal_size(undo->fields); i++) {
+        field_change change = field_journal_get(undo->fields, i);
+        if (change.kind != FIELD_NODE_CHANGE &&
+            !field_board_reserve(&g->fields, change.index, 1)) {
+            return false;
+        }
+    }
+    (undo->moves_count)--;
+
+    while (field_journal_size(undo->fields) > record->field_changes) {
+        field_change change = field_journal_pop(undo->fields);
+        if (change.kind == FIELD_PARENT_CHANGE) {
+            field_for_write(g, change.index)->parent = change.old_value;
+        }
+        else if (change.kind == FIELD_OWNER_CHANGE) {
+            gamma_field *field = field_for_write(g, change.index);
+            uint32_t owner = field->owner_index;
+            field->owner_index = change.old_value;
+            update_area_starts(g, change.index, owner, change.old_value);
+            uint32_t x, y;
+            field_coordinates(g, change.index, &x, &y);
+            update_rendered_board(g, x, y, change.old_value);
+        }
+        else {
+            // Mapa węzłów wraca do stanu, który już kiedyś mieściła,
+            // więc nie musi być powiększana.
+            assign_field_node(g, change.index, change.old_value);
+        }
+    }
+
+    while (undo->players_count > record->player_changes) {
+        (undo->players_count)--;
+        player_change *change = &undo->players[undo->players_count];
+        g->players[change->index - 1] = change->player;
+    }
+
+    g->free_fields = record->free_fields;
+    if (!is_board_sparse(g)) {
+        // Indeksy pól rzadkiej planszy pozostają przypisane do komórek,
+        // więc nie mogą zostać ponownie wykorzystane.
+        g->nodes_count = record->nodes_count;
+    }
+    g->players_with_fields = record->players_with_fields;
+    (g->applied_moves)--;
+    return true;
+}
+
+/** @brief Alokuje pamięć potrzebną do przeszukiwania obszarów w głąb.
+ * Jeśli składowe @p dfs_fields i @p dfs_stack nie zostały jeszcze
+ * zaalokowane, alokuje je. W przypadku niepowodzenia obie mają wartość NULL.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry.
+ * @return Wartość @p true jeśli pamięć jest dostępna
+ * lub @p false w przeciwnym wypadku.
+ */
+static bool allocate_dfs_arrays(gamma_t *g) {
+    if (g->dfs_fields == NULL) {
+        uint64_t count = indices_count(g);
+        g->dfs_fields = malloc(count * sizeof(dfs_field));
+        g->dfs_stack = malloc(count * sizeof(uint32_t));
+        if (g->dfs_fields == NULL || g->dfs_stack == NULL) {
+            free(g->dfs_fields);
+            free(g->dfs_stack);
+            g->dfs_fields = NULL;
+            g->dfs_stack = NULL;
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Rozpoczyna przeszukiwanie w głąb od danego pola.
+ * Oznacza pole jako odwiedzone, nadaje mu kolejny numer
+ * i umieszcza je na stosie.
+ * @param[in,out] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index          – indeks pola,
+ * @param[in,out] order      – liczba dotychczas odwiedzonych pól obszaru,
+ * @param[in,out] stack_size – liczba elementów na stosie.
+ */
+static inline void dfs_enter_field(gamma_t *g, uint32_t index, uint32_t *order,
+                                   uint64_t *stack_size) {
+    mark_field_visited(g, index);
+    (*order)++;
+    g->dfs_fields[index].order = *order;
+    g->dfs_fields[index].low = *order;
+    g->dfs_fields[index].next_direction = 0;
+    g->dfs_fields[index].areas_after_removal = 0;
+    g->dfs_stack[*stack_size] = index;
+    (*stack_size)++;
+}
+
+/** @brief Wylicza, na ile obszarów rozpadłby się obszar po usunięciu każdego pola.
+ * Przeszukuje w głąb obszar zawierający pole o indeksie @p root,
+ * wyznaczając punkty artykulacji algorytmem Tarjana. Dla każdego pola obszaru
+ * zapisuje w składowej @p areas_after_removal liczbę obszarów,
+ * na które rozpadną się należące do właściciela pola sąsiednie do niego
+ * po jego usunięciu. Odwiedzone pola zostają oznaczone na mapie odwiedzonych
+ * pól, której funkcja nie resetuje. Działa w czasie liniowym względem
+ * wielkości obszaru.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] root       – indeks nieodwiedzonego pola należącego do gracza.
+ */
+static void compute_areas_after_removal(gamma_t *g, uint32_t root) {
+    uint32_t owner = field_at(g, root)->owner_index;
+    uint32_t order = 0;
+    uint64_t stack_size = 0;
+    dfs_enter_field(g, root, &order, &stack_size);
+
+    while (stack_size > 0) {
+        uint32_t curr = g->dfs_stack[stack_size - 1];
+        dfs_field *curr_dfs = &g->dfs_fields[curr];
+        if (curr_dfs->next_direction < RING_SIZE) {
+            uint32_t next_x, next_y;
+            field_coordinates(g, curr, &next_x, &next_y);
+            next_x += RING_DX[curr_dfs->next_direction];
+            next_y += RING_DY[curr_dfs->next_direction];
+            curr_dfs->next_direction += 2;
+            if (next_x >= g->board_width || next_y >= g->board_height) {
+                continue;
+            }
+
+            uint32_t next = field_index(g, next_x, next_y);
+            if (next == FIELD_MAP_ABSENT || field_at(g, next)->owner_index != owner) {
+                continue;
+            }
+            else if (!is_field_visited(g, next)) {
+                dfs_enter_field(g, next, &order, &stack_size);
+            }
+            else if (g->dfs_fields[next].order < curr_dfs->low) {
+                curr_dfs->low = g->dfs_fields[next].order;
+            }
+        }
+        else {
+            stack_size--;
+            if (stack_size > 0) {
+                dfs_field *parent = &g->dfs_fields[g->dfs_stack[stack_size - 1]];
+                if (curr_dfs->low < parent->low) {
+                    parent->low = curr_dfs->low;
+                }
+                // Poddrzewo, z którego nie da się dojść powyżej rodzica,
+                // po usunięciu rodzica staje się osobnym obszarem.
+                if (curr_dfs->low >= parent->order) {
+                    (parent->areas_after_removal)++;
+                }
+            }
+            if (curr != root) {
+                // Pozostała część obszaru, zawierająca rodzica pola.
+                (curr_dfs->areas_after_removal)++;
+            }
+        }
+    }
+}
+
+/** @brief Sprawdza, czy gracz może wykonać złoty ruch na dane pole.
+ * Sprawdza, czy pole (@p x, @p y) należy do innego gracza, czy gracz
+ * @p player może je zająć bez przekroczenia limitu obszarów oraz czy
+ * właściciel pola po jego utracie nie przekroczy limitu obszarów.
+ * Nie sprawdza, czy gracz ma dostępny złoty ruch.
+ * Jeśli dostępna jest pamięć na przeszukiwanie w głąb, obszary wylicza
+ * funkcja @ref compute_areas_after_removal raz dla całego obszaru, a kolejne
+ * wywołania korzystają z zapisanych wyników. Dlatego przed serią wywołań
+ * mapa odwiedzonych pól nie może zawierać odwiedzonych pól, a po niej należy
+ * ją zresetować.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] player     – indeks gracza, liczba dodatnia
+ *                         i niewiększa od składowej @p players
+ *                         ze zmiennej @p g,
+ * @param[in] x          – numer kolumny, mniejszy od składowej
+ *                         @p board_width ze zmiennej @p g,
+ * @param[in] y          – numer wiersza, mniejszy od składowej
+ *                         @p board_height ze zmiennej @p g.
+ * @return Wartość @p true, jeśli gracz może wykonać złoty ruch na to pole
+ * lub @p false w przeciwnym wypadku.
+ */
+static bool is_golden_move_target(gamma_t *g, uint32_t player,
+                                  uint32_t x, uint32_t y) {
+    const gamma_field *field = get_field(g, x, y);
+    if (!does_field_belong_to_other_player(field, player) ||
+        (g->players[player - 1].number_of_areas == g->max_areas &&
+         !does_player_own_adjacent_fields(g, player, x, y))) {
+        return false;
+    }
+
+    // Usunięcie pola zwiększa liczbę obszarów właściciela co najwyżej o 3.
+    uint32_t owner_areas = g->players[field->owner_index - 1].number_of_areas;
+    if (g->dfs_fields == NULL) {
+        return would_golden_move_be_legal(g, x, y);
+    }
+    else if (g->max_areas - owner_areas >= 3 || is_removal_resolved_locally(g, x, y)) {
+        return true;
+    }
+
+    uint32_t index = field_index(g, x, y);
+    if (!is_field_visited(g, index)) {
+        compute_areas_after_removal(g, index);
+    }
+    return (owner_areas - 1 + g->dfs_fields[index].areas_after_removal
+            <= g->max_areas);
+}
+
+/** @brief Wyszukuje pola, na które gracz może wykonać złoty ruch.
+ * Przegląda pola planszy, zatrzymując się po znalezieniu @p limit pól,
+ * na które gracz o indeksie @p player może wykonać złoty ruch. W gęstej
+ * planszy pola są przeglądane wierszami, a w rzadkiej jedynie zajęte pola
+ * w kolejności ich pierwszego zajęcia, bo tylko one mogą być celem.
+ * Obowiązują te same wymagania co do mapy odwiedzonych pól co w funkcji
+ * @ref is_golden_move_target.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] player     – indeks gracza, liczba dodatnia
+ *                         i niewiększa od składowej @p players
+ *                         ze zmiennej @p g,
+ * @param[out] targets   – tablica na co najmniej @p limit par
+ *                         współrzędnych znalezionych pól lub NULL,
+ * @param[in] limit      – największa liczba pól do znalezienia.
+ * @return Liczba znalezionych pól.
+ */
+static uint64_t find_golden_targets(gamma_t *g, uint32_t player,
+                                    uint32_t *targets, uint64_t limit) {
+    uint64_t found = 0;
+    if (is_board_sparse(g)) {
+        for (uint64_t i = 0; i < g->nodes_count && found < limit; i++) {
+            if (g->field_cells[i] == NO_FIELD_CELL) {
+                continue;
+            }
+
+            uint32_t x, y;
+            field_coordinates(g, i, &x, &y);
+            if (is_golden_move_target(g, player, x, y)) {
+                if (targets != NULL) {
+                    targets[2 * found] = x;
+                    targets[2 * found + 1] = y;
+                }
+                found++;
+            }
+        }
+        return found;
+    }
+
+    for(uint32_t j = 0; j < g->board_height && found < limit; j++) {
+        for(uint32_t i = 0; i < g->board_width && found < limit; i++) {
+            if (is_golden_move_target(g, player, i, j)) {
+                if (targets != NULL) {
+                    targets[2 * found] = i;
+                    targets[2 * found + 1] = j;
+                }
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+/** @brief Porównuje pary współrzędnych wierszami.
+ * @param[in] a   – wskaźnik na parę współrzędnych (x, y),
+ * @param[in] b   – wskaźnik na parę współrzędnych (x, y).
+ * @return Liczba ujemna, zero lub dodatnia, jeśli pole @p a leży
+ * odpowiednio przed, w tym samym miejscu lub za polem @p b.
+ */
+static int compare_coordinates(const void *a, const void *b) {
+    const uint32_t *first = a, *second = b;
+    if (first[1] != second[1]) {
+        return first[1] < second[1] ? -1 : 1;
+    }
+    return (first[0] > second[0]) - (first[0] < second[0]);
+}
+
+/** @brief Szuka celu złotego ruchu wokół jednego obszaru gracza.
+ * Przechodzi algorytmem BFS obszar gracza @p player, do którego należy pole
+ * o indeksie @p start, i dopóki @p found ma wartość @p false, sprawdza
+ * funkcją @ref is_golden_move_target sąsiadujące z nim pola innych graczy.
+ * Pola obszaru są oznaczane jako odwiedzone, co nie wpływa na wyniki
+ * funkcji @ref is_golden_move_target, bo przeszukuje ona jedynie obszary
+ * innych graczy. Obowiązują te same wymagania co do mapy odwiedzonych pól
+ * co w tej funkcji.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] player     – indeks gracza, liczba dodatnia
+ *                         i niewiększa od składowej @p players
+ *                         ze zmiennej @p g,
+ * @param[in] start      – indeks nieodwiedzonego pola gracza,
+ * @param[in] found      – czy cel złotego ruchu został już znaleziony.
+ * @return Wartość @p true, jeśli @p found ma wartość @p true lub znaleziono
+ * cel złotego ruchu, lub @p false w przeciwnym wypadku.
+ */
+static bool find_golden_target_around_area(gamma_t *g, uint32_t player,
+                                           uint32_t start, bool found) {
+    field_queue *queue = g->queue;
+    field_queue_push(queue, start);
+    mark_field_visited(g, start);
+
+    while (!field_queue_is_empty(queue)) {
+        uint32_t curr_field = field_queue_pop(queue);
+        uint32_t adjacent[4];
+        uint32_t adjacent_count = adjacent_field_indices(g, curr_field, adjacent);
+        for (uint32_t i = 0; i < adjacent_count; i++) {
+            uint32_t owner = field_at(g, adjacent[i])->owner_index;
+            if (owner == player) {
+                visit_field(queue, g, adjacent[i], player);
+            }
+            else if (!found && owner != DEFAULT_PLAYER_NUMBER) {
+                uint32_t x, y;
+                field_coordinates(g, adjacent[i], &x, &y);
+                found = is_golden_move_target(g, player, x, y);
+            }
+        }
+    }
+    return found;
+}
+
+/** @brief Szuka celu złotego ruchu wokół obszarów gracza.
+ * Przechodzi obszary gracza @p player, zaczynając od pól zapamiętanych
+ * w składowej @p area_starts, a jeśli nie są one znane, od pól gracza
+ * znalezionych przeglądając planszę, i sprawdza jedynie pola innych graczy
+ * sąsiadujące z tymi obszarami, bo gracz ma @p max_areas obszarów. Po
+ * przejściu wszystkich obszarów zapamiętuje po jednym polu każdego z nich,
+ * więc kolejne wywołania działają w czasie liniowym względem liczby pól
+ * gracza i przeszukanych obszarów innych graczy.
+ * Obowiązują te same wymagania co do mapy odwiedzonych pól co w funkcji
+ * @ref is_golden_move_target.
+ * @param[in, out] g     – wskaźnik na strukturę przechowującą dane gry,
+ *                         ze składową @p area_starts różną od NULL,
+ * @param[in] player     – indeks gracza, liczba dodatnia
+ *                         i niewiększa od składowej @p players
+ *                         ze zmiennej @p g.
+ * @return Wartość @p true, jeśli gracz może wykonać złoty ruch
+ * lub @p false w przeciwnym wypadku.
+ */
+static bool find_golden_target_around_areas(gamma_t *g, uint32_t player) {
+    area_starts *starts = &g->area_starts[player - 1];
+    uint32_t areas = g->players[player - 1].number_of_areas;
+    bool is_known = starts->fields != NULL;
+    uint64_t count = is_known ? starts->count :
+                     is_board_sparse(g) ? g->nodes_count : fields_count(g);
+    uint32_t *found_starts = malloc(areas * sizeof(uint32_t));
+    uint32_t found_areas = 0;
+    bool found = false;
+
+    // Po znalezieniu celu obszary są przechodzone dalej jedynie po to,
+    // by zapamiętać ich pola.
+    for (uint64_t i = 0; i < count && found_areas < areas &&
+                         (!found || found_starts != NULL); i++) {
+        uint32_t index = is_known ? starts->fields[i] : (uint32_t) i;
+        if ((!is_known && is_board_sparse(g) &&
+             g->field_cells[index] == NO_FIELD_CELL) ||
+            !should_field_be_visited(g, index, player)) {
+            continue;
+        }
+        if (found_starts != NULL) {
+            found_starts[found_areas] = index;
+        }
+        found_areas++;
+        found = find_golden_target_around_area(g, player, index, found);
+    }
+
+    if (found_starts != NULL && found_areas == areas) {
+        forget_area_starts(starts);
+        starts->fields = found_starts;
+        starts->count = areas;
+        starts->capacity = areas;
+    }
+    else {
+        free(found_starts);
+    }
+    return found;
+}
+
+/** @brief Sprawdza, czy istnieje pole, na które gracz może wykonać złoty ruch.
+ * Sprawdza, czy istnieje pole innego gracza niż ten o indeksie @p player,
+ * na które dany gracz może wykonać złoty ruch bez zwiększenia liczby
+ * swoich obszarów oraz nie sprawiając, że inny gracz po takim ruchu
+ * będzie miał za dużą liczbę obszarów. Gracz musi mieć @p max_areas
+ * obszarów, więc sprawdzane są jedynie pola sąsiadujące z jego obszarami,
+ * patrz @ref find_golden_target_around_areas. Jeśli brakuje pamięci
+ * na pola obszarów lub przeszukiwanie w głąb, przegląda całą planszę.
+ * Każdy obszar zostaje przeszukany co najwyżej raz.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new.
+ * @return Wartość @p true, jeśli takie pole istnieje
+ * lub @p false w przeciwnym wypadku.
+ */
+static bool can_player_use_golden_move(gamma_t *g, uint32_t player) {
+    if (!allocate_search_arrays(g)) {
+        errno = ENOMEM;
+        return false;
+    }
+
+    if (g->area_starts == NULL) {
+        g->area_starts = calloc(g->players_count, sizeof(area_starts));
+    }
+    bool result;
+    if (allocate_dfs_arrays(g) && g->area_starts != NULL) {
+        result = find_golden_target_around_areas(g, player);
+    }
+    else {
+        result = find_golden_targets(g, player, NULL, 1) > 0;
+    }
+
+    reset_visited_map(g);
+    return result;
+}
+
+bool gamma_golden_possible(gamma_t *g, uint32_t player) {
+    if (g == NULL || !is_player_parameter_valid(g, player) ||
+        !g->players[player - 1].has_golden_move_available) {
+        return false;
+    }
+
+    player_t *curr_player = &g->players[player - 1];
+    if(curr_player->number_of_areas == g->max_areas) {
+        // Zajęcie pola, które nie dzieli obszaru właściciela, jest zawsze
+        // legalne, a bez sąsiednich pól innych graczy nie ma żadnego celu.
+        if (curr_player->safe_golden_targets > 0) {
+            return true;
+        }
+        else if (curr_player->golden_targets == 0) {
+            return false;
+        }
+        return can_player_use_golden_move(g, player);
+    }
+    else {
+        // Jeśli gracz może stworzyć nowy obszar, to zawsze
+        // może wykonać złoty ruch na jakieś istniejące pole innego gracza
+        uint32_t other_players_with_fields = g->players_with_fields;
+        if (curr_player->number_of_fields > 0) {
+            other_players_with_fields--;
+        }
+        return other_players_with_fields > 0;
+    }
+}
+
+uint32_t* gamma_golden_targets(gamma_t *g, uint32_t player, uint64_t *count) {
+    *count = 0;
+    if (g == NULL || !is_player_parameter_valid(g, player) ||
+        !g->players[player - 1].has_golden_move_available) {
+        return NULL;
+    }
+
+    if (!allocate_search_arrays(g)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    allocate_dfs_arrays(g);
+    *count = find_golden_targets(g, player, NULL, UINT64_MAX);
+
+    uint32_t *targets = NULL;
+    if (*count > 0) {
+        targets = malloc(2 * *count * sizeof(uint32_t));
+        if (targets == NULL) {
+            *count = 0;
+            errno = ENOMEM;
+        }
+    }
+
+    // Obszary przeszukane w pierwszym przejściu pozostają odwiedzone,
+    // więc drugie przejście korzysta z zapisanych wyników.
+    if (targets != NULL) {
+        find_golden_targets(g, player, targets, *count);
+        if (is_board_sparse(g)) {
+            qsort(targets, *count, 2 * sizeof(uint32_t), compare_coordinates);
+        }
+    }
+
+    reset_visited_map(g);
+    return targets;
+}
+
+/** @brief Tworzy opis planszy.
+ * Alokuje pamięć i wypełnia ją opisem całej planszy.
+ * @param[in] g      – wskaźnik na strukturę przechowującą dane gry.
+ * @return Wskaźnik na opis planszy lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+static char *render_board(gamma_t *g) {
+    uint64_t array_size = how_many_characters_will_map_have(g);
+    char *map_string = NULL;
+    if (array_size > 0 && array_size <= SIZE_MAX) {
+        map_string = malloc(array_size * sizeof(char));
+    }
+    if (map_string == NULL) {
+        return NULL;
+    }
+
+    uint64_t curr_index = 0;
+    uint32_t field_width = rendered_field_width(g);
+    const char *tokens = owner_tokens(g);
+    for (uint32_t y = g->board_height; y > 0; y--) {
+        for (uint32_t x = 0; x < g->board_width; x++) {
+            render_field(map_string, curr_index,
+                         get_field(g, x, y - 1)->owner_index, field_width,
+                         tokens);
+            curr_index += field_width;
+        }
+        map_string[curr_index] = '\n';
+        curr_index++;
+    }
+    map_string[curr_index] = '\0';
+
+    return map_string;
+}
+
+const char* gamma_board_view(gamma_t *g) {
+    if (g == NULL) {
+        return NULL;
+    }
+    else if (g->rendered_board == NULL) {
+        g->rendered_board = render_board(g);
+    }
+    return g->rendered_board;
+}
+
+char* gamma_board(gamma_t *g) {
+    const char *view = gamma_board_view(g);
+    if (view == NULL) {
+        return NULL;
+    }
+
+    uint64_t size = how_many_characters_will_map_have(g);
+    char *map_string = malloc(size * sizeof(char));
+    if (map_string != NULL) {
+        memcpy(map_string, view, size);
+    }
+    return map_string;
+}
+
+bool gamma_board_write(gamma_t *g, int fd) {
+    if (g == NULL || fd < 0) {
+        return false;
+    }
+    else if (g->rendered_board != NULL) {
+        uint64_t size = how_many_characters_will_map_have(g);
+        return write_all(fd, g->rendered_board, size - 1);
+    }
+
+    char chunk[BOARD_WRITE_CHUNK];
+    uint64_t used = 0;
+    uint32_t field_width = rendered_field_width(g);
+    const char *tokens = owner_tokens(g);
+    for (uint32_t y = g->board_height; y > 0; y--) {
+        for (uint32_t x = 0; x < g->board_width; x++) {
+            if (used + field_width > BOARD_WRITE_CHUNK) {
+                if (!write_all(fd, chunk, used)) {
+                    return false;
+                }
+                used = 0;
+            }
+            render_field(chunk, used, get_field(g, x, y - 1)->owner_index,
+                         field_width, tokens);
+            used += field_width;
+        }
+        if (used == BOARD_WRITE_CHUNK) {
+            if (!write_all(fd, chunk, used)) {
+                return false;
+            }
+            used = 0;
+        }
+        chunk[used++] = '\n';
+    }
+    return write_all(fd, chunk, used);
+}
+
+void gamma_split_check_stats(gamma_t *g, uint64_t *checks,
+                             uint64_t *resolved_locally) {
+    *checks = (g != NULL) ? g->split_checks : 0;
+    *resolved_locally = (g != NULL) ? g->split_checks_resolved_locally : 0;
+}
+
+inline uint32_t gamma_player_owned_areas(gamma_t *g, uint32_t player) {
+    if(g != NULL) {
+        return (player <= g->players_count)
+               ? g->players[player - 1].number_of_areas
+               : 0;
+    }
+    else {
+        return 0;
+    }
+}
+
+inline uint32_t gamma_max_areas(gamma_t *g) {
+    return (g != NULL) ? g->max_areas : 0;
+}
+
+inline uint64_t gamma_largest_number_of_owned_fields(gamma_t *g) {
+    if(g != NULL) {
+        uint64_t curr_max = 0;
+        for(uint32_t i = 0; i < g->players_count; i++) {
+            uint64_t temp = gamma_busy_fields(g, i + 1);
+            if(temp > curr_max) {
+                curr_max = temp;
+            }
+        }
+
+        return curr_max;
+    }
+    else {
+        return 0;
+    }
+}
+
+/** @brief Podaje liczbę kafelków zawierających wykorzystane węzły.
+ * @param[in] g      – wskaźnik na strukturę przechowującą dane gry.
+ * @return Liczba kafelków, w których leżą węzły o indeksach
+ * mniejszych od @p nodes_count.
+ */
+static inline uint64_t used_tiles_count(const gamma_t *g) {
+    return (g->nodes_count + FIELD_TILE_MASK) >> FIELD_TILE_SHIFT;
+}
+
+/** @brief Podaje rozmiar danych zapisu stanu gry poprzedzających kafelki.
+ * @param[in] header     – wskaźnik na poprawny nagłówek zapisu.
+ * @return Łączny rozmiar nagłówka, graczy, numerów komórek pól,
+ * dodatkowych węzłów pól i indeksów kafelków, bez dopełnienia.
+ */
+static uint64_t snapshot_prefix_size(const snapshot_header *header) {
+    uint64_t size = sizeof(snapshot_header) +
+                    (uint64_t) header->players_count * sizeof(snapshot_player) +
+                    header->field_nodes_count * sizeof(snapshot_node) +
+                    header->tiles_count * sizeof(uint64_t);
+    if (header->is_sparse) {
+        size += header->nodes_count * sizeof(uint64_t);
+    }
+    return size;
+}
+
+/** @brief Podaje położenie obrazów kafelków w zapisie stanu gry.
+ * @param[in] header     – wskaźnik na poprawny nagłówek zapisu.
+ * @return Liczba bajtów zapisu poprzedzających obraz pierwszego kafelka,
+ * podzielna przez @ref SNAPSHOT_TILES_ALIGNMENT, jeśli węzły zajmują
+ * więcej niż jeden kafelek.
+ */
+static inline uint64_t snapshot_tiles_offset(const snapshot_header *header) {
+    if (header->nodes_count <= FIELD_TILE_SIZE) {
+        return snapshot_prefix_size(header);
+    }
+    return (snapshot_prefix_size(header) + SNAPSHOT_TILES_ALIGNMENT - 1) &
+           ~((uint64_t) SNAPSHOT_TILES_ALIGNMENT - 1);
+}
+
+/** @brief Podaje liczbę pól w obrazie kafelka w zapisie stanu gry.
+ * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks kafelka, mniejszy od liczby kafelków
+ *                         zawierających wykorzystane węzły.
+ * @return Liczba pól kafelka o indeksach mniejszych od @p nodes_count.
+ */
+static inline uint32_t snapshot_tile_fields(const gamma_t *g, uint64_t index) {
+    uint64_t first = index << FIELD_TILE_SHIFT;
+    return (g->nodes_count - first < FIELD_TILE_SIZE) ?
+           g->nodes_count - first : FIELD_TILE_SIZE;
+}
+
+/** @brief Podaje rozmiar obrazu kafelka w zapisie stanu gry.
+ * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks kafelka, mniejszy od liczby kafelków
+ *                         zawierających wykorzystane węzły.
+ * @return Rozmiar licznika odwołań i zapisanych pól kafelka w bajtach.
+ */
+static inline uint64_t snapshot_tile_size(const gamma_t *g, uint64_t index) {
+    return sizeof(atomic_uint) + snapshot_tile_fields(g, index) * sizeof(gamma_field);
+}
+
+/** @brief Zapisuje stan graczy.
+ * Zapisuje graczy porcjami po @ref SNAPSHOT_PLAYERS_CHUNK.
+ * @param[in] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] fd     – deskryptor pliku otwartego do zapisu.
+ * @return Wartość @p true, jeśli zapis się powiódł, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool save_players(const gamma_t *g, int fd) {
+    snapshot_player chunk[SNAPSHOT_PLAYERS_CHUNK];
+    for (uint32_t first = 0; first < g->players_count;
+         first += SNAPSHOT_PLAYERS_CHUNK) {
+        uint32_t count = g->players_count - first;
+        if (count > SNAPSHOT_PLAYERS_CHUNK) {
+            count = SNAPSHOT_PLAYERS_CHUNK;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            const player_t *player = &g->players[first + i];
+            chunk[i].number_of_areas = player->number_of_areas;
+            chunk[i].number_of_fields = player->number_of_fields;
+            chunk[i].adjacent_fields = player->adjacent_fields;
+            chunk[i].has_golden_move_available = player->has_golden_move_available;
+            chunk[i].golden_targets = player->golden_targets;
+            chunk[i].safe_golden_targets = player->safe_golden_targets;
+        }
+        if (!write_all(fd, chunk, count * sizeof(snapshot_player))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Zapisuje dodatkowe węzły find and union przypisane polom.
+ * Zapisuje węzły rosnąco według indeksów pól, porcjami
+ * po @ref SNAPSHOT_PLAYERS_CHUNK.
+ * @param[in] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] fd     – deskryptor pliku otwartego do zapisu.
+ * @return Wartość @p true, jeśli zapis się powiódł, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool save_field_nodes(gamma_t *g, int fd) {
+    snapshot_node chunk[SNAPSHOT_PLAYERS_CHUNK];
+    uint32_t count = 0;
+    uint64_t fields = is_board_sparse(g) ? g->nodes_count : fields_count(g);
+    for (uint64_t i = 0; i < fields && field_map_size(g->field_nodes) > 0; i++) {
+        uint32_t node = field_node(g, i);
+        if (node == i) {
+            continue;
+        }
+        chunk[count].field = i;
+        chunk[count].node = node;
+        count++;
+        if (count == SNAPSHOT_PLAYERS_CHUNK) {
+            if (!write_all(fd, chunk, sizeof(chunk))) {
+                return false;
+            }
+            count = 0;
+        }
+    }
+    return write_all(fd, chunk, count * sizeof(snapshot_node));
+}
+
+/** @brief Zapisuje indeksy zaalokowanych kafelków.
+ * Zapisuje indeksy rosnąco, porcjami po @ref SNAPSHOT_PLAYERS_CHUNK.
+ * @param[in] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] fd     – deskryptor pliku otwartego do zapisu.
+ * @return Wartość @p true, jeśli zapis się powiódł, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool save_tile_indices(const gamma_t *g, int fd) {
+    uint64_t chunk[SNAPSHOT_PLAYERS_CHUNK];
+    uint32_t count = 0;
+    uint64_t tiles = used_tiles_count(g);
+    for (uint64_t i = 0; i < tiles; i++) {
+        if (g->fields.tiles[i] == NULL) {
+            continue;
+        }
+        chunk[count++] = i;
+        if (count == SNAPSHOT_PLAYERS_CHUNK) {
+            if (!write_all(fd, chunk, sizeof(chunk))) {
+                return false;
+            }
+            count = 0;
+        }
+    }
+    return write_all(fd, chunk, count * sizeof(uint64_t));
+}
+
+/** @brief Zapisuje obrazy zaalokowanych kafelków.
+ * Licznik odwołań każdego kafelka jest zapisywany jako 1, ponieważ
+ * w odwzorowanej grze kafelek ma jednego właściciela. Po każdym kafelku
+ * wywołuje funkcję @p progress, jeśli jest różna od NULL.
+ * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] fd         – deskryptor pliku otwartego do zapisu,
+ * @param[in] written    – liczba bajtów zapisanych przed kafelkami,
+ * @param[in] total      – rozmiar całego zapisu,
+ * @param[in] progress   – funkcja informująca o postępie zapisu lub NULL,
+ * @param[in] data       – wskaźnik przekazywany funkcji @p progress.
+ * @return Wartość @p true, jeśli zapis się powiódł, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool save_field_tiles(const gamma_t *g, int fd, uint64_t written,
+                             uint64_t total, gamma_progress_t progress,
+                             void *data) {
+    atomic_uint references = 1;
+    uint64_t tiles = used_tiles_count(g);
+    for (uint64_t i = 0; i < tiles; i++) {
+        const field_tile *tile = g->fields.tiles[i];
+        if (tile == NULL) {
+            continue;
+        }
+        else if (!write_all(fd, &references, sizeof(references)) ||
+                 !write_all(fd, tile->fields,
+                            snapshot_tile_fields(g, i) * sizeof(gamma_field))) {
+            return false;
+        }
+        written += snapshot_tile_size(g, i);
+        if (progress != NULL) {
+            progress(written, total, data);
+        }
+    }
+    return true;
+}
+
+bool gamma_save(gamma_t *g, int fd) {
+    return gamma_save_progress(g, fd, NULL, NULL);
+}
+
+bool gamma_save_progress(gamma_t *g, int fd, gamma_progress_t progress,
+                         void *data) {
+    if (g == NULL) {
+        errno = EINVAL;
+        return false;
+    }
+
+    snapshot_header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.board_width = g->board_width;
+    header.board_height = g->board_height;
+    header.players_count = g->players_count;
+    header.max_areas = g->max_areas;
+    header.players_with_fields = g->players_with_fields;
+    header.is_sparse = is_board_sparse(g);
+    header.free_fields = g->free_fields;
+    header.nodes_count = g->nodes_count;
+    header.nodes_capacity = g->nodes_capacity;
+    header.applied_moves = g->applied_moves;
+    header.field_nodes_count = field_map_size(g->field_nodes);
+    uint64_t total = 0;
+    uint64_t tiles = used_tiles_count(g);
+    for (uint64_t i = 0; i < tiles; i++) {
+        if (g->fields.tiles[i] != NULL) {
+            (header.tiles_count)++;
+            total += snapshot_tile_size(g, i);
+        }
+    }
+
+    uint64_t offset = snapshot_tiles_offset(&header);
+    total += offset;
+    static const char zeros[SNAPSHOT_TILES_ALIGNMENT];
+
+    // Niezaalokowane kafelki zawierają jedynie domyślne pola.
+    if (!write_all(fd, &header, sizeof(header)) || !save_players(g, fd) ||
+        (is_board_sparse(g) &&
+         !write_all(fd, g->field_cells, g->nodes_count * sizeof(uint64_t))) ||
+        !save_field_nodes(g, fd) || !save_tile_indices(g, fd) ||
+        !write_all(fd, zeros, offset - snapshot_prefix_size(&header))) {
+        return false;
+    }
+    if (progress != NULL) {
+        progress(offset, total, data);
+    }
+    return save_field_tiles(g, fd, offset, total, progress, data);
+}
+
+/** @brief Sprawdza, czy nagłówek zapisu stanu gry jest poprawny.
+ * @param[in] header     – wskaźnik na nagłówek.
+ * @return Wartość @p true, jeśli nagłówek opisuje poprawny zapis
+ * tej wersji formatu, lub @p false w przeciwnym wypadku.
+ */
+static bool is_snapshot_header_valid(const snapshot_header *header) {
+    uint64_t count = (uint64_t) header->board_width * header->board_height;
+    if (header->magic != SNAPSHOT_MAGIC || header->version != SNAPSHOT_VERSION ||
+        !are_gamma_new_parameters_valid(header->board_width, header->board_height,
+                                        header->players_count, header->max_areas) ||
+        header->players_with_fields > header->players_count ||
+        header->free_fields > count ||
+        header->nodes_count > header->nodes_capacity ||
+        header->nodes_capacity > MAX_FIELDS_COUNT ||
+        header->field_nodes_count > header->nodes_count ||
+        header->tiles_count >
+            (header->nodes_count + FIELD_TILE_MASK) >> FIELD_TILE_SHIFT) {
+        return false;
+    }
+    else if (header->is_sparse == 0) {
+        return (count <= MAX_FIELDS_COUNT &&
+                header->nodes_capacity == dense_nodes_capacity(count) &&
+                header->nodes_count >= count);
+    }
+    return (header->is_sparse == 1 && header->nodes_capacity >= FIELD_TILE_SIZE);
+}
+
+/** @brief Odtwarza mapę pól rzadkiej planszy.
+ * Wstawia do mapy numery komórek z tablicy @p field_cells,
+ * sprawdzając, czy są poprawne i różne.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry
+ *                         z wypełnioną tablicą @p field_cells.
+ * @return Wartość @p true, jeśli odtwarzanie się powiodło, lub @p false
+ * w przeciwnym wypadku, wtedy @p errno opisuje błąd.
+ */
+static bool rebuild_field_map(gamma_t *g) {
+    if (!field_map_init(&g->sparse_fields)) {
+        errno = ENOMEM;
+        return false;
+    }
+
+    uint64_t count = fields_count(g);
+    for (uint64_t i = 0; i < g->nodes_count; i++) {
+        uint64_t cell = g->field_cells[i];
+        if (cell == NO_FIELD_CELL) {
+            continue;
+        }
+        else if (cell >= count ||
+                 field_map_find(g->sparse_fields, cell) != FIELD_MAP_ABSENT) {
+            errno = EINVAL;
+            return false;
+        }
+        else if (!field_map_insert(g->sparse_fields, cell, i)) {
+            errno = ENOMEM;
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Wczytuje numery komórek pól rzadkiej planszy.
+ * Wczytuje tablicę @p field_cells i odtwarza z niej mapę z numerów komórek
+ * w indeksy pól.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry
+ *                         z ustawionymi rozmiarami planszy i tablicy pól,
+ * @param[in] fd         – deskryptor pliku otwartego do odczytu.
+ * @return Wartość @p true, jeśli wczytywanie się powiodło, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool load_field_cells(gamma_t *g, int fd) {
+    g->field_cells = malloc(g->nodes_capacity * sizeof(uint64_t));
+    if (g->field_cells == NULL) {
+        errno = ENOMEM;
+        return false;
+    }
+    return read_all(fd, g->field_cells, g->nodes_count * sizeof(uint64_t)) &&
+           rebuild_field_map(g);
+}
+
+/** @brief Wczytuje dodatkowe węzły find and union przypisane polom.
+ * Sprawdza, czy indeksy pól są rosnące i należą do pól, a indeksy węzłów
+ * mieszczą się w zakresie, i wstawia węzły do mapy węzłów pól.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry
+ *                         z wczytanymi numerami komórek pól,
+ * @param[in] chunk      – bufor na co najmniej @ref SNAPSHOT_PLAYERS_CHUNK
+ *                         węzłów lub wskaźnik na wszystkie zapisane węzły,
+ *                         jeśli @p fd jest ujemny,
+ * @param[in] count      – liczba zapisanych węzłów,
+ * @param[in] fd         – deskryptor pliku otwartego do odczytu
+ *                         lub -1, jeśli węzły są już w pamięci.
+ * @return Wartość @p true, jeśli wczytywanie się powiodło, lub @p false
+ * w przeciwnym wypadku, wtedy @p errno opisuje błąd.
+ */
+static bool load_field_nodes(gamma_t *g, snapshot_node *chunk, uint64_t count,
+                             int fd) {
+    bool is_sparse = is_board_sparse(g);
+    uint64_t fields = is_sparse ? g->nodes_count : fields_count(g);
+    uint64_t previous = 0;
+    for (uint64_t first = 0; first < count; first += SNAPSHOT_PLAYERS_CHUNK) {
+        uint64_t chunk_count = count - first;
+        if (chunk_count > SNAPSHOT_PLAYERS_CHUNK) {
+            chunk_count = SNAPSHOT_PLAYERS_CHUNK;
+        }
+        const snapshot_node *saved = (fd < 0) ? chunk + first : chunk;
+        if (fd >= 0 && !read_all(fd, chunk, chunk_count * sizeof(snapshot_node))) {
+            return false;
+        }
+        for (uint64_t i = 0; i < chunk_count; i++) {
+            uint32_t field = saved[i].field;
+            if (field >= fields || (first + i > 0 && field <= previous) ||
+                (is_sparse && g->field_cells[field] == NO_FIELD_CELL) ||
+                saved[i].node == field || saved[i].node >= g->nodes_count) {
+                errno = EINVAL;
+                return false;
+            }
+            else if (!field_map_insert(g->field_nodes, field, saved[i].node)) {
+                errno = ENOMEM;
+                return false;
+            }
+            previous = field;
         }
     }
+    return true;
+}
 
-    return false;
+/** @brief Sprawdza, czy indeks kafelka z zapisu jest poprawny.
+ * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] index      – indeks kafelka,
+ * @param[in] previous   – poprzedni indeks kafelka z zapisu
+ *                         lub UINT64_MAX dla pierwszego kafelka.
+ * @return Wartość @p true, jeśli kafelek zawiera wykorzystane węzły
+ * i indeksy są rosnące, lub @p false w przeciwnym wypadku.
+ */
+static inline bool is_tile_index_valid(const gamma_t *g, uint64_t index,
+                                       uint64_t previous) {
+    return (index < used_tiles_count(g) &&
+            (previous == UINT64_MAX || index > previous));
 }
 
-bool gamma_golden_possible(gamma_t *g, uint32_t player) {
-    if (g == NULL || !is_player_parameter_valid(g, player) ||
-        !g->players[player - 1].has_golden_move_available) {
-        return false;
+/** @brief Wczytuje indeksy zapisanych kafelków.
+ * Alokuje wyzerowane kafelki o wczytanych indeksach i pomija dopełnienie
+ * poprzedzające obrazy kafelków.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry
+ *                         z zaalokowaną tablicą pól,
+ * @param[in] header     – wskaźnik na poprawny nagłówek zapisu,
+ * @param[in] fd         – deskryptor pliku otwartego do odczytu.
+ * @return Wartość @p true, jeśli wczytywanie się powiodło, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool load_tile_indices(gamma_t *g, const snapshot_header *header, int fd) {
+    uint64_t chunk[SNAPSHOT_PLAYERS_CHUNK];
+    uint64_t previous = UINT64_MAX;
+    for (uint64_t first = 0; first < header->tiles_count;
+         first += SNAPSHOT_PLAYERS_CHUNK) {
+        uint64_t count = header->tiles_count - first;
+        if (count > SNAPSHOT_PLAYERS_CHUNK) {
+            count = SNAPSHOT_PLAYERS_CHUNK;
+        }
+        if (!read_all(fd, chunk, count * sizeof(uint64_t))) {
+            return false;
+        }
+        for (uint64_t i = 0; i < count; i++) {
+            if (!is_tile_index_valid(g, chunk[i], previous)) {
+                errno = EINVAL;
+                return false;
+            }
+            else if (!field_board_reserve(&g->fields,
+                                          chunk[i] << FIELD_TILE_SHIFT, 1)) {
+                errno = ENOMEM;
+                return false;
+            }
+            previous = chunk[i];
+        }
     }
 
-    if(g->players[player - 1].number_of_areas == g->max_areas) {
-        return can_player_use_golden_move(g, player);
+    char padding[SNAPSHOT_TILES_ALIGNMENT];
+    return read_all(fd, padding,
+                    snapshot_tiles_offset(header) - snapshot_prefix_size(header));
+}
+
+/** @brief Sprawdza pola z obrazu kafelka.
+ * Sprawdza jedynie, czy indeksy graczy i rodziców węzłów mieszczą się
+ * w zakresie, przeglądając pola po kolei.
+ * @param[in] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] fields     – wskaźnik na pola kafelka,
+ * @param[in] count      – liczba pól.
+ * @return Wartość @p true, jeśli pola są poprawne, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool are_tile_fields_valid(const gamma_t *g, const gamma_field *fields,
+                                  uint32_t count) {
+    for (uint32_t j = 0; j < count; j++) {
+        if (fields[j].owner_index > g->players_count ||
+            (!is_field_root(&fields[j]) &&
+             (fields[j].parent & ~FIELD_PARENT_FLAG) >= g->nodes_capacity)) {
+            return false;
+        }
     }
-    else {
-        // Jeśli gracz może stworzyć nowy obszar, to zawsze
-        // może wykonać złoty ruch na jakieś istniejące pole innego gracza
-        for (uint32_t i = 0; i < g->players_count; i++) {
-            if (i != player - 1 && g->players[i].number_of_fields != 0) {
-                return true;
-            }
+    return true;
+}
+
+/** @brief Wczytuje obrazy zapisanych kafelków tablicy pól.
+ * Wczytuje pola bezpośrednio do kafelków zaalokowanych przez funkcję
+ * @ref load_tile_indices i sprawdza je funkcją @ref are_tile_fields_valid.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry
+ *                         z zaalokowanymi kafelkami,
+ * @param[in] fd         – deskryptor pliku otwartego do odczytu.
+ * @return Wartość @p true, jeśli wczytywanie się powiodło, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool load_field_tiles(gamma_t *g, int fd) {
+    uint64_t tiles = used_tiles_count(g);
+    for (uint64_t i = 0; i < tiles; i++) {
+        if (g->fields.tiles[i] == NULL) {
+            continue;
+        }
+
+        atomic_uint references;
+        gamma_field *fields = g->fields.tiles[i]->fields;
+        uint32_t count = snapshot_tile_fields(g, i);
+        if (!read_all(fd, &references, sizeof(references)) ||
+            !read_all(fd, fields, count * sizeof(gamma_field))) {
+            return false;
+        }
+        if (!are_tile_fields_valid(g, fields, count)) {
+            errno = EINVAL;
+            return false;
         }
     }
+    return true;
+}
 
-    return false;
+/** @brief Wczytuje stan graczy.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry
+ *                         z ustawioną liczbą graczy,
+ * @param[in] chunk      – bufor na co najmniej @ref SNAPSHOT_PLAYERS_CHUNK
+ *                         graczy lub wskaźnik na wszystkich zapisanych
+ *                         graczy, jeśli @p fd jest ujemny,
+ * @param[in] fd         – deskryptor pliku otwartego do odczytu
+ *                         lub -1, jeśli gracze są już w pamięci.
+ * @return Wartość @p true, jeśli wczytywanie się powiodło, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool load_players(gamma_t *g, snapshot_player *chunk, int fd) {
+    if (!allocate_players(g, g->players_count)) {
+        errno = ENOMEM;
+        return false;
+    }
+
+    for (uint32_t first = 0; first < g->players_count;
+         first += SNAPSHOT_PLAYERS_CHUNK) {
+        uint32_t count = g->players_count - first;
+        if (count > SNAPSHOT_PLAYERS_CHUNK) {
+            count = SNAPSHOT_PLAYERS_CHUNK;
+        }
+        const snapshot_player *saved = (fd < 0) ? chunk + first : chunk;
+        if (fd >= 0 && !read_all(fd, chunk, count * sizeof(snapshot_player))) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            if (saved[i].number_of_areas > g->max_areas ||
+                saved[i].has_golden_move_available > 1) {
+                errno = EINVAL;
+                return false;
+            }
+            player_t *player = &g->players[first + i];
+            player->number_of_areas = saved[i].number_of_areas;
+            player->number_of_fields = saved[i].number_of_fields;
+            player->adjacent_fields = saved[i].adjacent_fields;
+            player->has_golden_move_available = saved[i].has_golden_move_available;
+            player->golden_targets = saved[i].golden_targets;
+            player->safe_golden_targets = saved[i].safe_golden_targets;
+        }
+    }
+    return true;
 }
 
-/** @brief Zamienia cyfrę na odpowiadający jej znak typu char.
- * Do kodu znaku '0' zostaje dodana liczba odpowiadająca cyfrze @p digit.
- * @param[in] digit   – cyfra
- * @return Znak odpowiadający cyfrze @p digit.
+/** @brief Tworzy strukturę gry opisaną nagłówkiem zapisu.
+ * Ustawia parametry gry i alokuje pustą tablicę pól.
+ * @param[in] header     – wskaźnik na poprawny nagłówek zapisu.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci, wtedy @p errno ma wartość ENOMEM.
  */
-static inline char digit_to_char(uint32_t digit) {
-    return (char) (digit + (uint32_t) '0');
+static gamma_t *snapshot_game_new(const snapshot_header *header) {
+    gamma_t *g = calloc(1, sizeof(gamma_t));
+    if (g == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    g->board_width = header->board_width;
+    g->board_height = header->board_height;
+    g->players_count = header->players_count;
+    g->max_areas = header->max_areas;
+    g->players_with_fields = header->players_with_fields;
+    g->free_fields = header->free_fields;
+    g->nodes_count = header->nodes_count;
+    g->nodes_capacity = header->nodes_capacity;
+    g->applied_moves = header->applied_moves;
+
+    if (!field_map_init(&g->field_nodes) ||
+        !field_board_init(&g->fields, g->nodes_capacity)) {
+        gamma_delete(g);
+        errno = ENOMEM;
+        return NULL;
+    }
+    return g;
 }
 
-/** @brief Umieszcza na planszy do wypisania liczbę.
- * Zamienia liczbę @p number na ciąg znaków i umieszcza
- * ją w tablicy znaków @p s. Zostawia jedno wolne miejsce " " po liczbie.
- * @param[in,out] s         – tablica znaków symbolizująca planszę,
- * @param[in] number        – liczba, która ma zostać wypisana na planszę,
- * @param[in, out] length   – aktualna długość tablicy @p s,
- * @param[in] player_width  –
+/** @brief Kończy tworzenie gry ze stanu zapisu.
+ * Alokuje struktury pomocnicze przeszukiwań lub, jeśli wczytywanie
+ * się nie powiodło, usuwa grę, zachowując wartość @p errno.
+ * @param[in,out] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] is_loaded      – czy wczytywanie stanu gry się powiodło.
+ * @return Wskaźnik @p g lub NULL, jeśli wczytywanie się nie powiodło.
  */
-static void number_to_char(char *s, uint32_t number, uint64_t *length,
-                                                uint32_t player_width) {
-    uint32_t digits = (uint32_t) log10(number) + 1;
-    uint32_t divider = pow(10, digits - 1);
-    uint32_t i;
-    for (i = 0; i < digits; i++) {
-        s[*length] = digit_to_char(number / divider);
-        number = number % divider;
-        divider /= 10;
-        (*length)++;
+static gamma_t *finish_snapshot_game(gamma_t *g, bool is_loaded) {
+    if (is_loaded && (!allocate_visited_map(g) ||
+                      !field_queue_init(&g->queue, indices_count(g)))) {
+        errno = ENOMEM;
+        is_loaded = false;
     }
-    while(i < player_width) {
-        s[*length] = ' ';
-        i++;
-        (*length)++;
+
+    if (!is_loaded) {
+        int error = errno;
+        gamma_delete(g);
+        errno = error;
+        return NULL;
     }
+    return g;
 }
 
-/** @brief Oblicza rozmiar tablicy znaków do wypisania.
- * Oblicza rozmiar tablicy znaków opisującej planszę @p g,
- * biorąc pod uwagę wielocyfrowe indeksy graczy,
- * znaki końca linii oraz znak '\0' na końcu tablicy.
- * @param[in] g     – wskaźnik na strukturę przechowującą dane o grze.
- * @return Liczba symbolizująca docelowy rozmiar tablicy znaków
- * reprezentującej planszę @p g.
+gamma_t *gamma_load(int fd) {
+    snapshot_header header;
+    if (!read_all(fd, &header, sizeof(header))) {
+        return NULL;
+    }
+    else if (!is_snapshot_header_valid(&header)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    gamma_t *g = snapshot_game_new(&header);
+    if (g == NULL) {
+        return NULL;
+    }
+    snapshot_player chunk[SNAPSHOT_PLAYERS_CHUNK];
+    snapshot_node nodes_chunk[SNAPSHOT_PLAYERS_CHUNK];
+    return finish_snapshot_game(g, load_players(g, chunk, fd) &&
+                                   (!header.is_sparse || load_field_cells(g, fd)) &&
+                                   load_field_nodes(g, nodes_chunk,
+                                                    header.field_nodes_count, fd) &&
+                                   load_tile_indices(g, &header, fd) &&
+                                   load_field_tiles(g, fd));
+}
+
+/** @brief Podłącza kafelki odwzorowanego zapisu do gry.
+ * Ustawia kafelki tablicy pól na obrazy kafelków w odwzorowanym pliku,
+ * kopiuje graczy, numery komórek pól rzadkiej planszy oraz dodatkowe
+ * węzły pól. Obcięty obraz ostatniego kafelka jest kopiowany
+ * do zaalokowanego kafelka. Pola kafelków nie są sprawdzane, bo wymagałoby
+ * to przejrzenia całego pliku; ścieżki w zbiorach find and union sprawdza
+ * dopiero ruch, który z nich korzysta, patrz @ref field_board_reserve_path.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry
+ *                         z zaalokowaną tablicą pól,
+ * @param[in] address    – adres odwzorowanego zapisu,
+ * @param[in] size       – rozmiar odwzorowanego zapisu, nie mniejszy
+ *                         od położenia obrazów kafelków,
+ * @param[in] header     – wskaźnik na poprawny nagłówek zapisu.
+ * @return Wartość @p true, jeśli podłączanie się powiodło, lub @p false
+ * w przeciwnym wypadku, wtedy @p errno opisuje błąd.
  */
-static uint64_t how_many_characters_will_map_have(gamma_t *g) {
-    // Każdy gracz zajmie tyle znaków, ile znaków
-    // ma gracz o największym numerze. Jeśli
-    // graczy jest przynajmniej 10, po każdym
-    // wystąpi jeszcze jedna spacja.
-    uint64_t size = ((uint64_t) g->board_height * (uint64_t) (g->board_width));
-    if(g->players_count >= 10) {
-        uint32_t multiplier = log10(g->players_count) + 2;
-        size *= multiplier;
+static bool attach_snapshot_tiles(gamma_t *g, char *address, size_t size,
+                                  const snapshot_header *header) {
+    char *data = address + sizeof(snapshot_header);
+    if (!load_players(g, (snapshot_player *) data, -1)) {
+        return false;
     }
+    data += (uint64_t) g->players_count * sizeof(snapshot_player);
 
-    // Miejsce na kolumnę znaków \n.
-    size += g->board_height;
-    //Jedna komórka dla znaku '\0'
-    size++;
+    if (header->is_sparse) {
+        g->field_cells = malloc(g->nodes_capacity * sizeof(uint64_t));
+        if (g->field_cells == NULL) {
+            errno = ENOMEM;
+            return false;
+        }
+        memcpy(g->field_cells, data, g->nodes_count * sizeof(uint64_t));
+        if (!rebuild_field_map(g)) {
+            return false;
+        }
+        data += g->nodes_count * sizeof(uint64_t);
+    }
 
-    return size;
+    if (!load_field_nodes(g, (snapshot_node *) data, header->field_nodes_count, -1)) {
+        return false;
+    }
+    data += header->field_nodes_count * sizeof(snapshot_node);
+
+    const uint64_t *indices = (const uint64_t *) data;
+    uint64_t offset = snapshot_tiles_offset(header);
+    for (uint64_t i = 0; i < header->tiles_count; i++) {
+        if (!is_tile_index_valid(g, indices[i], i == 0 ? UINT64_MAX : indices[i - 1]) ||
+            offset + snapshot_tile_size(g, indices[i]) > size) {
+            errno = EINVAL;
+            return false;
+        }
+
+        field_tile *tile = (field_tile *) (address + offset);
+        uint32_t count = snapshot_tile_fields(g, indices[i]);
+        if (count == FIELD_TILE_SIZE) {
+            g->fields.tiles[indices[i]] = tile;
+        }
+        else if (field_board_reserve(&g->fields, indices[i] << FIELD_TILE_SHIFT, 1)) {
+            memcpy(g->fields.tiles[indices[i]]->fields, tile->fields,
+                   count * sizeof(gamma_field));
+        }
+        else {
+            errno = ENOMEM;
+            return false;
+        }
+        offset += snapshot_tile_size(g, indices[i]);
+    }
+    return true;
 }
 
-char* gamma_board(gamma_t *g) {
-    if(g == NULL) {
+gamma_t *gamma_map(int fd) {
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
         return NULL;
     }
-    uint64_t array_size = how_many_characters_will_map_have(g);
-    char *map_string = malloc(array_size * sizeof(char));
-    if (map_string == NULL) {
+    else if ((uint64_t) file_stat.st_size < sizeof(snapshot_header)) {
+        errno = EINVAL;
         return NULL;
     }
 
-    uint64_t curr_index = 0;
-    uint32_t player_width = log10(g->players_count) + 1;
-    if(g->players_count > 9) {
-        player_width++;
+    size_t size = file_stat.st_size;
+    char *address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED) {
+        return NULL;
+    }
+    const snapshot_header *header = (const snapshot_header *) address;
+    if (!is_snapshot_header_valid(header) || snapshot_tiles_offset(header) > size) {
+        munmap(address, size);
+        errno = EINVAL;
+        return NULL;
     }
 
-    for (uint32_t y = g->board_height; y > 0; y--) {
-        for (uint32_t x = 0; x < g->board_width; x++) {
-            uint32_t owner = g->fields[x][y - 1].owner_index;
-            if (owner == DEFAULT_PLAYER_NUMBER) {
-                map_string[curr_index] = DEFAULT_PLAYER_IDENTIFIER;
-                curr_index++;
-                for(uint32_t i = 1; i < player_width; i++) {
-                    map_string[curr_index] = ' ';
-                    curr_index++;
-                }
+    gamma_t *g = snapshot_game_new(header);
+    if (g == NULL) {
+        munmap(address, size);
+        return NULL;
+    }
+    else if (!field_board_attach_mapping(&g->fields, address, size)) {
+        munmap(address, size);
+        gamma_delete(g);
+        errno = ENOMEM;
+        return NULL;
+    }
+    return finish_snapshot_game(g, attach_snapshot_tiles(g, address, size, header));
+}
+
+bool gamma_wal_open(gamma_t *g, int fd, uint32_t group_moves, uint32_t group_ms) {
+    if (g == NULL || fd < 0 || group_moves == 0 ||
+        group_moves > WAL_MAX_GROUP_MOVES) {
+        errno = EINVAL;
+        return false;
+    }
+    else if (!gamma_wal_close(g)) {
+        return false;
+    }
+
+    move_wal *wal = malloc(sizeof(move_wal));
+    wal_entry *pending = malloc(group_moves * sizeof(wal_entry));
+    if (wal == NULL || pending == NULL) {
+        free(wal);
+        free(pending);
+        errno = ENOMEM;
+        return false;
+    }
+    wal->fd = fd;
+    wal->error = 0;
+    wal->has_failed = false;
+    wal->group_moves = group_moves;
+    wal->group_ns = (uint64_t) group_ms * 1000000u;
+    wal->first_pending_ns = 0;
+    wal->pending = pending;
+
+    // Segment zaczyna się od numeru następnego ruchu gry.
+    set_wal_entry(&pending[0], WAL_SEGMENT, 0, WAL_VERSION,
+                  (uint32_t) g->applied_moves, (uint32_t) (g->applied_moves >> 32));
+    wal->pending_count = 1;
+    if (!flush_wal(wal)) {
+        int error = errno;
+        free(pending);
+        free(wal);
+        errno = error;
+        return false;
+    }
+    g->wal = wal;
+    return true;
+}
+
+bool gamma_wal_sync(gamma_t *g) {
+    if (g == NULL || g->wal == NULL) {
+        errno = EINVAL;
+        return false;
+    }
+    return flush_wal(g->wal);
+}
+
+bool gamma_wal_close(gamma_t *g) {
+    if (g == NULL || g->wal == NULL) {
+        return true;
+    }
+
+    bool is_synced = flush_wal(g->wal);
+    free(g->wal->pending);
+    free(g->wal);
+    g->wal = NULL;
+    return is_synced;
+}
+
+/** @brief Wykonuje ruch zapisany w dzienniku zapisu z wyprzedzeniem.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] entry      – wskaźnik na poprawny wpis ruchu.
+ * @return Wartość @p true, jeśli ruch się powiódł, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool replay_wal_entry(gamma_t *g, const wal_entry *entry) {
+    uint32_t kind = entry->tag & ((1u << WAL_KIND_BITS) - 1);
+    if (kind == WAL_MOVE) {
+        return gamma_move(g, entry->player, entry->x, entry->y);
+    }
+    return (kind == WAL_GOLDEN_MOVE &&
+            gamma_golden_move(g, entry->player, entry->x, entry->y));
+}
+
+/** @brief Przetwarza wpis dziennika zapisu z wyprzedzeniem.
+ * Rozpoczyna segment lub wykonuje ruch o numerze następnego ruchu gry,
+ * pomijając ruchy wykonane przed wykonaniem zapisu stanu gry.
+ * @param[in,out] g          – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] entry          – wskaźnik na wpis,
+ * @param[in,out] sequence   – numer ruchu, który powinien zawierać wpis,
+ *                             lub UINT64_MAX przed pierwszym segmentem.
+ * @return Wartość 1, jeśli wpis był poprawny, 0, jeśli wpis jest niepełny
+ * lub uszkodzony, czyli dziennik się skończył, lub -1, jeśli wpis jest
+ * poprawny, ale nie pasuje do gry, wtedy @p errno ma wartość EINVAL.
+ */
+static int replay_wal_step(gamma_t *g, const wal_entry *entry, uint64_t *sequence) {
+    uint32_t kind = entry->tag & ((1u << WAL_KIND_BITS) - 1);
+    if (kind == WAL_SEGMENT) {
+        if (!is_wal_entry_valid(entry, 0) || entry->player != WAL_VERSION) {
+            return 0;
+        }
+        *sequence = ((uint64_t) entry->y << 32) | entry->x;
+        return 1;
+    }
+    else if (*sequence == UINT64_MAX || !is_wal_entry_valid(entry, *sequence)) {
+        return 0;
+    }
+    else if (*sequence > g->applied_moves ||
+             (*sequence == g->applied_moves && !replay_wal_entry(g, entry))) {
+        errno = EINVAL;
+        return -1;
+    }
+    (*sequence)++;
+    return 1;
+}
+
+bool gamma_wal_replay(gamma_t *g, int fd) {
+    if (g == NULL || g->wal != NULL) {
+        errno = EINVAL;
+        return false;
+    }
+
+    off_t start = lseek(fd, 0, SEEK_CUR);
+    wal_entry chunk[WAL_READ_CHUNK];
+    uint64_t sequence = UINT64_MAX;
+    uint64_t valid_entries = 0;
+    bool has_ended = false;
+    while (!has_ended) {
+        ssize_t read_bytes = read_full(fd, chunk, sizeof(chunk));
+        if (read_bytes < 0) {
+            return false;
+        }
+        has_ended = ((size_t) read_bytes < sizeof(chunk));
+
+        size_t count = read_bytes / sizeof(wal_entry);
+        for (size_t i = 0; i < count; i++) {
+            int result = replay_wal_step(g, &chunk[i], &sequence);
+            if (result < 0) {
+                return false;
             }
-            else {
-                number_to_char(map_string, owner, &curr_index, player_width);
+            else if (result == 0) {
+                has_ended = true;
+                break;
             }
+            valid_entries++;
         }
-        map_string[curr_index] = '\n';
-        curr_index++;
     }
-    map_string[curr_index] = '\0';
 
-    return map_string;
+    // Niepełny lub uszkodzony koniec dziennika jest obcinany, aby kolejny
+    // segment został dopisany bezpośrednio za ostatnim poprawnym wpisem.
+    off_t valid_end = start + valid_entries * sizeof(wal_entry);
+    if (start >= 0 && lseek(fd, 0, SEEK_CUR) != valid_end &&
+        (ftruncate(fd, valid_end) != 0 || lseek(fd, valid_end, SEEK_SET) < 0)) {
+        return false;
+    }
+    return true;
 }
 
-inline uint32_t gamma_player_owned_areas(gamma_t *g, uint32_t player) {
-    if(g != NULL) {
-        return (player <= g->players_count)
-               ? g->players[player - 1].number_of_areas
-               : 0;
+/** @brief Wykonuje ruch zapisany w zapisie rozgrywki.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą dane gry,
+ * @param[in] move       – wskaźnik na ruch.
+ * @return Wartość @p true, jeśli ruch się powiódł, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool apply_replay_move(gamma_t *g, const wal_entry *move) {
+    if (move->tag == WAL_GOLDEN_MOVE) {
+        return gamma_golden_move(g, move->player, move->x, move->y);
     }
-    else {
-        return 0;
+    return gamma_move(g, move->player, move->x, move->y);
+}
+
+/** @brief Zapamiętuje kopię stanu gry po ostatnim zapisanym ruchu.
+ * @param[in,out] replay – wskaźnik na zapis rozgrywki.
+ * @return Wartość @p true, jeśli udało się utworzyć kopię, lub @p false
+ * w przeciwnym wypadku.
+ */
+static bool add_replay_checkpoint(gamma_replay_t *replay) {
+    if (replay->checkpoints_count == replay->checkpoints_capacity &&
+        !grow_undo_array((void **) &replay->checkpoints,
+                         &replay->checkpoints_capacity, sizeof(gamma_t *))) {
+        return false;
+    }
+
+    gamma_t *checkpoint = clone_game(replay->head);
+    if (checkpoint == NULL) {
+        return false;
     }
+    replay->checkpoints[replay->checkpoints_count] = checkpoint;
+    (replay->checkpoints_count)++;
+    return true;
 }
 
-inline uint32_t gamma_max_areas(gamma_t *g) {
-    return (g != NULL) ? g->max_areas : 0;
+gamma_replay_t *gamma_replay_new(uint32_t width, uint32_t height,
+                                 uint32_t players, uint32_t areas,
+                                 uint32_t interval) {
+    if (interval == 0) {
+        return NULL;
+    }
+
+    gamma_replay_t *replay = calloc(1, sizeof(gamma_replay_t));
+    if (replay == NULL) {
+        return NULL;
+    }
+    replay->interval = interval;
+    replay->head = gamma_new(width, height, players, areas);
+    if (replay->head == NULL || !add_replay_checkpoint(replay)) {
+        gamma_replay_delete(replay);
+        return NULL;
+    }
+    return replay;
 }
 
-inline uint64_t gamma_largest_number_of_owned_fields(gamma_t *g) {
-    if(g != NULL) {
-        uint64_t curr_max = 0;
-        for(uint32_t i = 0; i < g->players_count; i++) {
-            uint64_t temp = gamma_busy_fields(g, i + 1);
-            if(temp > curr_max) {
-                curr_max = temp;
-            }
+void gamma_replay_delete(gamma_replay_t *replay) {
+    if (replay != NULL) {
+        for (uint64_t i = 0; i < replay->checkpoints_count; i++) {
+            gamma_delete(replay->checkpoints[i]);
         }
+        free(replay->checkpoints);
+        free(replay->moves);
+        gamma_delete(replay->cursor);
+        gamma_delete(replay->head);
+        free(replay);
+    }
+}
 
-        return curr_max;
+/** @brief Dopisuje ruch do zapisu rozgrywki.
+ * Wykonuje ruch na stanie gry po wszystkich zapisanych ruchach i, jeśli
+ * się powiódł, zapamiętuje go, a co @p interval ruchów także kopię stanu.
+ * @param[in,out] replay – wskaźnik na zapis rozgrywki,
+ * @param[in] kind       – rodzaj ruchu, @ref WAL_MOVE lub @ref WAL_GOLDEN_MOVE,
+ * @param[in] player     – numer gracza,
+ * @param[in] x          – numer kolumny,
+ * @param[in] y          – numer wiersza.
+ * @return Wartość @p true, jeśli ruch został wykonany i zapamiętany,
+ * lub @p false w przeciwnym wypadku.
+ */
+static bool record_replay_move(gamma_replay_t *replay, uint32_t kind,
+                               uint32_t player, uint32_t x, uint32_t y) {
+    if (replay == NULL) {
+        return false;
     }
-    else {
-        return 0;
+
+    gamma_t *head = replay->head;
+    uint64_t length = head->applied_moves;
+    if (length == replay->moves_capacity &&
+        !grow_undo_array((void **) &replay->moves, &replay->moves_capacity,
+                         sizeof(wal_entry))) {
+        return false;
+    }
+
+    wal_entry *move = &replay->moves[length];
+    move->tag = kind;
+    move->player = player;
+    move->x = x;
+    move->y = y;
+    if (!apply_replay_move(head, move)) {
+        return false;
+    }
+    // Bez kopii stanu zapis pozostaje poprawny, jedynie dłużej się przewija,
+    // a kolejna kopia powstanie po następnych @p interval ruchach.
+    if (head->applied_moves % replay->interval == 0) {
+        add_replay_checkpoint(replay);
+    }
+    return true;
+}
+
+bool gamma_replay_move(gamma_replay_t *replay, uint32_t player,
+                       uint32_t x, uint32_t y) {
+    return record_replay_move(replay, WAL_MOVE, player, x, y);
+}
+
+bool gamma_replay_golden_move(gamma_replay_t *replay, uint32_t player,
+                              uint32_t x, uint32_t y) {
+    return record_replay_move(replay, WAL_GOLDEN_MOVE, player, x, y);
+}
+
+uint64_t gamma_replay_length(const gamma_replay_t *replay) {
+    return (replay == NULL) ? 0 : replay->head->applied_moves;
+}
+
+gamma_t *gamma_replay_seek(gamma_replay_t *replay, uint64_t move) {
+    if (replay == NULL || move > replay->head->applied_moves) {
+        return NULL;
+    }
+
+    // Kopia stanu gry sprzed pierwszego ruchu zawsze istnieje, więc szukamy
+    // ostatniej kopii po co najwyżej @p move ruchach.
+    uint64_t first = 0, last = replay->checkpoints_count - 1;
+    while (first < last) {
+        uint64_t middle = last - (last - first) / 2;
+        if (replay->checkpoints[middle]->applied_moves <= move) {
+            first = middle;
+        }
+        else {
+            last = middle - 1;
+        }
+    }
+    gamma_t *base = replay->checkpoints[first];
+
+    // Ruchy wykonane na kursorze przez wywołującego zmieniają jego licznik
+    // ruchów, więc taki kursor jest odtwarzany od kopii stanu.
+    gamma_t *cursor = replay->cursor;
+    if (cursor == NULL || cursor->applied_moves != replay->cursor_moves ||
+        cursor->applied_moves > move ||
+        cursor->applied_moves < base->applied_moves) {
+        gamma_delete(cursor);
+        cursor = clone_game(base);
+        replay->cursor = cursor;
+        if (cursor == NULL) {
+            return NULL;
+        }
     }
-}
\ No newline at end of file
+
+    while (cursor->applied_moves < move) {
+        // Zapisany ruch raz się powiódł, więc może się nie powieść
+        // jedynie z braku pamięci.
+        if (!apply_replay_move(cursor, &replay->moves[cursor->applied_moves])) {
+            gamma_delete(cursor);
+            replay->cursor = NULL;
+            return NULL;
+        }
+    }
+    replay->cursor_moves = move;
+    return cursor;
+}
@@ -18,9 +18,19 @@
  */
 typedef struct gamma gamma_t;
 
+/**
+ * Struktura przechowująca zapis rozgrywki.
+ */
+typedef struct gamma_replay gamma_replay_t;
+
 /** @brief Tworzy strukturę przechowującą stan gry.
  * Alokuje pamięć na nową strukturę przechowującą stan gry.
  * Inicjuje tę strukturę tak, aby reprezentowała początkowy stan gry.
+ * Pamięć na pola jest alokowana dopiero przy pierwszym zapisie, więc czas
+ * działania nie zależy od rozmiaru planszy. Plansze, których węzły find
+ * and union nie mieszczą się w 2^31 indeksach, lub takie, dla których nie
+ * udało się zaalokować tablic o rozmiarze planszy, są przechowywane jako
+ * rzadkie: pamiętane są jedynie pola, które zostały kiedykolwiek zajęte.
  * @param[in] width   – szerokość planszy, liczba dodatnia,
  * @param[in] height  – wysokość planszy, liczba dodatnia,
  * @param[in] players – liczba graczy, liczba dodatnia,
@@ -32,6 +42,24 @@ typedef struct gamma gamma_t;
 gamma_t* gamma_new(uint32_t width, uint32_t height,
                    uint32_t players, uint32_t areas);
 
+/** @brief Tworzy kopię stanu gry.
+ * Tworzy nową strukturę przechowującą ten sam stan gry co @p g.
+ * Kopia i oryginał współdzielą planszę podzieloną na kafelki, a kafelek
+ * jest kopiowany dopiero wtedy, gdy jedna ze struktur go zmienia,
+ * więc utworzenie kopii nie kopiuje planszy, a zużyta pamięć rośnie
+ * z liczbą zmienionych kafelków. Po utworzeniu kopia i oryginał
+ * są niezależne i mogą być zmieniane jednocześnie w różnych wątkach,
+ * jednak w trakcie tworzenia kopii struktura @p g nie może być zmieniana.
+ * Cofanie ruchów w kopii jest wyłączone. Pamięć potrzebna do przeszukiwania
+ * planszy jest alokowana dopiero przy pierwszym przeszukiwaniu kopii.
+ * Kafelki, które zmieni ruch, są kopiowane przed zmianą stanu gry, więc
+ * jeśli nie uda się zaalokować na nie pamięci, ruch nie zostaje wykonany.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci lub parametr @p g ma wartość NULL.
+ */
+gamma_t* gamma_clone(const gamma_t *g);
+
 /** @brief Usuwa strukturę przechowującą stan gry.
  * Usuwa z pamięci strukturę wskazywaną przez @p g.
  * Nic nie robi, jeśli wskaźnik ten ma wartość NULL.
@@ -49,7 +77,8 @@ void gamma_delete(gamma_t *g);
  * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
  *                      @p height z funkcji @ref gamma_new.
  * @return Wartość @p true, jeśli ruch został wykonany, a @p false,
- * gdy ruch jest nielegalny lub któryś z parametrów jest niepoprawny.
+ * gdy ruch jest nielegalny, któryś z parametrów jest niepoprawny
+ * lub nie udało się zaalokować pamięci, wtedy stan gry się nie zmienia.
  */
 bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
 
@@ -64,8 +93,9 @@ bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
  * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
  *                      @p height z funkcji @ref gamma_new.
  * @return Wartość @p true, jeśli ruch został wykonany, a @p false,
- * gdy gracz wykorzystał już swój złoty ruch, ruch jest nielegalny
- * lub któryś z parametrów jest niepoprawny.
+ * gdy gracz wykorzystał już swój złoty ruch, ruch jest nielegalny,
+ * któryś z parametrów jest niepoprawny lub nie udało się zaalokować
+ * pamięci, wtedy stan gry się nie zmienia.
  */
 bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
 
@@ -103,16 +133,59 @@ uint64_t gamma_free_fields(gamma_t *g, uint32_t player);
  */
 bool gamma_golden_possible(gamma_t *g, uint32_t player);
 
+/** @brief Wyznacza wszystkie pola, na które gracz może wykonać złoty ruch.
+ * Alokuje w pamięci tablicę, w której umieszcza współrzędne wszystkich pól,
+ * na które gracz @p player może w danym stanie gry wykonać złoty ruch.
+ * Współrzędne pola o numerze i znajdują się pod indeksami 2 * i (kolumna)
+ * oraz 2 * i + 1 (wiersz), pola są uporządkowane wierszami.
+ * Funkcja wywołująca musi zwolnić tę tablicę.
+ * Działa w czasie liniowym względem wielkości planszy, a dla rzadkiej
+ * planszy względem liczby zajętych pól.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[out] count  – liczba znalezionych pól.
+ * @return Wskaźnik na zaalokowaną tablicę lub NULL, jeśli takich pól nie ma,
+ * któryś z parametrów jest niepoprawny lub nie udało się zaalokować pamięci.
+ */
+uint32_t* gamma_golden_targets(gamma_t *g, uint32_t player, uint64_t *count);
+
 /** @brief Daje napis opisujący stan planszy.
  * Alokuje w pamięci bufor, w którym umieszcza napis zawierający tekstowy
  * opis aktualnego stanu planszy. Przykład znajduje się w pliku gamma_test.c.
  * Funkcja wywołująca musi zwolnić ten bufor.
  * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
  * @return Wskaźnik na zaalokowany bufor zawierający napis opisujący stan
- * planszy lub NULL, jeśli nie udało się zaalokować pamięci.
+ * planszy lub NULL, jeśli nie udało się zaalokować pamięci
+ * lub opis jest zbyt długi.
  */
 char* gamma_board(gamma_t *g);
 
+/** @brief Daje napis opisujący stan planszy bez jego kopiowania.
+ * Zwraca opis planszy w tym samym formacie co funkcja @ref gamma_board.
+ * Opis jest tworzony przy pierwszym wywołaniu, a następnie przechowywany
+ * w strukturze gry i aktualizowany przez każdy ruch, złoty ruch i
+ * wycofanie ruchu, które przepisują jedynie zmienione pola.
+ * Wywołujący nie może modyfikować ani zwalniać tego napisu; pozostaje on
+ * ważny do usunięcia gry funkcją @ref gamma_delete.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wskaźnik na napis opisujący stan planszy lub NULL, jeśli
+ * nie udało się zaalokować pamięci lub opis jest zbyt długi.
+ */
+const char* gamma_board_view(gamma_t *g);
+
+/** @brief Zapisuje opis planszy do deskryptora pliku.
+ * Zapisuje opis planszy w formacie funkcji @ref gamma_board, bez kończącego
+ * znaku '\0'. Jeśli opis nie został jeszcze utworzony funkcją
+ * @ref gamma_board_view, składa go wiersz po wierszu w buforze stałego
+ * rozmiaru, więc nie alokuje pamięci proporcjonalnej do rozmiaru planszy.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] fd      – deskryptor pliku otwartego do zapisu.
+ * @return Wartość @p true, jeśli zapisano cały opis, lub @p false, jeśli
+ * parametr jest niepoprawny lub zapis się nie powiódł.
+ */
+bool gamma_board_write(gamma_t *g, int fd);
+
 /** @brief Daje liczbę obszarów posiadanych przez gracza.
  * Przekazuje liczbę różnych obszarów posiadanych przez gracza
  * o indeksie @p player.
@@ -142,4 +215,254 @@ uint32_t gamma_max_areas(gamma_t *g);
  */
 uint64_t gamma_largest_number_of_owned_fields(gamma_t *g);
 
+/** @brief Włącza lub wyłącza możliwość cofania ruchów.
+ * Po włączeniu każdy wykonany ruch i złoty ruch zapisuje w dzienniku
+ * zmienione przez siebie dane, co pozwala go cofnąć funkcją @ref gamma_undo
+ * w czasie proporcjonalnym do liczby tych zmian. Wyłączenie zwalnia
+ * dziennik, więc wcześniejszych ruchów nie da się już cofnąć.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] enable  – @p true, jeśli cofanie ruchów ma być włączone
+ *                      lub @p false, jeśli ma być wyłączone.
+ * @return Wartość @p true, jeśli operacja się powiodła, a @p false,
+ * jeśli parametr @p g ma wartość NULL lub nie udało się zaalokować pamięci.
+ */
+bool gamma_undo_enable(gamma_t *g, bool enable);
+
+/** @brief Cofa ostatni ruch.
+ * Przywraca stan gry sprzed ostatniego niecofniętego ruchu lub złotego
+ * ruchu wykonanego od włączenia cofania ruchów funkcją
+ * @ref gamma_undo_enable. Jeśli nie udało się zaalokować pamięci na zapis
+ * któregoś ruchu, nie da się cofnąć ani jego, ani ruchów wcześniejszych.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli ruch został cofnięty, a @p false,
+ * jeśli nie ma ruchu do cofnięcia, parametr @p g ma wartość NULL
+ * lub nie udało się zaalokować pamięci, wtedy stan gry się nie zmienia.
+ */
+bool gamma_undo(gamma_t *g);
+
+/** @brief Podaje statystyki sprawdzania podziału obszarów.
+ * Przekazuje liczbę sprawdzeń, czy usunięcie pola podzieli obszar jego
+ * właściciela, wykonanych od utworzenia gry, oraz liczbę tych z nich,
+ * które rozstrzygnięto na podstawie pól otaczających pole,
+ * bez przechodzenia całego obszaru.
+ * @param[in] g                  – wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] checks            – liczba wszystkich sprawdzeń,
+ * @param[out] resolved_locally  – liczba sprawdzeń rozstrzygniętych lokalnie.
+ */
+void gamma_split_check_stats(gamma_t *g, uint64_t *checks,
+                             uint64_t *resolved_locally);
+
+/** @brief Zapisuje stan gry do pliku.
+ * Zapisuje do pliku o deskryptorze @p fd, od jego bieżącej pozycji,
+ * binarny zapis stanu gry: rozmiary planszy, stan graczy oraz zaalokowane
+ * fragmenty tablicy pól wraz ze zbiorami find and union, bez konwersji
+ * pojedynczych pól. Dziennik cofania ruchów nie jest zapisywany. Zapis może
+ * zostać wczytany funkcją @ref gamma_load na komputerze o tej samej
+ * kolejności bajtów, a zapis na początku zwykłego pliku również odwzorowany
+ * w pamięci funkcją @ref gamma_map.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] fd      – deskryptor pliku otwartego do zapisu.
+ * @return Wartość @p true, jeśli zapis się powiódł, a @p false, jeśli
+ * parametr @p g ma wartość NULL lub zapis się nie powiódł; wtedy zmienna
+ * @p errno opisuje błąd, a w pliku mógł zostać zapisany fragment stanu.
+ */
+bool gamma_save(gamma_t *g, int fd);
+
+/**
+ * Typ funkcji informującej o postępie zapisu stanu gry. Przyjmuje liczbę
+ * zapisanych bajtów, rozmiar całego zapisu oraz wskaźnik przekazany
+ * funkcji @ref gamma_save_progress.
+ */
+typedef void (*gamma_progress_t)(uint64_t written, uint64_t total, void *data);
+
+/** @brief Zapisuje stan gry do pliku, informując o postępie.
+ * Działa jak funkcja @ref gamma_save, ale po zapisaniu początku stanu
+ * i po każdym fragmencie tablicy pól wywołuje funkcję @p progress,
+ * jeśli jest różna od NULL. Ostatnie wywołanie otrzymuje liczbę zapisanych
+ * bajtów równą rozmiarowi całego zapisu.
+ * @param[in] g          – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] fd         – deskryptor pliku otwartego do zapisu,
+ * @param[in] progress   – funkcja informująca o postępie lub NULL,
+ * @param[in] data       – wskaźnik przekazywany funkcji @p progress.
+ * @return Wartość @p true, jeśli zapis się powiódł, a @p false w przeciwnym
+ * wypadku, tak jak w funkcji @ref gamma_save.
+ */
+bool gamma_save_progress(gamma_t *g, int fd, gamma_progress_t progress,
+                         void *data);
+
+/** @brief Wczytuje stan gry z pliku.
+ * Wczytuje z pliku o deskryptorze @p fd, od jego bieżącej pozycji, stan
+ * gry zapisany funkcją @ref gamma_save i tworzy przechowującą go strukturę.
+ * Dane są czytane strumieniowo, bezpośrednio do tablicy pól, więc plik
+ * może być również potokiem. Wczytane pola są sprawdzane, a ścieżki
+ * w zbiorach find and union, tak jak w funkcji @ref gamma_map, dopiero przy
+ * ruchu, który z nich korzysta. Cofanie ruchów we wczytanej grze jest wyłączone.
+ * @param[in] fd      – deskryptor pliku otwartego do odczytu.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy odczyt się nie
+ * powiódł, zapis jest niepoprawny (wtedy @p errno ma wartość EINVAL)
+ * lub nie udało się zaalokować pamięci.
+ */
+gamma_t* gamma_load(int fd);
+
+/** @brief Odwzorowuje stan gry z pliku w pamięci.
+ * Tworzy strukturę gry ze stanu zapisanego funkcją @ref gamma_save
+ * na początku zwykłego pliku o deskryptorze @p fd, bez wczytywania
+ * tablicy pól: jej kafelki pozostają w prywatnym odwzorowaniu pliku,
+ * więc procesy odwzorowujące ten sam plik współdzielą jego strony w pamięci
+ * podręcznej systemu, a strona jest kopiowana dopiero przy pierwszym zapisie.
+ * Kopiowani są jedynie gracze oraz, dla rzadkiej planszy, numery komórek pól.
+ * Plik nie jest nigdy modyfikowany, a deskryptor można zamknąć zaraz po
+ * wywołaniu. Czas działania nie zależy od rozmiaru tablicy pól, więc
+ * w przeciwieństwie do funkcji @ref gamma_load pola kafelków nie są
+ * sprawdzane: plik musi pochodzić z funkcji @ref gamma_save i nie może być
+ * później zmieniany, inaczej wyniki funkcji są nieokreślone. Jedynie
+ * ścieżki w zbiorach find and union są sprawdzane przy ruchu, który z nich
+ * korzysta, więc rodzic spoza planszy lub cykl sprawia, że ruch się nie
+ * udaje, zamiast zawiesić program.
+ * Cofanie ruchów w odwzorowanej grze jest wyłączone.
+ * @param[in] fd      – deskryptor zwykłego pliku otwartego do odczytu.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy odwzorowanie się nie
+ * powiodło, zapis jest niepoprawny (wtedy @p errno ma wartość EINVAL)
+ * lub nie udało się zaalokować pamięci.
+ */
+gamma_t* gamma_map(int fd);
+
+/** @brief Rozpoczyna zapisywanie ruchów w dzienniku.
+ * Dopisuje do pliku o deskryptorze @p fd, od jego bieżącej pozycji,
+ * początek segmentu dziennika zapisu z wyprzedzeniem, a następnie zapisuje
+ * w nim każdy udany ruch i złoty ruch gry, po 16 bajtów na ruch.
+ * Ruchy są zapisywane i synchronizowane z dyskiem grupami: gdy zbierze się
+ * @p group_moves ruchów lub gdy przy kolejnym ruchu najstarszy niezapisany
+ * ruch czeka co najmniej @p group_ms milisekund. Ruch jest więc wykonywany,
+ * zanim trafi na dysk, a awaria może utracić ostatnią grupę. Jeśli gra
+ * miała już dziennik, jest on najpierw zamykany. Dopóki dziennik jest
+ * otwarty, cofanie ruchów jest niedostępne.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] fd         – deskryptor pliku otwartego do zapisu,
+ * @param[in] group_moves – maksymalna liczba ruchów synchronizowanych
+ *                         razem, dodatnia i niewiększa od 65536,
+ * @param[in] group_ms   – maksymalny czas oczekiwania ruchu na zapis
+ *                         w milisekundach lub 0, jeśli nieograniczony.
+ * @return Wartość @p true, jeśli dziennik został otwarty, a @p false,
+ * jeśli parametry są niepoprawne, nie udało się zamknąć poprzedniego
+ * dziennika lub zapisać początku segmentu; wtedy @p errno opisuje błąd.
+ */
+bool gamma_wal_open(gamma_t *g, int fd, uint32_t group_moves, uint32_t group_ms);
+
+/** @brief Zapisuje oczekujące ruchy dziennika.
+ * Zapisuje i synchronizuje z dyskiem ruchy zebrane w dzienniku gry.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli wszystkie ruchy od otwarcia dziennika
+ * zostały zapisane, a @p false, jeśli gra nie ma dziennika lub któryś
+ * zapis się nie powiódł; wtedy @p errno opisuje pierwszy błąd.
+ */
+bool gamma_wal_sync(gamma_t *g);
+
+/** @brief Zamyka dziennik ruchów gry.
+ * Zapisuje oczekujące ruchy i kończy zapisywanie ruchów. Deskryptor pliku
+ * nie jest zamykany. Funkcja jest wywoływana przez @ref gamma_delete.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli gra nie miała dziennika lub wszystkie
+ * ruchy zostały zapisane, a @p false w przeciwnym wypadku; wtedy
+ * @p errno opisuje pierwszy błąd.
+ */
+bool gamma_wal_close(gamma_t *g);
+
+/** @brief Odtwarza ruchy zapisane w dzienniku.
+ * Czyta dziennik z pliku o deskryptorze @p fd, od jego bieżącej pozycji,
+ * i wykonuje zapisane w nim ruchy, które nastąpiły po stanie gry @p g,
+ * na przykład wczytanym funkcją @ref gamma_load z ostatniego zapisu.
+ * Wcześniejsze ruchy są pomijane. Odtwarzanie kończy się na końcu pliku
+ * lub na pierwszym niepełnym albo uszkodzonym wpisie, który pozostał
+ * po awarii; plik jest wtedy obcinany za ostatnim poprawnym wpisem, więc
+ * kolejne wywołanie @ref gamma_wal_open z tym deskryptorem dopisze nowy
+ * segment w miejscu uszkodzonego końca.
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą stan gry,
+ *                         bez otwartego dziennika,
+ * @param[in] fd         – deskryptor pliku otwartego do odczytu i zapisu.
+ * @return Wartość @p true, jeśli odtwarzanie się powiodło, a @p false,
+ * jeśli odczyt lub obcięcie pliku się nie powiodło, gra ma otwarty dziennik
+ * albo dziennik nie pasuje do gry, bo brakuje w nim ruchów następujących
+ * po stanie gry lub zapisany ruch jest niedozwolony (wtedy @p errno ma
+ * wartość EINVAL); ruchy wykonane przed błędem pozostają wykonane.
+ */
+bool gamma_wal_replay(gamma_t *g, int fd);
+
+/** @brief Tworzy zapis rozgrywki.
+ * Tworzy zapis rozgrywki na nowej planszy o podanych parametrach, takich
+ * jak w funkcji @ref gamma_new. Zapis przechowuje listę ruchów oraz,
+ * co @p interval ruchów, kopię stanu gry współdzielącą niezmienione
+ * fragmenty planszy z pozostałymi kopiami, więc przejście do dowolnego
+ * ruchu wymaga wykonania co najwyżej @p interval - 1 ruchów. Jeśli kopii
+ * nie udało się utworzyć z braku pamięci, przejście zaczyna się od
+ * wcześniejszej kopii, a kolejna powstaje po następnych @p interval
+ * ruchach. Kopia zajmuje
+ * fragmenty planszy po 4096 pól zmienione od poprzedniej kopii, więc przy
+ * ruchach rozrzuconych po całej planszy @p interval wyznacza kompromis
+ * między czasem przejścia a zajmowaną pamięcią.
+ * @param[in] width      – szerokość planszy,
+ * @param[in] height     – wysokość planszy,
+ * @param[in] players    – liczba graczy,
+ * @param[in] areas      – maksymalna liczba obszarów jednego gracza,
+ * @param[in] interval   – liczba ruchów między kopiami stanu gry, dodatnia.
+ * @return Wskaźnik na utworzony zapis lub NULL, gdy nie udało się
+ * zaalokować pamięci lub któryś z parametrów jest niepoprawny.
+ */
+gamma_replay_t* gamma_replay_new(uint32_t width, uint32_t height,
+                                 uint32_t players, uint32_t areas,
+                                 uint32_t interval);
+
+/** @brief Usuwa zapis rozgrywki.
+ * Usuwa z pamięci zapis rozgrywki wraz ze stanem gry zwróconym przez
+ * funkcję @ref gamma_replay_seek. Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in] replay     – wskaźnik na usuwany zapis.
+ */
+void gamma_replay_delete(gamma_replay_t *replay);
+
+/** @brief Dopisuje ruch do zapisu rozgrywki.
+ * Wykonuje ruch tak jak funkcja @ref gamma_move na stanie gry po wszystkich
+ * zapisanych ruchach i, jeśli się powiódł, dopisuje go do zapisu.
+ * @param[in,out] replay – wskaźnik na zapis rozgrywki,
+ * @param[in] player     – numer gracza,
+ * @param[in] x          – numer kolumny,
+ * @param[in] y          – numer wiersza.
+ * @return Wartość @p true, jeśli ruch został wykonany i zapisany,
+ * a @p false w przeciwnym przypadku.
+ */
+bool gamma_replay_move(gamma_replay_t *replay, uint32_t player,
+                       uint32_t x, uint32_t y);
+
+/** @brief Dopisuje złoty ruch do zapisu rozgrywki.
+ * Działa jak funkcja @ref gamma_replay_move dla złotego ruchu.
+ * @param[in,out] replay – wskaźnik na zapis rozgrywki,
+ * @param[in] player     – numer gracza,
+ * @param[in] x          – numer kolumny,
+ * @param[in] y          – numer wiersza.
+ * @return Wartość @p true, jeśli ruch został wykonany i zapisany,
+ * a @p false w przeciwnym przypadku.
+ */
+bool gamma_replay_golden_move(gamma_replay_t *replay, uint32_t player,
+                              uint32_t x, uint32_t y);
+
+/** @brief Podaje liczbę ruchów w zapisie rozgrywki.
+ * @param[in] replay     – wskaźnik na zapis rozgrywki.
+ * @return Liczba zapisanych ruchów lub zero, jeśli wskaźnik ma wartość NULL.
+ */
+uint64_t gamma_replay_length(const gamma_replay_t *replay);
+
+/** @brief Przechodzi do stanu gry po danym ruchu.
+ * Odtwarza stan gry po @p move pierwszych zapisanych ruchach z najbliższej
+ * wcześniejszej kopii stanu lub, jeśli to bliżej, z poprzednio zwróconego
+ * stanu. Zwrócony stan należy do zapisu rozgrywki i jest ważny do kolejnego
+ * wywołania tej funkcji lub usunięcia zapisu; nie wolno go usuwać.
+ * Można go zmieniać, na przykład sprawdzając ruchy alternatywne, wtedy
+ * kolejne przejście odtworzy stan od kopii.
+ * @param[in,out] replay – wskaźnik na zapis rozgrywki,
+ * @param[in] move       – liczba ruchów, niewiększa od długości zapisu.
+ * @return Wskaźnik na stan gry lub NULL, jeśli parametry są niepoprawne
+ * lub nie udało się zaalokować pamięci; wtedy poprzednio zwrócony stan
+ * zostaje usunięty.
+ */
+gamma_t* gamma_replay_seek(gamma_replay_t *replay, uint64_t move);
+
 #endif /* GAMMA_H */
@@ -6,11 +6,21 @@
  * @date 4.05.2020
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "gamma_batch_mode.h"
-#include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <pthread.h>
 #include "gamma_input.h"
+#include "gamma_output.h"
+#include "gamma_ring.h"
 
 /**
  * Symbol informujący o tym, że powinna zostać wywołana funkcja @ref gamma_move.
@@ -38,10 +48,85 @@
 #define CALL_GAMMA_GOLDEN_POSSIBLE 'q'
 
 /**
- * Symbol informujący o tym, że powinna zostać wywołana funkcja @ref gamma_board.
+ * Symbol informujący o tym, że powinna zostać wywołana funkcja
+ * @ref gamma_board_write.
  */
 #define CALL_GAMMA_BOARD 'p'
 
+/**
+ * Symbol informujący o tym, że powinna zostać wywołana funkcja @ref gamma_save.
+ */
+#define CALL_GAMMA_SAVE 's'
+
+/**
+ * Symbol informujący o tym, że powinna zostać wywołana funkcja @ref gamma_load.
+ */
+#define CALL_GAMMA_LOAD 'l'
+
+/**
+ * Symbol informujący o tym, że powinna zostać wywołana funkcja @ref gamma_map.
+ */
+#define CALL_GAMMA_MAP 'o'
+
+/**
+ * Symbol informujący o tym, że powinna zostać wywołana funkcja
+ * @ref gamma_save_progress w procesie potomnym.
+ */
+#define CALL_GAMMA_BACKGROUND_SAVE 'w'
+
+/**
+ * Symbol informujący o tym, że powinna zostać wywołana funkcja
+ * @ref gamma_wal_open.
+ */
+#define CALL_GAMMA_WAL_OPEN 'j'
+
+/**
+ * Symbol informujący o tym, że powinna zostać wywołana funkcja
+ * @ref gamma_wal_replay.
+ */
+#define CALL_GAMMA_WAL_REPLAY 'r'
+
+/**
+ * Co ile procent zapisu w tle proces potomny wypisuje postęp.
+ */
+#define BACKGROUND_SAVE_PROGRESS_STEP 10
+
+/**
+ * Rozmiar bufora na linię z postępem zapisu w tle, mieszczący napis
+ * "SNAPSHOT ", dwie liczby 64-bitowe, spację, znak procentu i koniec linii.
+ */
+#define SAVE_PROGRESS_LINE_SIZE 64
+
+/**
+ * Liczba wczytanych linii, które w trybie potokowym mogą czekać
+ * na wykonanie.
+ */
+#define PIPELINE_CAPACITY 4096
+
+/**
+ * Struktura przechowująca linię wejścia przekazywaną w trybie potokowym
+ * przez wątek czytający wejście wątkowi wykonującemu polecenia.
+ */
+typedef struct {
+    command_t command;      ///< Polecenie, jeśli linia je zawiera.
+    uint32_t line;          ///< Numer linii.
+    input_line_kind kind;   ///< Rodzaj linii; pomijane linie nie są
+                            ///< przekazywane.
+} parsed_line;
+
+/**
+ * Kolejka linii wczytanych w trybie potokowym. Zasięg pliku, aby
+ * wątek czytający mógł ją udostępnić przed czekaniem na wejście.
+ */
+static ring_t *parsed_lines = NULL;
+
+/**
+ * Wskaźnik na wskaźnik na grę wykonującą polecenia, której dziennik ruchów
+ * jest zapisywany, zanim wątek wykonujący polecenia zacznie czekać
+ * na wejście.
+ */
+static gamma_t **waiting_game = NULL;
+
 /** @brief Sprawdza, czy podany wyraz symbolizuje poprawne polecenie.
  * Sprawdza, czy podany wyraz ma długość 1 oraz czy symbolizuje jedno z poleceń
  * (dane przez makra z prefixem CALL).
@@ -52,7 +137,10 @@
 static inline bool is_command_valid(char ch) {
     return (ch == CALL_GAMMA_BOARD || ch == CALL_GAMMA_BUSY_FIELDS
             || ch == CALL_GAMMA_FREE_FIELDS || ch == CALL_GAMMA_GOLDEN_MOVE
-            || ch == CALL_GAMMA_GOLDEN_POSSIBLE || ch == CALL_GAMMA_MOVE);
+            || ch == CALL_GAMMA_GOLDEN_POSSIBLE || ch == CALL_GAMMA_MOVE
+            || ch == CALL_GAMMA_SAVE || ch == CALL_GAMMA_LOAD
+            || ch == CALL_GAMMA_MAP || ch == CALL_GAMMA_BACKGROUND_SAVE
+            || ch == CALL_GAMMA_WAL_OPEN || ch == CALL_GAMMA_WAL_REPLAY);
 }
 
 /** @brief Sprawdza, czy ilość parametrów jest poprawna.
@@ -66,7 +154,7 @@ static bool is_parameter_count_correct(command_t *command) {
     int i = 0;
     long args[4] = {command->first_par, command->second_par,
                     command->third_par, command->fourth_par};
-    while(args[i] != BLANK_PARAMETER_NUMBER && i < 4) {
+    while(i < 4 && args[i] != BLANK_PARAMETER_NUMBER) {
         i++;
     }
     switch (command->type) {
@@ -75,9 +163,15 @@ static bool is_parameter_count_correct(command_t *command) {
         case CALL_GAMMA_GOLDEN_POSSIBLE:
         case CALL_GAMMA_FREE_FIELDS:
         case CALL_GAMMA_BUSY_FIELDS:
+        case CALL_GAMMA_SAVE:
+        case CALL_GAMMA_LOAD:
+        case CALL_GAMMA_MAP:
+        case CALL_GAMMA_BACKGROUND_SAVE:
+        case CALL_GAMMA_WAL_REPLAY:
             return i == 1;
         case CALL_GAMMA_GOLDEN_MOVE:
         case CALL_GAMMA_MOVE:
+        case CALL_GAMMA_WAL_OPEN:
             return i == 3;
         default:
             return false;
@@ -118,40 +212,201 @@ static inline bool are_parameters_correct(command_t *command) {
            are_parameters_in_bound(command);
 }
 
+/** @brief Zastępuje grę grą wczytaną z pliku.
+ * Wczytuje stan gry z pliku o deskryptorze @p fd. Jeśli się to powiedzie,
+ * usuwa dotychczasową grę, w przeciwnym wypadku gra pozostaje bez zmian.
+ * @param game_board        – wskaźnik na wskaźnik na strukturę gry,
+ * @param fd                – numer deskryptora pliku,
+ * @param load              – funkcja wczytująca grę, @ref gamma_load
+ *                            lub @ref gamma_map.
+ * @return Wartość @p true jeśli wczytano grę lub @p false w przeciwnym wypadku.
+ */
+static bool load_game(gamma_t **game_board, long fd, gamma_t *(*load)(int)) {
+    gamma_t *loaded = (fd <= INT_MAX) ? load(fd) : NULL;
+    if (loaded == NULL) {
+        return false;
+    }
+    gamma_delete(*game_board);
+    *game_board = loaded;
+    return true;
+}
+
+/** @brief Dopisuje liczbę przed początkiem napisu.
+ * Zamienia liczbę na cyfry od najmniej znaczącej, bez użycia printf.
+ * @param[in] begin         – wskaźnik na początek napisu, przed którym
+ *                            jest miejsce na cyfry liczby,
+ * @param[in] number        – liczba.
+ * @return Wskaźnik na pierwszą cyfrę liczby.
+ */
+static char *prepend_number(char *begin, uint64_t number) {
+    do {
+        *--begin = (char) ('0' + number % 10);
+        number /= 10;
+    } while (number > 0);
+    return begin;
+}
+
+/** @brief Wypisuje postęp zapisu w tle.
+ * Wypisuje na standardowe wyjście diagnostyczne procent zapisanych bajtów,
+ * gdy od poprzedniego wypisania wzrósł o co najmniej
+ * @ref BACKGROUND_SAVE_PROGRESS_STEP lub zapis się zakończył.
+ * Proces potomny rodzica z kilkoma wątkami może wywoływać jedynie funkcje
+ * bezpieczne w obsłudze sygnałów, a blokada strumienia stderr mogła zostać
+ * skopiowana jako zajęta, więc linia jest składana w lokalnym buforze
+ * i wypisywana jednym wywołaniem write.
+ * @param written           – liczba zapisanych bajtów,
+ * @param total             – rozmiar całego zapisu,
+ * @param data              – wskaźnik na ostatnio wypisany procent.
+ */
+static void print_save_progress(uint64_t written, uint64_t total, void *data) {
+    int *reported = data;
+    int percent = written * 100 / total;
+    if (percent >= *reported + BACKGROUND_SAVE_PROGRESS_STEP ||
+        (percent == 100 && *reported < 100)) {
+        *reported = percent;
+        static const char prefix[] = "SNAPSHOT ";
+        char line[SAVE_PROGRESS_LINE_SIZE];
+        char *end = line + SAVE_PROGRESS_LINE_SIZE;
+        char *begin = end - 2;
+        begin[0] = '%';
+        begin[1] = '\n';
+        begin = prepend_number(begin, percent);
+        *--begin = ' ';
+        begin = prepend_number(begin, getpid());
+        begin -= sizeof(prefix) - 1;
+        memcpy(begin, prefix, sizeof(prefix) - 1);
+        ssize_t written;
+        do {
+            written = write(STDERR_FILENO, begin, end - begin);
+        } while (written < 0 && errno == EINTR);
+    }
+}
+
+/** @brief Rozpoczyna zapis gry w tle.
+ * Tworzy proces potomny, który zapisuje grę do pliku o deskryptorze @p fd,
+ * wypisując postęp na standardowe wyjście diagnostyczne, i kończy się.
+ * Proces potomny widzi stan gry z chwili utworzenia dzięki kopiowaniu
+ * stron przy zapisie, więc rodzic może od razu wykonywać kolejne polecenia.
+ * @param game_board        – wskaźnik na strukturę gry,
+ * @param fd                – numer deskryptora pliku,
+ * @param background_save   – wskaźnik na identyfikator procesu zapisującego
+ *                            grę w tle lub 0, jeśli żaden nie działa.
+ * @return Wartość @p true jeśli rozpoczęto zapis lub @p false, jeśli inny
+ * zapis w tle jeszcze trwa albo nie udało się utworzyć procesu.
+ */
+static bool start_background_save(gamma_t *game_board, long fd,
+                                  pid_t *background_save) {
+    if (*background_save != 0 || fd > INT_MAX) {
+        return false;
+    }
+
+    // Bufory dziedziczone przez proces potomny muszą być puste.
+    flush_output();
+    pid_t pid = fork();
+    if (pid == 0) {
+        int reported = -BACKGROUND_SAVE_PROGRESS_STEP;
+        bool is_saved = gamma_save_progress(game_board, fd, print_save_progress,
+                                            &reported);
+        _exit(is_saved ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    else if (pid < 0) {
+        return false;
+    }
+    *background_save = pid;
+    return true;
+}
+
+/** @brief Sprawdza, czy zakończył się zapis w tle.
+ * Jeśli proces zapisujący grę w tle się zakończył, wypisuje
+ * na standardowe wyjście diagnostyczne, czy zapis się powiódł.
+ * @param background_save   – wskaźnik na identyfikator procesu zapisującego
+ *                            grę w tle lub 0, jeśli żaden nie działa,
+ * @param should_wait       – czy czekać na zakończenie procesu.
+ */
+static void finish_background_save(pid_t *background_save, bool should_wait) {
+    int status;
+    if (*background_save == 0 ||
+        waitpid(*background_save, &status, should_wait ? 0 : WNOHANG) <= 0) {
+        return;
+    }
+    bool is_saved = WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+    error_text("SNAPSHOT ");
+    error_number(*background_save);
+    error_text(is_saved ? " DONE\n" : " FAILED\n");
+    *background_save = 0;
+}
+
 /** @brief Wykonuje polecenie z podanymi parametrami.
  * Jeśli ilość parametrów jest poprawna,
  * wykonuje zadane w parametrze @p command polecenie.
- * @param game_board        – wskaźnik na strukturę gry,
- * @param command           – polecenie.
+ * Polecenia zapisu i wczytania gry przyjmują numer deskryptora
+ * pliku otwartego przez program wywołujący.
+ * @param game_board_pointer – wskaźnik na wskaźnik na strukturę gry,
+ * @param command            – polecenie,
+ * @param background_save    – wskaźnik na identyfikator procesu zapisującego
+ *                             grę w tle lub 0, jeśli żaden nie działa.
  * @return Wartość @p true jeśli ilość parametrów była prawidłowa
  * lub @p false w przeciwnym wypadku.
  */
-static bool execute_command(gamma_t *game_board, command_t *command) {
+static bool execute_command(gamma_t **game_board_pointer, command_t *command,
+                            pid_t *background_save) {
+    gamma_t *game_board = *game_board_pointer;
     bool params_ok = are_parameters_correct(command);
     if(params_ok) {
-        char *board;
         switch (command->type) {
             case CALL_GAMMA_BOARD:
-                board = gamma_board(game_board);
-                printf("%s", board);
-                free(board);
+                // Opis planszy trafia do wyjścia z pominięciem bufora wyjścia.
+                flush_output();
+                gamma_board_write(game_board, STDOUT_FILENO);
                 break;
             case CALL_GAMMA_GOLDEN_POSSIBLE:
-                printf("%i\n", gamma_golden_possible(game_board, command->first_par));
+                output_result(gamma_golden_possible(game_board,
+                                                    command->first_par));
                 break;
             case CALL_GAMMA_FREE_FIELDS:
-                printf("%lu\n", gamma_free_fields(game_board, command->first_par));
+                output_result(gamma_free_fields(game_board, command->first_par));
                 break;
             case CALL_GAMMA_BUSY_FIELDS:
-                printf("%lu\n", gamma_busy_fields(game_board, command->first_par));
+                output_result(gamma_busy_fields(game_board, command->first_par));
                 break;
             case CALL_GAMMA_GOLDEN_MOVE:
-                printf("%i\n", gamma_golden_move(game_board, command->first_par,
-                                            command->second_par, command->third_par));
+                output_result(gamma_golden_move(game_board, command->first_par,
+                                                command->second_par,
+                                                command->third_par));
                 break;
             case CALL_GAMMA_MOVE:
-                printf("%i\n", gamma_move(game_board, command->first_par,
-                                        command->second_par, command->third_par));
+                output_result(gamma_move(game_board, command->first_par,
+                                         command->second_par,
+                                         command->third_par));
+                break;
+            case CALL_GAMMA_SAVE:
+                // Zapis może trafić do tego samego pliku co wyjście.
+                flush_output();
+                output_result(command->first_par <= INT_MAX &&
+                              gamma_save(game_board, command->first_par));
+                break;
+            case CALL_GAMMA_LOAD:
+                output_result(load_game(game_board_pointer, command->first_par,
+                                        gamma_load));
+                break;
+            case CALL_GAMMA_MAP:
+                output_result(load_game(game_board_pointer, command->first_par,
+                                        gamma_map));
+                break;
+            case CALL_GAMMA_BACKGROUND_SAVE:
+                output_result(start_background_save(game_board,
+                                                    command->first_par,
+                                                    background_save));
+                break;
+            case CALL_GAMMA_WAL_OPEN:
+                output_result(command->first_par <= INT_MAX &&
+                              gamma_wal_open(game_board, command->first_par,
+                                             command->second_par,
+                                             command->third_par));
+                break;
+            case CALL_GAMMA_WAL_REPLAY:
+                output_result(command->first_par <= INT_MAX &&
+                              gamma_wal_replay(game_board, command->first_par));
                 break;
             default:
                 break;
@@ -164,17 +419,19 @@ static bool execute_command(gamma_t *game_board, command_t *command) {
 /** @brief Czyta i wykonuje polecenie ze standardowego wejścia.
  * Zczytuje z wejścia jedną linię. Jeśli polecenie jest poprawne,
  * wykonuje je. W przeciwnym wypadku wypisuje informację o błędzie.
- * @param[in,out] game_board    – struktura gry,
+ * @param[in,out] game_board    – wskaźnik na wskaźnik na strukturę gry,
  * @param[in] command           – polecenie,
- * @param[in,out] lines         – liczba linii wejścia do tej pory.
+ * @param[in,out] lines         – liczba linii wejścia do tej pory,
+ * @param[in,out] background_save – wskaźnik na identyfikator procesu
+ *                                zapisującego grę w tle lub 0.
  * @return Wartość @p true jeśli wczytanie komendy się powiodło
  * lub @p false jeśli zaszedł jakiś błąd.
  */
-static bool read_and_execute_command(gamma_t *game_board, command_t  *command,
-                                                            uint32_t *lines) {
+static bool read_and_execute_command(gamma_t **game_board, command_t  *command,
+                                     uint32_t *lines, pid_t *background_save) {
     (*lines)++;
     if(read_command(command, lines)) {
-        if(!execute_command(game_board, command)) {
+        if(!execute_command(game_board, command, background_save)) {
             print_error(*lines);
         }
         return true;
@@ -184,9 +441,101 @@ static bool read_and_execute_command(gamma_t *game_board, command_t  *command,
     }
 }
 
-void run_batch_mode(gamma_t *game_board, uint32_t *lines) {
+/** @brief Przygotowuje wykonywanie poleceń do czekania na wejście.
+ * Zapisuje ruchy oczekujące w dzienniku gry, bo ograniczenie czasu
+ * oczekiwania ruchu na zapis jest sprawdzane dopiero przy kolejnym ruchu,
+ * a następnie wypisuje wyniki dotychczasowych poleceń.
+ */
+static void prepare_for_waiting() {
+    // Gra bez dziennika nic nie zapisuje, a błąd zapisu pozostaje
+    // w dzienniku i jest zgłaszany przy jego zamknięciu.
+    gamma_wal_sync(*waiting_game);
+    flush_output();
+}
+
+void run_batch_mode(gamma_t **game_board, uint32_t *lines) {
     command_t curr_command;
-    while(read_and_execute_command(game_board, &curr_command, lines)) {
-        // Puste.
+    pid_t background_save = 0;
+    waiting_game = game_board;
+    set_before_read(prepare_for_waiting);
+    while(read_and_execute_command(game_board, &curr_command, lines,
+                                   &background_save)) {
+        finish_background_save(&background_save, false);
     }
-}
\ No newline at end of file
+    set_before_read(flush_output);
+    finish_background_save(&background_save, true);
+}
+
+/** @brief Udostępnia wątkowi wykonującemu polecenia wczytane linie.
+ * Wywoływana przez moduł wejścia, zanim wątek czytający zacznie
+ * czekać na dane.
+ */
+static void publish_parsed_lines() {
+    ring_publish(parsed_lines);
+}
+
+/** @brief Czyta i przetwarza wejście w osobnym wątku.
+ * Przekazuje do kolejki każdą linię z poleceniem i każdą niepoprawną
+ * linię wraz z jej numerem, a na końcu linię rodzaju @ref INPUT_END.
+ * @param[in] argument      – wskaźnik na liczbę linii wejścia
+ *                            przed uruchomieniem trybu.
+ * @return Wartość NULL.
+ */
+static void* parse_input(void *argument) {
+    parsed_line parsed;
+    parsed.line = *(uint32_t*) argument;
+    do {
+        parsed.line++;
+        parsed.kind = read_input_line(&parsed.command);
+        if(parsed.kind != INPUT_SKIPPED) {
+            ring_push(parsed_lines, &parsed);
+        }
+    } while(parsed.kind != INPUT_END);
+    ring_publish(parsed_lines);
+
+    return NULL;
+}
+
+void run_pipelined_batch_mode(gamma_t **game_board, uint32_t *lines) {
+    uint32_t first_line = *lines;
+    pthread_t parser;
+    parsed_lines = ring_new(PIPELINE_CAPACITY, sizeof(parsed_line));
+    set_before_read(publish_parsed_lines);
+    if(parsed_lines == NULL ||
+       pthread_create(&parser, NULL, parse_input, &first_line) != 0) {
+        set_before_read(flush_output);
+        ring_delete(parsed_lines);
+        parsed_lines = NULL;
+        run_batch_mode(game_board, lines);
+        return;
+    }
+    start_output_writer();
+
+    // Zanim wątek zaśnie w oczekiwaniu na kolejne polecenia, wyniki
+    // dotychczasowych muszą być widoczne, jak w zwykłym trybie wsadowym.
+    parsed_line parsed;
+    pid_t background_save = 0;
+    waiting_game = game_board;
+    ring_pop(parsed_lines, &parsed, prepare_for_waiting);
+    while(parsed.kind != INPUT_END) {
+        if(parsed.kind == INPUT_WRONG) {
+            print_error(parsed.line);
+        }
+        else {
+            if(!execute_command(game_board, &parsed.command,
+                                &background_save)) {
+                print_error(parsed.line);
+            }
+            finish_background_save(&background_save, false);
+        }
+        ring_pop(parsed_lines, &parsed, prepare_for_waiting);
+    }
+    *lines = parsed.line;
+
+    pthread_join(parser, NULL);
+    set_before_read(flush_output);
+    ring_delete(parsed_lines);
+    parsed_lines = NULL;
+    finish_background_save(&background_save, true);
+    stop_output_writer();
+}
@@ -14,9 +14,23 @@
 
 /** @brief Przeprowadza grę za pomocą trybu wsadowego.
  * Zczytuje z wejścia i wykonuje polecenia zgodne z zasadami trybu wsadowego.
- * @param[in,out] game_board  – struktura gry,
+ * Polecenie wczytania gry zastępuje grę wskazywaną przez @p game_board.
+ * Przed zakończeniem czeka na zakończenie trwającego zapisu gry w tle.
+ * @param[in,out] game_board  – wskaźnik na wskaźnik na strukturę gry,
  * @param[in,out] lines       – liczba linii wejścia przed uruchomieniem trybu.
  */
-void run_batch_mode(gamma_t *game_board, uint32_t *lines);
+void run_batch_mode(gamma_t **game_board, uint32_t *lines);
+
+/** @brief Przeprowadza grę za pomocą potokowego trybu wsadowego.
+ * Działa jak @ref run_batch_mode, ale wejście czyta i przetwarza osobny
+ * wątek, a wyjście zapisuje kolejny, więc wątek wykonujący polecenia
+ * zajmuje się tylko grą. Wyniki i komunikaty o błędach są wypisywane
+ * w tej samej kolejności i z tymi samymi numerami linii.
+ * Jeśli nie uda się utworzyć wątku czytającego, działa jak
+ * @ref run_batch_mode.
+ * @param[in,out] game_board  – wskaźnik na wskaźnik na strukturę gry,
+ * @param[in,out] lines       – liczba linii wejścia przed uruchomieniem trybu.
+ */
+void run_pipelined_batch_mode(gamma_t **game_board, uint32_t *lines);
 
 #endif //GAMMA_GAMMA_BATCH_MODE_H
@@ -0,0 +1,477 @@
+/** @file
+ * Pomiar czasu wykonywania złotych ruchów w silniku gry gamma
+ *
+ * @author Adam Boguszewski <ab417730@students.mimuw.edu.pl>
+ * @copyright Uniwersytet Warszawski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "gamma.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Liczba złotych ruchów wykonywanych na każdej planszy.
+ */
+#define GOLDEN_MOVES_COUNT 1000
+
+/**
+ * Odległość między środkami kolejnych krzyży na planszy.
+ */
+#define CROSS_SPACING 4
+
+/** @brief Podaje aktualny czas w nanosekundach.
+ * @return Czas zegara monotonicznego w nanosekundach.
+ */
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/** @brief Mierzy średni czas złotego ruchu na planszy danego rozmiaru.
+ * Gracz 1 stawia @ref GOLDEN_MOVES_COUNT krzyży złożonych z pięciu pól,
+ * a następnie każdy z kolejnych graczy wykonuje złoty ruch na środek
+ * jednego z krzyży, dzieląc go na cztery obszary. Każdy złoty ruch
+ * dotyka więc jedynie kilku pól, niezależnie od rozmiaru planszy.
+ * @param[in] size    – długość boku kwadratowej planszy.
+ * @return Średni czas złotego ruchu w nanosekundach lub 0,
+ * jeśli nie udało się utworzyć gry.
+ */
+static uint64_t measure_golden_move(uint32_t size) {
+    uint32_t per_row = (size - 2) / CROSS_SPACING;
+    gamma_t *g = gamma_new(size, size, GOLDEN_MOVES_COUNT + 1,
+                           4 * GOLDEN_MOVES_COUNT);
+    if (g == NULL || per_row == 0) {
+        gamma_delete(g);
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < GOLDEN_MOVES_COUNT; i++) {
+        uint32_t x = 1 + (i % per_row) * CROSS_SPACING;
+        uint32_t y = 1 + (i / per_row) * CROSS_SPACING;
+        gamma_move(g, 1, x, y);
+        gamma_move(g, 1, x + 1, y);
+        gamma_move(g, 1, x - 1, y);
+        gamma_move(g, 1, x, y + 1);
+        gamma_move(g, 1, x, y - 1);
+    }
+
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < GOLDEN_MOVES_COUNT; i++) {
+        uint32_t x = 1 + (i % per_row) * CROSS_SPACING;
+        uint32_t y = 1 + (i / per_row) * CROSS_SPACING;
+        if (!gamma_golden_move(g, i + 2, x, y)) {
+            fprintf(stderr, "golden move %u failed\n", i);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    gamma_delete(g);
+    return elapsed / GOLDEN_MOVES_COUNT;
+}
+
+/** @brief Mierzy średni czas złotego ruchu odcinającego pojedyncze pole.
+ * Gracz 1 zajmuje cały pierwszy wiersz planszy oraz co czwartą kolumnę
+ * w dwóch kolejnych wierszach, tworząc jeden obszar w kształcie grzebienia.
+ * Kolejni gracze wykonują złote ruchy na środkowe pola zębów,
+ * odcinając od ogromnego obszaru po jednym polu.
+ * @param[in] size    – długość boku kwadratowej planszy.
+ * @return Średni czas złotego ruchu w nanosekundach lub 0,
+ * jeśli nie udało się utworzyć gry.
+ */
+static uint64_t measure_splinter_golden_move(uint32_t size) {
+    uint32_t teeth = (size + CROSS_SPACING - 1) / CROSS_SPACING;
+    uint32_t moves = (teeth < GOLDEN_MOVES_COUNT) ? teeth : GOLDEN_MOVES_COUNT;
+    gamma_t *g = gamma_new(size, size, moves + 1, moves + 1);
+    if (g == NULL || size < 3) {
+        gamma_delete(g);
+        return 0;
+    }
+
+    for (uint32_t x = 0; x < size; x++) {
+        gamma_move(g, 1, x, 0);
+    }
+    for (uint32_t i = 0; i < moves; i++) {
+        gamma_move(g, 1, i * CROSS_SPACING, 1);
+        gamma_move(g, 1, i * CROSS_SPACING, 2);
+    }
+
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < moves; i++) {
+        if (!gamma_golden_move(g, i + 2, i * CROSS_SPACING, 1)) {
+            fprintf(stderr, "golden move %u failed\n", i);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    gamma_delete(g);
+    return elapsed / moves;
+}
+
+/** @brief Mierzy średni czas nielegalnego złotego ruchu.
+ * Gracz 1 tworzy taki sam grzebień jak w funkcji
+ * @ref measure_splinter_golden_move, ale może mieć tylko jeden obszar,
+ * więc próby złotego ruchu gracza 2 na środkowe pola zębów są nielegalne.
+ * @param[in] size    – długość boku kwadratowej planszy.
+ * @return Średni czas próby złotego ruchu w nanosekundach lub 0,
+ * jeśli nie udało się utworzyć gry.
+ */
+static uint64_t measure_illegal_golden_move(uint32_t size) {
+    uint32_t teeth = (size + CROSS_SPACING - 1) / CROSS_SPACING;
+    uint32_t moves = (teeth < GOLDEN_MOVES_COUNT) ? teeth : GOLDEN_MOVES_COUNT;
+    gamma_t *g = gamma_new(size, size, 2, 1);
+    if (g == NULL || size < 3) {
+        gamma_delete(g);
+        return 0;
+    }
+
+    for (uint32_t x = 0; x < size; x++) {
+        gamma_move(g, 1, x, 0);
+    }
+    for (uint32_t i = 0; i < moves; i++) {
+        gamma_move(g, 1, i * CROSS_SPACING, 1);
+        gamma_move(g, 1, i * CROSS_SPACING, 2);
+    }
+
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < moves; i++) {
+        if (gamma_golden_move(g, 2, i * CROSS_SPACING, 1)) {
+            fprintf(stderr, "golden move %u succeeded\n", i);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    gamma_delete(g);
+    return elapsed / moves;
+}
+
+/** @brief Rozgrywa losową partię i wypisuje statystyki sprawdzania podziałów.
+ * @ref GOLDEN_MOVES_COUNT graczy wykonuje losowe ruchy na planszy danego
+ * rozmiaru, a następnie każdy z nich próbuje złotych ruchów na losowe
+ * pola aż do skutku. Wypisywany jest średni czas jednej próby oraz
+ * odsetek sprawdzeń podziału obszaru rozstrzygniętych lokalnie.
+ * @param[in] size    – długość boku kwadratowej planszy.
+ */
+static void measure_random_play(uint32_t size) {
+    uint32_t players = GOLDEN_MOVES_COUNT;
+    gamma_t *g = gamma_new(size, size, players, size * size / 16);
+    if (g == NULL) {
+        return;
+    }
+
+    srand(size);
+    uint64_t moves = (uint64_t) size * size;
+    for (uint64_t i = 0; i < moves; i++) {
+        gamma_move(g, 1 + rand() % players, rand() % size, rand() % size);
+    }
+
+    uint64_t attempts = 0;
+    uint64_t start = now_ns();
+    for (uint32_t player = 1; player <= players; player++) {
+        do {
+            attempts++;
+        } while (!gamma_golden_move(g, player, rand() % size, rand() % size) &&
+                 gamma_golden_possible(g, player));
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    uint64_t checks, resolved_locally;
+    gamma_split_check_stats(g, &checks, &resolved_locally);
+    printf("%5ux%-5u random play: %lu ns per golden move attempt, "
+           "%lu/%lu split checks resolved locally\n", size, size,
+           elapsed / attempts, resolved_locally, checks);
+
+    gamma_delete(g);
+}
+
+/** @brief Mierzy średni czas wykonania i cofnięcia ruchu.
+ * Na planszy danego rozmiaru, częściowo zapełnionej losowymi ruchami
+ * czterech graczy, wykonuje losowe ruchy i złote ruchy, cofając każdy
+ * udany ruch funkcją @ref gamma_undo, tak jak robi to program
+ * przeszukujący drzewo gry.
+ * @param[in] size    – długość boku kwadratowej planszy.
+ * @return Średni czas pary ruch i cofnięcie w nanosekundach lub 0,
+ * jeśli nie udało się utworzyć gry.
+ */
+static uint64_t measure_make_unmake(uint32_t size) {
+    uint32_t players = 4;
+    gamma_t *g = gamma_new(size, size, players, size * size / 16);
+    if (g == NULL || !gamma_undo_enable(g, true)) {
+        gamma_delete(g);
+        return 0;
+    }
+
+    srand(size);
+    uint64_t moves = (uint64_t) size * size / 2;
+    for (uint64_t i = 0; i < moves; i++) {
+        gamma_move(g, 1 + rand() % players, rand() % size, rand() % size);
+    }
+
+    uint64_t undone = 0;
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < 100 * GOLDEN_MOVES_COUNT; i++) {
+        uint32_t player = 1 + rand() % players;
+        uint32_t x = rand() % size;
+        uint32_t y = rand() % size;
+        bool moved = (i % 2 == 0) ? gamma_move(g, player, x, y)
+                                  : gamma_golden_move(g, player, x, y);
+        if (moved && gamma_undo(g)) {
+            undone++;
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    gamma_delete(g);
+    return (undone == 0) ? 0 : elapsed / undone;
+}
+
+/** @brief Mierzy średni czas ruchu na ogromnej, rzadkiej planszy.
+ * Na planszy o boku miliona pól, przechowywanej jako rzadka, czterech
+ * graczy wykonuje losowe ruchy w kwadracie o danym boku, a następnie
+ * próbuje złotych ruchów na losowe pola tego kwadratu.
+ * @param[in] size    – długość boku kwadratu, w którym wykonywane są ruchy.
+ * @return Średni czas ruchu lub złotego ruchu w nanosekundach lub 0,
+ * jeśli nie udało się utworzyć gry.
+ */
+static uint64_t measure_sparse_play(uint32_t size) {
+    uint32_t players = 4;
+    uint32_t side = 1000000;
+    gamma_t *g = gamma_new(side, side, players, size * size / 16);
+    if (g == NULL) {
+        return 0;
+    }
+
+    srand(size);
+    uint32_t offset = side / 2;
+    uint64_t moves = (uint64_t) size * size;
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < moves; i++) {
+        uint32_t player = 1 + rand() % players;
+        uint32_t x = offset + rand() % size;
+        uint32_t y = offset + rand() % size;
+        if (i % 16 == 0) {
+            gamma_golden_move(g, player, x, y);
+        }
+        else {
+            gamma_move(g, player, x, y);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    gamma_delete(g);
+    return elapsed / moves;
+}
+
+/** @brief Mierzy średni czas utworzenia kopii gry i kilku ruchów w kopii.
+ * Na planszy danego rozmiaru wykonuje losowe ruchy, a następnie
+ * wielokrotnie tworzy kopię gry, wykonuje w niej dziesięć losowych ruchów
+ * i usuwa ją, tak jak wątek przeszukujący drzewo gry.
+ * @param[in] size    – długość boku kwadratowej planszy.
+ * @return Średni czas utworzenia, dziesięciu ruchów i usunięcia kopii
+ * w nanosekundach lub 0, jeśli nie udało się utworzyć gry.
+ */
+static uint64_t measure_clone(uint32_t size) {
+    uint32_t players = 4;
+    gamma_t *g = gamma_new(size, size, players, size * size / 16);
+    if (g == NULL) {
+        return 0;
+    }
+
+    srand(size);
+    uint64_t moves = (uint64_t) size * size / 2;
+    for (uint64_t i = 0; i < moves; i++) {
+        gamma_move(g, 1 + rand() % players, rand() % size, rand() % size);
+    }
+
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < GOLDEN_MOVES_COUNT; i++) {
+        gamma_t *copy = gamma_clone(g);
+        if (copy == NULL) {
+            gamma_delete(g);
+            return 0;
+        }
+        for (uint32_t j = 0; j < 10; j++) {
+            gamma_move(copy, 1 + rand() % players, rand() % size, rand() % size);
+        }
+        gamma_delete(copy);
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    gamma_delete(g);
+    return elapsed / GOLDEN_MOVES_COUNT;
+}
+
+/** @brief Mierzy czas utworzenia i usunięcia gry.
+ * Tworzy grę na planszy danego rozmiaru, wykonuje na niej jeden ruch
+ * i ją usuwa, tak jak krótka partia w trybie wsadowym.
+ * @param[in] size    – długość boku kwadratowej planszy.
+ * @return Czas utworzenia, ruchu i usunięcia gry w nanosekundach lub 0,
+ * jeśli nie udało się utworzyć gry.
+ */
+static uint64_t measure_new(uint32_t size) {
+    uint64_t start = now_ns();
+    gamma_t *g = gamma_new(size, size, 4, 1);
+    if (g == NULL) {
+        return 0;
+    }
+    gamma_move(g, 1, size / 2, size / 2);
+    gamma_delete(g);
+    return now_ns() - start;
+}
+
+/** @brief Mierzy czas zapisu i wczytania gry.
+ * Na planszy danego rozmiaru wykonuje losowe ruchy, zapisuje grę
+ * do pliku tymczasowego funkcją @ref gamma_save i wczytuje ją podaną funkcją.
+ * @param[in] size    – długość boku kwadratowej planszy,
+ * @param[in] load    – funkcja wczytująca grę, @ref gamma_load
+ *                      lub @ref gamma_map.
+ * @return Czas zapisu i wczytania w nanosekundach lub 0,
+ * jeśli nie udało się utworzyć, zapisać lub wczytać gry.
+ */
+static uint64_t measure_save_load(uint32_t size, gamma_t *(*load)(int)) {
+    uint32_t players = 4;
+    gamma_t *g = gamma_new(size, size, players, size * size / 16);
+    FILE *file = tmpfile();
+    if (g == NULL || file == NULL) {
+        gamma_delete(g);
+        return 0;
+    }
+
+    srand(size);
+    uint64_t moves = (uint64_t) size * size / 2;
+    for (uint64_t i = 0; i < moves; i++) {
+        gamma_move(g, 1 + rand() % players, rand() % size, rand() % size);
+    }
+
+    uint64_t start = now_ns();
+    bool is_saved = gamma_save(g, fileno(file));
+    gamma_t *loaded = NULL;
+    if (is_saved && lseek(fileno(file), 0, SEEK_SET) == 0) {
+        loaded = load(fileno(file));
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    fclose(file);
+    gamma_delete(g);
+    gamma_delete(loaded);
+    return (loaded == NULL) ? 0 : elapsed;
+}
+
+/** @brief Mierzy średni czas przejścia do losowego ruchu zapisu rozgrywki.
+ * Zapisuje losową rozgrywkę na planszy danego rozmiaru, z kopią stanu
+ * co tysiąc ruchów, a następnie przechodzi do losowych ruchów. Losowe ruchy
+ * zmieniają większość kafelków planszy między kolejnymi kopiami stanu, więc
+ * jest to najgorszy przypadek dla zajmowanej pamięci.
+ * @param[in] size    – długość boku kwadratowej planszy.
+ * @return Średni czas przejścia w nanosekundach lub 0,
+ * jeśli nie udało się utworzyć zapisu.
+ */
+static uint64_t measure_replay_seek(uint32_t size) {
+    uint32_t players = 4;
+    gamma_replay_t *replay = gamma_replay_new(size, size, players,
+                                              size * size / 16, 1000);
+    if (replay == NULL) {
+        return 0;
+    }
+
+    srand(size);
+    uint64_t moves = (uint64_t) size * size / 2;
+    for (uint64_t i = 0; i < moves; i++) {
+        gamma_replay_move(replay, 1 + rand() % players, rand() % size,
+                          rand() % size);
+    }
+
+    uint64_t length = gamma_replay_length(replay);
+    uint64_t seeks = 1000;
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < seeks; i++) {
+        gamma_replay_seek(replay, rand() % (length + 1));
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    gamma_replay_delete(replay);
+    return elapsed / seeks;
+}
+
+/** @brief Mierzy średni czas ruchu połączonego z pobraniem opisu planszy.
+ * Na przemian wykonuje losowy ruch i pobiera opis planszy, tak jak robi to
+ * tryb wsadowy dla ciągu poleceń m i p.
+ * @param[in] size    – długość boku kwadratowej planszy,
+ * @param[in] view    – @p true, jeśli opis ma być pobierany funkcją
+ *                      @ref gamma_board_view, a @p false, jeśli funkcją
+ *                      @ref gamma_board.
+ * @return Średni czas ruchu i pobrania opisu w nanosekundach.
+ */
+static uint64_t measure_board(uint32_t size, bool view) {
+    uint32_t players = 4;
+    gamma_t *g = gamma_new(size, size, players, size * size);
+    srand(size);
+    uint64_t rounds = 200;
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < rounds; i++) {
+        gamma_move(g, 1 + rand() % players, rand() % size, rand() % size);
+        if (view) {
+            gamma_board_view(g);
+        }
+        else {
+            free(gamma_board(g));
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    gamma_delete(g);
+    return elapsed / rounds;
+}
+
+/** @brief Uruchamia pomiary.
+ * Wypisuje średni czas złotego ruchu dla plansz coraz większych rozmiarów
+ * oraz wyniki losowych rozgrywek.
+ * @return Zero.
+ */
+int main() {
+    uint32_t sizes[] = {200, 1000, 4000, 10000};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        printf("%5ux%-5u new game: %lu ns\n", sizes[i], sizes[i],
+               measure_new(sizes[i]));
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        printf("%5ux%-5u golden move: %lu ns\n", sizes[i], sizes[i],
+               measure_golden_move(sizes[i]));
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        printf("%5ux%-5u splinter golden move: %lu ns\n", sizes[i], sizes[i],
+               measure_splinter_golden_move(sizes[i]));
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        printf("%5ux%-5u illegal golden move: %lu ns\n", sizes[i], sizes[i],
+               measure_illegal_golden_move(sizes[i]));
+    }
+    printf("  200x200   move and undo: %lu ns\n", measure_make_unmake(200));
+    printf(" 1000x1000  move and undo: %lu ns\n", measure_make_unmake(1000));
+    printf("  200x200   clone and 10 moves: %lu ns\n", measure_clone(200));
+    printf(" 1000x1000  clone and 10 moves: %lu ns\n", measure_clone(1000));
+    printf(" 1000x1000  save and load: %lu ns\n",
+           measure_save_load(1000, gamma_load));
+    printf(" 4000x4000  save and load: %lu ns\n",
+           measure_save_load(4000, gamma_load));
+    printf(" 1000x1000  save and map: %lu ns\n",
+           measure_save_load(1000, gamma_map));
+    printf(" 4000x4000  save and map: %lu ns\n",
+           measure_save_load(4000, gamma_map));
+    printf(" 1000x1000  move and board copy: %lu ns\n",
+           measure_board(1000, false));
+    printf(" 1000x1000  move and board view: %lu ns\n",
+           measure_board(1000, true));
+    printf("  500x500   replay seek: %lu ns\n", measure_replay_seek(500));
+    printf("  200x200   moves on a sparse board: %lu ns\n",
+           measure_sparse_play(200));
+    measure_random_play(200);
+    measure_random_play(1000);
+
+    return 0;
+}
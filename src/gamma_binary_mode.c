@@ -0,0 +1,92 @@
+/** @file
+ * Implementacja binarnego trybu wsadowego gry gamma.
+ *
+ * @author Adam Boguszewski <ab417730@students.mimuw.edu.pl>
+ * @copyright Uniwersytet Warszawski
+ * @date 5.05.2020
+ */
+
+#include "gamma_binary_mode.h"
+#include <stdint.h>
+#include <stddef.h>
+#include "gamma_input.h"
+#include "gamma_output.h"
+
+/**
+ * Kod polecenia wywołującego funkcję @ref gamma_move.
+ */
+#define OPCODE_MOVE 'm'
+
+/**
+ * Kod polecenia wywołującego funkcję @ref gamma_golden_move.
+ */
+#define OPCODE_GOLDEN_MOVE 'g'
+
+/**
+ * Kod polecenia wywołującego funkcję @ref gamma_busy_fields.
+ */
+#define OPCODE_BUSY_FIELDS 'b'
+
+/**
+ * Kod polecenia wywołującego funkcję @ref gamma_free_fields.
+ */
+#define OPCODE_FREE_FIELDS 'f'
+
+/**
+ * Kod polecenia wywołującego funkcję @ref gamma_golden_possible.
+ */
+#define OPCODE_GOLDEN_POSSIBLE 'q'
+
+/** @brief Odczytuje liczbę zapisaną w kolejności little-endian.
+ * @param[in] bytes         – wskaźnik na 4 bajty liczby.
+ * @return Odczytana liczba.
+ */
+static inline uint32_t read_le32(const char *bytes) {
+    const unsigned char *b = (const unsigned char*) bytes;
+    return (uint32_t) b[0] | (uint32_t) b[1] << 8 |
+           (uint32_t) b[2] << 16 | (uint32_t) b[3] << 24;
+}
+
+/** @brief Wykonuje polecenie zapisane w rekordzie.
+ * @param[in,out] game_board  – wskaźnik na strukturę gry,
+ * @param[in] record          – rekord polecenia.
+ * @return Wynik polecenia lub @ref BINARY_RESULT_ERROR, jeśli kod
+ * polecenia jest nieznany.
+ */
+static uint64_t execute_record(gamma_t *game_board, const char *record) {
+    uint32_t player = read_le32(record + 4);
+    uint32_t x = read_le32(record + 8);
+    uint32_t y = read_le32(record + 12);
+    switch (read_le32(record)) {
+        case OPCODE_MOVE:
+            return gamma_move(game_board, player, x, y);
+        case OPCODE_GOLDEN_MOVE:
+            return gamma_golden_move(game_board, player, x, y);
+        case OPCODE_BUSY_FIELDS:
+            return gamma_busy_fields(game_board, player);
+        case OPCODE_FREE_FIELDS:
+            return gamma_free_fields(game_board, player);
+        case OPCODE_GOLDEN_POSSIBLE:
+            return gamma_golden_possible(game_board, player);
+        default:
+            return BINARY_RESULT_ERROR;
+    }
+}
+
+void run_binary_mode(gamma_t *game_board) {
+    const char *records;
+    size_t count;
+    // Wyniki są zapisywane dopiero przed czekaniem na kolejne rekordy,
+    // więc cała porcja wejścia dostaje odpowiedź jednym zapisem.
+    while(read_input_records(&records, &count, BINARY_COMMAND_SIZE)) {
+        for(size_t i = 0; i < count; i++) {
+            uint64_t result = execute_record(game_board,
+                                             records + i * BINARY_COMMAND_SIZE);
+            char bytes[BINARY_RESULT_SIZE];
+            for(int j = 0; j < BINARY_RESULT_SIZE; j++) {
+                bytes[j] = (char) (result >> (8 * j));
+            }
+            output_data(bytes, BINARY_RESULT_SIZE);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+/** @file
+ * Interfejs binarnego trybu wsadowego gry gamma.
+ *
+ * @author Adam Boguszewski <ab417730@students.mimuw.edu.pl>
+ * @copyright Uniwersytet Warszawski
+ * @date 5.05.2020
+ */
+#ifndef GAMMA_GAMMA_BINARY_MODE_H
+#define GAMMA_GAMMA_BINARY_MODE_H
+
+#include "gamma.h"
+
+/**
+ * Rozmiar rekordu polecenia w bajtach: cztery liczby typu uint32_t
+ * zapisane w kolejności little-endian – kod polecenia, numer gracza
+ * oraz współrzędne x i y.
+ */
+#define BINARY_COMMAND_SIZE 16
+
+/**
+ * Rozmiar rekordu wyniku w bajtach: liczba typu uint64_t zapisana
+ * w kolejności little-endian.
+ */
+#define BINARY_RESULT_SIZE 8
+
+/**
+ * Wynik polecenia o nieznanym kodzie.
+ */
+#define BINARY_RESULT_ERROR UINT64_MAX
+
+/** @brief Przeprowadza grę za pomocą binarnego trybu wsadowego.
+ * Czyta z wejścia rekordy poleceń i na każdy odpowiada rekordem wyniku.
+ * Kodami poleceń są znaki poleceń trybu wsadowego: 'm', 'g', 'b', 'f'
+ * i 'q'; polecenia jednoargumentowe ignorują współrzędne. Wszystkie
+ * rekordy dostępne naraz na wejściu są wykonywane, zanim wyniki zostaną
+ * zapisane. Niepełny rekord na końcu wejścia jest pomijany.
+ * @param[in,out] game_board  – wskaźnik na strukturę gry.
+ */
+void run_binary_mode(gamma_t *game_board);
+
+#endif //GAMMA_GAMMA_BINARY_MODE_H
@@ -7,126 +7,629 @@
  */
 
 #include "gamma_field.h"
-#include <errno.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
 
 /**
- * Struktura przechowująca dane o elemencie kolejki elementów typu gamma_field.
+ * Struktura reprezentująca kolejkę indeksów pól.
+ * Elementy są przechowywane w tablicy o stałym rozmiarze, zaalokowanej
+ * przy tworzeniu kolejki, więc operacje na kolejce nie alokują pamięci.
+ * Gdy kolejka staje się pusta, zapis zaczyna się znów od początku tablicy.
  */
-typedef struct queueelement{
-    struct queueelement *next; ///< Następny element.
-    gamma_field *field;        ///< Pole na planszy.
-} queue_element;
+typedef struct fieldqueue{
+    uint32_t *elements;     ///< Tablica elementów kolejki.
+    uint64_t capacity;      ///< Rozmiar tablicy @p elements.
+    uint64_t front;         ///< Indeks pierwszego elementu kolejki.
+    uint64_t end;           ///< Indeks za ostatnim elementem kolejki.
+} field_queue;
+
+const gamma_field FREE_FIELD = {0, FIELD_SINGLE_ROOT};
 
 /**
- * Struktura reprezentująca kolejkę obiektów typu gamma_field.
+ * Logarytm dwójkowy początkowej liczby miejsc w mapie.
  */
-typedef struct fieldqueue{
-    queue_element *front;   ///< Wskaźnik na pierwszy element kolejki.
-    queue_element *end;     ///< Wskaźnik na ostatni element kolejki.
-} field_queue;
+#define FIELD_MAP_MIN_CAPACITY_LOG 6
 
+/**
+ * Stała mnożenia w funkcji skrótu mapy, część ułamkowa złotej proporcji.
+ */
+#define FIELD_MAP_HASH_MULTIPLIER 0x9E3779B97F4A7C15u
 
-void field_queue_init(field_queue **q) {
-    *q = malloc(sizeof(field_queue));
-    if(*q == NULL) {
-        errno = ENOMEM;
-        exit(EXIT_FAILURE);
+/**
+ * Struktura przechowująca jeden klucz mapy wraz z wartością.
+ */
+typedef struct {
+    uint64_t key;           ///< Numer komórki powiększony o 1
+                            ///< lub 0 dla wolnego miejsca.
+    uint32_t value;         ///< Wartość przypisana kluczowi.
+} field_map_entry;
+
+/**
+ * Struktura reprezentująca mapę z numerów komórek w indeksy pól.
+ * Klucze są przechowywane w tablicy z adresowaniem otwartym i liniowym
+ * próbkowaniem, podwajanej, gdy zajęta jest połowa miejsc.
+ * Usunięcie klucza przesuwa wstecz następujące po nim klucze,
+ * więc mapa nie zawiera znaczników usuniętych miejsc.
+ */
+typedef struct fieldmap{
+    field_map_entry *entries;   ///< Tablica miejsc mapy.
+    uint64_t capacity;          ///< Rozmiar tablicy @p entries, potęga dwójki.
+    uint64_t count;             ///< Liczba kluczy w mapie.
+    uint32_t shift;             ///< Liczba bitów skrótu pomijanych przy
+                                ///< wyznaczaniu miejsca klucza.
+} field_map;
+
+/**
+ * Struktura reprezentująca plik odwzorowany w pamięci, współdzielony
+ * przez tablicę pól i jej kopie.
+ */
+typedef struct fieldmapping{
+    atomic_uint references; ///< Liczba tablic pól korzystających z obszaru.
+    char *address;          ///< Początek odwzorowanego obszaru.
+    size_t size;            ///< Rozmiar obszaru w bajtach.
+} field_mapping;
+
+/**
+ * Najmniejsza liczba zmian, jaką mieści zaalokowany dziennik zmian pól.
+ */
+#define FIELD_JOURNAL_MIN_CAPACITY 64
+
+/**
+ * Struktura reprezentująca dziennik zmian pól.
+ * Zmiany są przechowywane w tablicy, która jest podwajana po zapełnieniu.
+ */
+typedef struct fieldjournal{
+    field_change *changes;  ///< Tablica zapisanych zmian.
+    uint64_t capacity;      ///< Rozmiar tablicy @p changes.
+    uint64_t count;         ///< Liczba zapisanych zmian.
+    bool has_failed;        ///< Czy nie udało się zapisać którejś zmiany.
+} field_journal;
+
+/** @brief Tworzy kafelek z domyślnymi wartościami pól.
+ * Każde pole kafelka nie należy do żadnego gracza, jest korzeniem
+ * jednoelementowego zbioru i ma przypisany węzeł o swoim indeksie,
+ * co odpowiada wyzerowanej pamięci.
+ * @return Wskaźnik na kafelek, do którego odwołuje się jedna tablica,
+ * lub @p NULL, jeśli alokacja się nie powiodła.
+ */
+static field_tile *new_field_tile(void) {
+    field_tile *tile = calloc(1, sizeof(field_tile));
+    if (tile == NULL) {
+        return NULL;
     }
 
-    (*q)->front = NULL;
-    (*q)->end = NULL;
+    atomic_init(&tile->references, 1);
+    return tile;
 }
 
-void field_queue_push(field_queue *q, gamma_field *element) {
-    if(q != NULL) {
-        queue_element *el = malloc(sizeof(queue_element));
-        if(el == NULL) {
-            field_queue_clear(&q);
-            errno = ENOMEM;
-            exit(EXIT_FAILURE);
+/** @brief Sprawdza, czy kafelek leży w odwzorowanym pliku.
+ * @param[in] mapping   – wskaźnik na odwzorowany plik lub NULL,
+ * @param[in] tile      – wskaźnik na kafelek.
+ * @return Wartość @p true, jeśli kafelek leży w obszarze @p mapping,
+ * lub @p false w przeciwnym wypadku.
+ */
+static inline bool is_tile_mapped(const field_mapping *mapping,
+                                  const field_tile *tile) {
+    const char *address = (const char *) tile;
+    return (mapping != NULL && address >= mapping->address &&
+            address < mapping->address + mapping->size);
+}
+
+/** @brief Zwalnia odwołanie do kafelka.
+ * Zwalnia pamięć kafelka, jeśli nie odwołuje się do niego
+ * już żadna tablica pól, chyba że kafelek leży w odwzorowanym pliku.
+ * @param[in] board     – wskaźnik na strukturę tablicy pól,
+ * @param[in,out] tile  – wskaźnik na kafelek.
+ */
+static void release_field_tile(const field_board *board, field_tile *tile) {
+    if (atomic_fetch_sub_explicit(&tile->references, 1,
+                                  memory_order_acq_rel) == 1 &&
+        !is_tile_mapped(board->mapping, tile)) {
+        free(tile);
+    }
+}
+
+bool field_board_init(field_board *board, uint64_t capacity) {
+    board->tiles_count = (capacity + FIELD_TILE_SIZE - 1) >> FIELD_TILE_SHIFT;
+    board->tiles = calloc(board->tiles_count, sizeof(field_tile *));
+    board->mapping = NULL;
+    return board->tiles != NULL;
+}
+
+bool field_board_clone(field_board *copy, const field_board *board) {
+    copy->tiles = malloc(board->tiles_count * sizeof(field_tile *));
+    if (copy->tiles == NULL) {
+        return false;
+    }
+
+    copy->tiles_count = board->tiles_count;
+    copy->mapping = board->mapping;
+    if (copy->mapping != NULL) {
+        atomic_fetch_add_explicit(&copy->mapping->references, 1,
+                                  memory_order_relaxed);
+    }
+    for (uint64_t i = 0; i < board->tiles_count; i++) {
+        copy->tiles[i] = board->tiles[i];
+        if (copy->tiles[i] != NULL) {
+            atomic_fetch_add_explicit(&copy->tiles[i]->references, 1,
+                                      memory_order_relaxed);
         }
+    }
+    return true;
+}
+
+bool field_board_attach_mapping(field_board *board, void *address, size_t size) {
+    board->mapping = malloc(sizeof(field_mapping));
+    if (board->mapping == NULL) {
+        return false;
+    }
+
+    atomic_init(&board->mapping->references, 1);
+    board->mapping->address = address;
+    board->mapping->size = size;
+    return true;
+}
+
+/** @brief Przygotowuje kafelek do zapisu.
+ * Alokuje kafelek o indeksie @p tile, jeśli nie był zaalokowany,
+ * lub kopiuje go, jeśli jest współdzielony z inną tablicą.
+ * @param[in,out] board  – wskaźnik na strukturę tablicy pól,
+ * @param[in] tile       – indeks kafelka.
+ * @return Wartość @p true, jeśli do kafelka można pisać, lub @p false,
+ * jeśli alokacja się nie powiodła, wtedy tablica pozostaje bez zmian.
+ */
+static bool own_field_tile(field_board *board, uint64_t tile) {
+    field_tile *shared = board->tiles[tile];
+    if (shared != NULL &&
+        atomic_load_explicit(&shared->references, memory_order_acquire) == 1) {
+        return true;
+    }
 
-        el->field = element;
-        el->next = NULL;
-        if(q->front == NULL) {
-            q->front = el;
+    field_tile *own = new_field_tile();
+    if (own == NULL) {
+        return false;
+    }
+    if (shared != NULL) {
+        memcpy(own->fields, shared->fields, sizeof(own->fields));
+        release_field_tile(board, shared);
+    }
+    board->tiles[tile] = own;
+    return true;
+}
+
+bool field_board_reserve(field_board *board, uint64_t first, uint64_t count) {
+    if (count == 0) {
+        return true;
+    }
+
+    uint64_t last = (first + count - 1) >> FIELD_TILE_SHIFT;
+    for (uint64_t i = first >> FIELD_TILE_SHIFT; i <= last; i++) {
+        if (!own_field_tile(board, i)) {
+            return false;
         }
-        else {
-            (q->end)->next = el;
+    }
+    return true;
+}
+
+bool field_board_reserve_allocated(field_board *board) {
+    for (uint64_t i = 0; i < board->tiles_count; i++) {
+        if (board->tiles[i] != NULL && !own_field_tile(board, i)) {
+            return false;
         }
-        q->end = el;
     }
+    return true;
 }
 
-gamma_field* field_queue_pop(field_queue *q) {
-    if(q != NULL) {
-        gamma_field *el = (q->front)->field;
-        queue_element *temp = q->front;
-        (q->front) = temp->next;
-        free(temp);
-        if(q->front == NULL) {
-            q->end = NULL;
+bool field_board_reserve_path(field_board *board, uint32_t index) {
+    // Ścieżka dłuższa od liczby węzłów musi zawierać cykl.
+    uint64_t capacity = board->tiles_count << FIELD_TILE_SHIFT;
+    for (uint64_t steps = 0; steps < capacity && index < capacity; steps++) {
+        if (!own_field_tile(board, index >> FIELD_TILE_SHIFT)) {
+            return false;
         }
-        return el;
+
+        const gamma_field *field = field_board_get(board, index);
+        if (is_field_root(field)) {
+            return true;
+        }
+        index = field->parent & ~FIELD_PARENT_FLAG;
     }
-    else {
-        return NULL;
+    return false;
+}
+
+bool field_board_grow(field_board *board, uint64_t capacity) {
+    uint64_t tiles_count = (capacity + FIELD_TILE_SIZE - 1) >> FIELD_TILE_SHIFT;
+    if (tiles_count <= board->tiles_count) {
+        return true;
+    }
+
+    field_tile **tiles = realloc(board->tiles, tiles_count * sizeof(field_tile *));
+    if (tiles == NULL) {
+        return false;
+    }
+    for (uint64_t i = board->tiles_count; i < tiles_count; i++) {
+        tiles[i] = NULL;
+    }
+    board->tiles = tiles;
+    board->tiles_count = tiles_count;
+    return true;
+}
+
+void field_board_clear(field_board *board) {
+    for (uint64_t i = 0; i < board->tiles_count; i++) {
+        if (board->tiles[i] != NULL) {
+            release_field_tile(board, board->tiles[i]);
+        }
+    }
+    free(board->tiles);
+    board->tiles = NULL;
+    board->tiles_count = 0;
+
+    field_mapping *mapping = board->mapping;
+    if (mapping != NULL && atomic_fetch_sub_explicit(&mapping->references, 1,
+                                                     memory_order_acq_rel) == 1) {
+        munmap(mapping->address, mapping->size);
+        free(mapping);
     }
+    board->mapping = NULL;
+}
+
+/** @brief Wyznacza pierwsze miejsce, w którym może znajdować się klucz.
+ * @param[in] m         – wskaźnik na strukturę mapy,
+ * @param[in] key       – numer komórki powiększony o 1.
+ * @return Indeks miejsca w tablicy @p entries.
+ */
+static inline uint64_t field_map_slot(const field_map *m, uint64_t key) {
+    return (key * FIELD_MAP_HASH_MULTIPLIER) >> m->shift;
+}
+
+/** @brief Umieszcza klucz w tablicy miejsc mapy.
+ * W tablicy musi być wolne miejsce, a klucza nie może w niej być.
+ * @param[in,out] m     – wskaźnik na strukturę mapy,
+ * @param[in] key       – numer komórki powiększony o 1,
+ * @param[in] value     – wartość przypisywana kluczowi.
+ */
+static void field_map_place(field_map *m, uint64_t key, uint32_t value) {
+    uint64_t slot = field_map_slot(m, key);
+    while (m->entries[slot].key != 0) {
+        slot = (slot + 1) & (m->capacity - 1);
+    }
+    m->entries[slot].key = key;
+    m->entries[slot].value = value;
+}
+
+bool field_map_init(field_map **m) {
+    *m = malloc(sizeof(field_map));
+    if (*m == NULL) {
+        return false;
+    }
+
+    (*m)->capacity = (uint64_t) 1 << FIELD_MAP_MIN_CAPACITY_LOG;
+    (*m)->entries = calloc((*m)->capacity, sizeof(field_map_entry));
+    if ((*m)->entries == NULL) {
+        free(*m);
+        *m = NULL;
+        return false;
+    }
+    (*m)->count = 0;
+    (*m)->shift = 64 - FIELD_MAP_MIN_CAPACITY_LOG;
+    return true;
+}
+
+bool field_map_clone(field_map **copy, const field_map *m) {
+    *copy = malloc(sizeof(field_map));
+    if (*copy == NULL) {
+        return false;
+    }
+
+    (*copy)->entries = malloc(m->capacity * sizeof(field_map_entry));
+    if ((*copy)->entries == NULL) {
+        free(*copy);
+        *copy = NULL;
+        return false;
+    }
+    memcpy((*copy)->entries, m->entries, m->capacity * sizeof(field_map_entry));
+    (*copy)->capacity = m->capacity;
+    (*copy)->count = m->count;
+    (*copy)->shift = m->shift;
+    return true;
+}
+
+uint32_t field_map_find(const field_map *m, uint64_t key) {
+    key++;
+    uint64_t slot = field_map_slot(m, key);
+    while (m->entries[slot].key != 0) {
+        if (m->entries[slot].key == key) {
+            return m->entries[slot].value;
+        }
+        slot = (slot + 1) & (m->capacity - 1);
+    }
+    return FIELD_MAP_ABSENT;
+}
+
+/** @brief Podwaja tablicę miejsc mapy.
+ * @param[in,out] m     – wskaźnik na strukturę mapy.
+ * @return Wartość @p true, jeśli alokacja się powiodła, lub @p false
+ * w przeciwnym wypadku, wtedy mapa pozostaje bez zmian.
+ */
+static bool field_map_grow(field_map *m) {
+    field_map_entry *entries = m->entries;
+    uint64_t capacity = m->capacity;
+    m->entries = calloc(2 * capacity, sizeof(field_map_entry));
+    if (m->entries == NULL) {
+        m->entries = entries;
+        return false;
+    }
+
+    m->capacity = 2 * capacity;
+    (m->shift)--;
+    for (uint64_t i = 0; i < capacity; i++) {
+        if (entries[i].key != 0) {
+            field_map_place(m, entries[i].key, entries[i].value);
+        }
+    }
+    free(entries);
+    return true;
+}
+
+bool field_map_insert(field_map *m, uint64_t key, uint32_t value) {
+    if (2 * (m->count + 1) > m->capacity && !field_map_grow(m)) {
+        return false;
+    }
+
+    field_map_place(m, key + 1, value);
+    (m->count)++;
+    return true;
+}
+
+bool field_map_reserve(field_map *m, uint64_t needed) {
+    while (2 * (m->count + needed) > m->capacity) {
+        if (!field_map_grow(m)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void field_map_set(field_map *m, uint64_t key, uint32_t value) {
+    key++;
+    uint64_t slot = field_map_slot(m, key);
+    while (m->entries[slot].key != 0) {
+        if (m->entries[slot].key == key) {
+            m->entries[slot].value = value;
+            return;
+        }
+        slot = (slot + 1) & (m->capacity - 1);
+    }
+    m->entries[slot].key = key;
+    m->entries[slot].value = value;
+    (m->count)++;
+}
+
+void field_map_erase(field_map *m, uint64_t key) {
+    key++;
+    uint64_t mask = m->capacity - 1;
+    uint64_t slot = field_map_slot(m, key);
+    while (m->entries[slot].key != key) {
+        if (m->entries[slot].key == 0) {
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    // Przesuwa wstecz klucze, które bez usuniętego klucza
+    // nie byłyby osiągalne ze swojego pierwszego miejsca.
+    uint64_t next = slot;
+    while (true) {
+        next = (next + 1) & mask;
+        if (m->entries[next].key == 0) {
+            break;
+        }
+        uint64_t home = field_map_slot(m, m->entries[next].key);
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            m->entries[slot] = m->entries[next];
+            slot = next;
+        }
+    }
+    m->entries[slot].key = 0;
+    (m->count)--;
+}
+
+uint64_t field_map_size(const field_map *m) {
+    return m->count;
+}
+
+void field_map_clear(field_map **m) {
+    if (*m != NULL) {
+        free((*m)->entries);
+        free(*m);
+        *m = NULL;
+    }
+}
+
+bool field_queue_init(field_queue **q, uint64_t capacity) {
+    *q = malloc(sizeof(field_queue));
+    if(*q == NULL) {
+        return false;
+    }
+
+    (*q)->elements = malloc(capacity * sizeof(uint32_t));
+    if((*q)->elements == NULL) {
+        free(*q);
+        *q = NULL;
+        return false;
+    }
+
+    (*q)->capacity = capacity;
+    (*q)->front = 0;
+    (*q)->end = 0;
+    return true;
+}
+
+void field_queue_push(field_queue *q, uint32_t element) {
+    q->elements[q->end] = element;
+    (q->end)++;
+}
+
+uint32_t field_queue_pop(field_queue *q) {
+    uint32_t el = q->elements[q->front];
+    (q->front)++;
+    if(q->front == q->end) {
+        q->front = 0;
+        q->end = 0;
+    }
+    return el;
 }
 
 inline bool field_queue_is_empty(field_queue *q) {
-    return q->front == NULL;
+    return q->front == q->end;
+}
+
+void field_queue_reset(field_queue *q) {
+    q->front = 0;
+    q->end = 0;
 }
 
 void field_queue_clear(field_queue **q) {
     if(*q != NULL) {
-        while (!field_queue_is_empty(*q)) {
-            field_queue_pop(*q);
-        }
+        free((*q)->elements);
         free(*q);
         *q = NULL;
     }
 }
 
-gamma_field* find_root_field(gamma_field *field, gamma_field **board) {
-    gamma_field *root = field;
-    while(!is_field_root(root)) {
-        root = &board[root->parent_x][root->parent_y];
+bool field_journal_init(field_journal **j) {
+    *j = malloc(sizeof(field_journal));
+    if(*j == NULL) {
+        return false;
+    }
+
+    (*j)->changes = NULL;
+    (*j)->capacity = 0;
+    (*j)->count = 0;
+    (*j)->has_failed = false;
+    return true;
+}
+
+void field_journal_record(field_journal *j, field_change_kind kind,
+                          uint32_t index, uint32_t old_value) {
+    if(j->has_failed) {
+        return;
+    }
+
+    if(j->count == j->capacity) {
+        uint64_t capacity = (j->capacity < FIELD_JOURNAL_MIN_CAPACITY)
+                            ? FIELD_JOURNAL_MIN_CAPACITY : 2 * j->capacity;
+        field_change *changes = realloc(j->changes, capacity * sizeof(field_change));
+        if(changes == NULL) {
+            j->has_failed = true;
+            return;
+        }
+        j->changes = changes;
+        j->capacity = capacity;
+    }
+
+    j->changes[j->count].kind = kind;
+    j->changes[j->count].index = index;
+    j->changes[j->count].old_value = old_value;
+    (j->count)++;
+}
+
+inline uint64_t field_journal_size(field_journal *j) {
+    return j->count;
+}
+
+field_change field_journal_pop(field_journal *j) {
+    (j->count)--;
+    return j->changes[j->count];
+}
+
+field_change field_journal_get(field_journal *j, uint64_t i) {
+    return j->changes[i];
+}
+
+inline bool field_journal_has_failed(field_journal *j) {
+    return j->has_failed;
+}
+
+void field_journal_reset(field_journal *j) {
+    j->count = 0;
+    j->has_failed = false;
+}
+
+void field_journal_clear(field_journal **j) {
+    if(*j != NULL) {
+        free((*j)->changes);
+        free(*j);
+        *j = NULL;
     }
+}
 
-    while(!is_field_root(field)) {
-        gamma_field *temp = &board[field->parent_x][field->parent_y];
-        field->parent_x = root->parent_x;
-        field->parent_y = root->parent_y;
-        field = temp;
+/** @brief Zmienia rodzica węzła, zapisując zmianę w dzienniku.
+ * @param[in,out] board   – wskaźnik na strukturę tablicy pól,
+ * @param[in] index       – indeks węzła,
+ * @param[in] parent      – nowa wartość składowej @p parent,
+ * @param[in,out] journal – dziennik zmian lub @p NULL.
+ */
+static inline void set_field_parent(field_board *board, uint32_t index,
+                                    uint32_t parent, field_journal *journal) {
+    gamma_field *field = field_board_get_for_write(board, index);
+    if(journal != NULL) {
+        field_journal_record(journal, FIELD_PARENT_CHANGE, index,
+                             field->parent);
+    }
+    field->parent = parent;
+}
+
+uint32_t find_root_field(field_board *board, uint32_t index,
+                         field_journal *journal) {
+    uint32_t root = index;
+    while(!is_field_root(field_board_get(board, root))) {
+        root = field_board_get(board, root)->parent & ~FIELD_PARENT_FLAG;
+    }
+
+    while(!is_field_root(field_board_get(board, index))) {
+        uint32_t temp = field_board_get(board, index)->parent & ~FIELD_PARENT_FLAG;
+        if(temp != root) {
+            set_field_parent(board, index, FIELD_PARENT_FLAG | root, journal);
+        }
+        index = temp;
     }
 
     return root;
 }
 
-bool unite_fields(gamma_field *f1, gamma_field *f2, gamma_field **board) {
-    gamma_field *root1 = find_root_field(f1, board);
-    gamma_field *root2 = find_root_field(f2, board);
+bool unite_fields(field_board *board, uint32_t i1, uint32_t i2,
+                  field_journal *journal) {
+    uint32_t root1 = find_root_field(board, i1, journal);
+    uint32_t root2 = find_root_field(board, i2, journal);
+    uint32_t rank1 = field_board_get(board, root1)->parent;
+    uint32_t rank2 = field_board_get(board, root2)->parent;
 
     if(root1 == root2) {
         return false;
     }
-    else if (root1->rank < root2->rank){
-        gamma_field *temp = root1;
+    else if (rank1 < rank2){
+        // Korzenie nie mają ustawionej flagi rodzica,
+        // więc porównanie składowych porównuje rangi.
+        uint32_t temp = root1;
         root1 = root2;
         root2 = temp;
     }
 
-    root2->parent_x = root1->this_x;
-    root2->parent_y = root1->this_y;
-
-    if(root1->rank == root2->rank) {
-        (root1->rank)++;
+    if(rank1 == rank2) {
+        set_field_parent(board, root1, rank1 + 1, journal);
     }
+    set_field_parent(board, root2, FIELD_PARENT_FLAG | root1, journal);
+
     return true;
 }
 
-inline bool is_field_root(gamma_field *f) {
-    return (f->this_x == f->parent_x && f->this_y == f->parent_y);
-}
\ No newline at end of file
+inline bool is_field_root(const gamma_field *f) {
+    return (f->parent & FIELD_PARENT_FLAG) == 0;
+}
+
+inline void set_field_as_root(gamma_field *f) {
+    f->parent = FIELD_SINGLE_ROOT;
+}
@@ -11,88 +11,477 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+/**
+ * Flaga w składowej @p parent oznaczająca, że węzeł ma rodzica
+ * w ramach algorytmu find and union. Pozostałe bity składowej
+ * przechowują wtedy indeks rodzica, a jeśli flaga nie jest ustawiona,
+ * węzeł jest korzeniem i pozostałe bity przechowują jego rangę.
+ */
+#define FIELD_PARENT_FLAG ((uint32_t) 1 << 31)
+
+/**
+ * Wartość składowej @p parent korzenia jednoelementowego zbioru.
+ */
+#define FIELD_SINGLE_ROOT ((uint32_t) 0)
+
+/**
+ * Maksymalna liczba pól na planszy. Indeks każdego pola
+ * musi mieścić się w bitach niezajętych przez @ref FIELD_PARENT_FLAG.
+ */
+#define MAX_FIELDS_COUNT ((uint64_t) FIELD_PARENT_FLAG)
 
 /**
  * Struktura przechowująca dane o jednym polu.
+ * Pola są przechowywane w jednowymiarowej tablicy, wierszami,
+ * pole (x, y) ma indeks y * szerokość + x. Pole wypełnione zerami
+ * nie należy do żadnego gracza i jest korzeniem jednoelementowego zbioru,
+ * więc pamięć na pola nie musi być inicjowana.
  */
 typedef struct field{
     uint32_t owner_index; ///< Indeks gracza, którego pionek stoi na polu.
-    uint32_t this_x;      ///< Numer kolumny, w której znajduje się pole.
-    uint32_t this_y;      ///< Numer wiersza, w którym znajduje się pole.
-    uint32_t parent_x;    ///< Numer kolumny, w której znajduje się rodzic pola.
-    uint32_t parent_y;    ///< Numer wiersza, w którym znajduje się rodzic pola.
-    uint32_t rank;        ///< Ranga pola w ramach algorytmu find and union.
+    uint32_t parent;      ///< Indeks rodzica węzła w tablicy pól wraz
+                          ///< z flagą @ref FIELD_PARENT_FLAG lub ranga
+                          ///< węzła, jeśli węzeł jest korzeniem.
 } gamma_field;
 
 /**
- * Struktura reprezentująca kolejkę obiektów typu gamma_field.
+ * Pole, do którego nic nie zapisano: nie należy do żadnego gracza
+ * i jest korzeniem jednoelementowego zbioru.
+ */
+extern const gamma_field FREE_FIELD;
+
+/**
+ * Liczba bitów indeksu pola wyznaczających jego pozycję w kafelku.
+ */
+#define FIELD_TILE_SHIFT 12
+
+/**
+ * Liczba pól w jednym kafelku tablicy pól.
+ */
+#define FIELD_TILE_SIZE ((uint32_t) 1 << FIELD_TILE_SHIFT)
+
+/**
+ * Maska indeksu pola wyznaczająca jego pozycję w kafelku.
+ */
+#define FIELD_TILE_MASK (FIELD_TILE_SIZE - 1)
+
+/**
+ * Struktura przechowująca kafelek, czyli stałej długości fragment
+ * tablicy pól. Kafelek może być współdzielony przez kilka kopii gry
+ * i jest kopiowany dopiero przy pierwszym zapisie do niego.
+ */
+typedef struct fieldtile{
+    atomic_uint references;                ///< Liczba tablic pól
+                                           ///< współdzielących kafelek.
+    gamma_field fields[FIELD_TILE_SIZE];   ///< Pola kafelka.
+} field_tile;
+
+/**
+ * Struktura reprezentująca plik odwzorowany w pamięci, w którym leżą
+ * kafelki tablicy pól.
+ */
+typedef struct fieldmapping field_mapping;
+
+/**
+ * Struktura reprezentująca tablicę pól podzieloną na kafelki.
+ * Pole o indeksie @p i znajduje się w kafelku o indeksie
+ * @p i >> @ref FIELD_TILE_SHIFT.
+ */
+typedef struct {
+    field_tile **tiles;     ///< Tablica kafelków; kafelki, do których
+                            ///< nic jeszcze nie zapisano, mają wartość NULL.
+    uint64_t tiles_count;   ///< Rozmiar tablicy @p tiles.
+    field_mapping *mapping; ///< Plik odwzorowany w pamięci, w którym leżą
+                            ///< niektóre kafelki, lub NULL; takie kafelki
+                            ///< nie są zwalniane pojedynczo.
+} field_board;
+
+/**
+ * Wartość zwracana przez funkcję @ref field_map_find dla klucza,
+ * którego nie ma w mapie.
+ */
+#define FIELD_MAP_ABSENT UINT32_MAX
+
+/**
+ * Struktura reprezentująca mapę z numerów komórek planszy
+ * w indeksy pól w tablicy pól lub z indeksów pól w indeksy węzłów.
+ */
+typedef struct fieldmap field_map;
+
+/**
+ * Struktura reprezentująca kolejkę indeksów pól.
  */
 typedef struct fieldqueue field_queue;
 
-/** @brief Inicjalizuje kolejkę.
- * Ustawia pola kolejki @p na NULL.
- * @param[out] q     – wskaźnik na wskaźnik na strukturę kolejki.
+/**
+ * Rodzaje zmian zapisywanych w dzienniku zmian pól.
+ */
+typedef enum {
+    FIELD_PARENT_CHANGE,  ///< zmiana składowej @p parent węzła
+    FIELD_OWNER_CHANGE,   ///< zmiana składowej @p owner_index pola
+    FIELD_NODE_CHANGE     ///< zmiana węzła find and union przypisanego polu
+} field_change_kind;
+
+/**
+ * Struktura przechowująca jedną zmianę zapisaną w dzienniku zmian pól.
+ */
+typedef struct {
+    uint32_t kind;        ///< rodzaj zmiany, jedna z wartości
+                          ///< @ref field_change_kind
+    uint32_t index;       ///< indeks zmienionego pola lub węzła
+    uint32_t old_value;   ///< wartość sprzed zmiany
+} field_change;
+
+/**
+ * Struktura reprezentująca dziennik zmian pól, pozwalający je cofnąć.
+ */
+typedef struct fieldjournal field_journal;
+
+/** @brief Tworzy tablicę pól.
+ * Alokuje tablicę mieszczącą @p capacity pól o domyślnych wartościach:
+ * pole nie należy do żadnego gracza, jest korzeniem jednoelementowego
+ * zbioru i ma przypisany węzeł o swoim indeksie. Alokowana jest jedynie
+ * wyzerowana tablica wskaźników na kafelki, a kafelki są alokowane przy
+ * pierwszym zapisie, więc czas tworzenia nie zależy od liczby pól.
+ * @param[out] board     – wskaźnik na strukturę tablicy pól,
+ * @param[in] capacity   – rozmiar tablicy.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku.
+ */
+bool field_board_init(field_board *board, uint64_t capacity);
+
+/** @brief Tworzy kopię tablicy pól.
+ * Kopiuje jedynie tablicę wskaźników na kafelki, a kafelki zaczynają być
+ * współdzielone przez obie tablice. Tablica @p board nie może być w tym
+ * czasie zmieniana.
+ * @param[out] copy      – wskaźnik na strukturę kopii,
+ * @param[in] board      – wskaźnik na strukturę kopiowanej tablicy.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku.
+ */
+bool field_board_clone(field_board *copy, const field_board *board);
+
+/** @brief Przekazuje tablicy pól odwzorowany w pamięci plik.
+ * Tablica pól i jej kopie mogą odtąd wskazywać na kafelki leżące w obszarze
+ * od @p address do @p address + @p size - 1. Obszar zostaje zwolniony
+ * funkcją munmap, gdy zostanie usunięta ostatnia z tych tablic.
+ * Obszar powinien być odwzorowany z flagą MAP_PRIVATE i prawem do zapisu,
+ * aby zapis do kafelka kopiował jedynie zmienioną stronę pamięci.
+ * @param[in,out] board  – wskaźnik na strukturę tablicy pól bez
+ *                         odwzorowanego pliku,
+ * @param[in] address    – początek odwzorowanego obszaru,
+ * @param[in] size       – rozmiar obszaru w bajtach.
+ * @return Wartość @p true, jeśli alokacja się powiodła, lub @p false
+ * w przeciwnym wypadku, wtedy obszar nie zostaje zwolniony.
+ */
+bool field_board_attach_mapping(field_board *board, void *address, size_t size);
+
+/** @brief Przygotowuje do zapisu kafelki dla zakresu pól.
+ * Alokuje niezaalokowane jeszcze kafelki zawierające pola o indeksach
+ * od @p first do @p first + @p count - 1 i kopiuje te z nich, które są
+ * współdzielone z inną tablicą, aby zapis do tych pól nie wymagał
+ * alokowania pamięci.
+ * @param[in,out] board  – wskaźnik na strukturę tablicy pól,
+ * @param[in] first      – indeks pierwszego pola,
+ * @param[in] count      – liczba pól.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku.
+ */
+bool field_board_reserve(field_board *board, uint64_t first, uint64_t count);
+
+/** @brief Przygotowuje do zapisu wszystkie zaalokowane kafelki.
+ * Kopiuje kafelki współdzielone z inną tablicą. Kafelki, do których
+ * nic jeszcze nie zapisano, pozostają niezaalokowane.
+ * @param[in,out] board  – wskaźnik na strukturę tablicy pól.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku.
+ */
+bool field_board_reserve_allocated(field_board *board);
+
+/** @brief Przygotowuje do zapisu kafelki ścieżki węzła do korzenia.
+ * Przygotowuje kafelki wszystkich węzłów, do których mogą pisać funkcje
+ * @ref find_root_field i @ref unite_fields wywołane dla węzła @p index.
+ * Sprawdza przy tym, czy ścieżka kończy się korzeniem: tablica wczytana
+ * z uszkodzonego pliku może zawierać rodzica spoza tablicy lub cykl,
+ * który zostaje wykryty najpóźniej po tylu krokach, ile węzłów mieści
+ * tablica.
+ * @param[in,out] board  – wskaźnik na strukturę tablicy pól,
+ * @param[in] index      – indeks węzła.
+ * @return Wartość @p true, jeśli alokacja się powiodła, a ścieżka kończy się
+ * korzeniem, lub @p false w przeciwnym wypadku.
+ */
+bool field_board_reserve_path(field_board *board, uint32_t index);
+
+/** @brief Powiększa tablicę pól.
+ * Powiększa tablicę wskaźników na kafelki tak, aby tablica mieściła
+ * @p capacity pól. Nowe kafelki są alokowane przy pierwszym zapisie.
+ * @param[in,out] board  – wskaźnik na strukturę tablicy pól,
+ * @param[in] capacity   – nowy rozmiar tablicy.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku, wtedy tablica pozostaje bez zmian.
+ */
+bool field_board_grow(field_board *board, uint64_t capacity);
+
+/** @brief Usuwa tablicę pól.
+ * Zwalnia kafelki, których nie współdzieli już żadna inna tablica,
+ * oraz tablicę wskaźników na kafelki.
+ * @param[in,out] board  – wskaźnik na strukturę tablicy pól.
+ */
+void field_board_clear(field_board *board);
+
+/** @brief Daje wskaźnik na pole do odczytu.
+ * @param[in] board      – wskaźnik na strukturę tablicy pól,
+ * @param[in] index      – indeks pola.
+ * @return Wskaźnik na pole o indeksie @p index lub na @ref FREE_FIELD,
+ * jeśli kafelek zawierający pole nie został jeszcze zaalokowany.
+ */
+static inline const gamma_field *field_board_get(const field_board *board,
+                                                 uint32_t index) {
+    const field_tile *tile = board->tiles[index >> FIELD_TILE_SHIFT];
+    return (tile == NULL) ? &FREE_FIELD : &tile->fields[index & FIELD_TILE_MASK];
+}
+
+/** @brief Daje wskaźnik na pole do zapisu.
+ * Kafelek zawierający pole musi być wcześniej przygotowany do zapisu
+ * funkcją @ref field_board_reserve, @ref field_board_reserve_allocated
+ * lub @ref field_board_reserve_path, więc zapis nigdy nie alokuje pamięci
+ * i ruch nie może zostać przerwany w połowie.
+ * @param[in,out] board  – wskaźnik na strukturę tablicy pól,
+ * @param[in] index      – indeks pola.
+ * @return Wskaźnik na pole o indeksie @p index.
+ */
+static inline gamma_field *field_board_get_for_write(field_board *board,
+                                                     uint32_t index) {
+    field_tile *tile = board->tiles[index >> FIELD_TILE_SHIFT];
+    return &tile->fields[index & FIELD_TILE_MASK];
+}
+
+/** @brief Tworzy pustą mapę.
+ * @param[out] m        – wskaźnik na wskaźnik na strukturę mapy.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku, wtedy @p *m ma wartość @p NULL.
+ */
+bool field_map_init(field_map **m);
+
+/** @brief Tworzy kopię mapy.
+ * @param[out] copy     – wskaźnik na wskaźnik na strukturę kopii,
+ * @param[in] m         – wskaźnik na strukturę kopiowanej mapy.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku, wtedy @p *copy ma wartość @p NULL.
+ */
+bool field_map_clone(field_map **copy, const field_map *m);
+
+/** @brief Znajduje wartość przypisaną kluczowi.
+ * @param[in] m         – wskaźnik na strukturę mapy,
+ * @param[in] key       – numer komórki planszy.
+ * @return Wartość przypisana kluczowi @p key lub @ref FIELD_MAP_ABSENT,
+ * jeśli klucza nie ma w mapie.
+ */
+uint32_t field_map_find(const field_map *m, uint64_t key);
+
+/** @brief Dodaje klucz do mapy.
+ * Klucza @p key nie może być w mapie.
+ * @param[in,out] m     – wskaźnik na strukturę mapy,
+ * @param[in] key       – numer komórki planszy, mniejszy od @p UINT64_MAX,
+ * @param[in] value     – wartość przypisywana kluczowi.
+ * @return Wartość @p true, jeśli klucz został dodany, lub @p false, jeśli
+ * nie udało się powiększyć mapy, wtedy mapa pozostaje bez zmian.
+ */
+bool field_map_insert(field_map *m, uint64_t key, uint32_t value);
+
+/** @brief Zapewnia miejsce na nowe klucze.
+ * Powiększa mapę tak, aby dodanie @p needed kluczy funkcją
+ * @ref field_map_set nie wymagało alokacji.
+ * @param[in,out] m     – wskaźnik na strukturę mapy,
+ * @param[in] needed    – liczba nowych kluczy.
+ * @return Wartość @p true, jeśli w mapie jest miejsce, lub @p false, jeśli
+ * nie udało się jej powiększyć.
+ */
+bool field_map_reserve(field_map *m, uint64_t needed);
+
+/** @brief Przypisuje wartość kluczowi.
+ * Zmienia wartość klucza @p key lub dodaje go do mapy. Dodanie klucza
+ * nie alokuje pamięci, więc miejsce na niego musi zapewnić wcześniej
+ * funkcja @ref field_map_reserve lub mapa musiała już kiedyś mieścić
+ * tyle kluczy, ile będzie w niej po dodaniu.
+ * @param[in,out] m     – wskaźnik na strukturę mapy,
+ * @param[in] key       – numer komórki planszy, mniejszy od @p UINT64_MAX,
+ * @param[in] value     – wartość przypisywana kluczowi.
+ */
+void field_map_set(field_map *m, uint64_t key, uint32_t value);
+
+/** @brief Usuwa klucz z mapy.
+ * Nic nie robi, jeśli klucza @p key nie ma w mapie. Rozmiar tablicy
+ * miejsc mapy się nie zmienia.
+ * @param[in,out] m     – wskaźnik na strukturę mapy,
+ * @param[in] key       – numer komórki planszy.
+ */
+void field_map_erase(field_map *m, uint64_t key);
+
+/** @brief Podaje liczbę kluczy w mapie.
+ * @param[in] m         – wskaźnik na strukturę mapy.
+ * @return Liczba kluczy w mapie.
+ */
+uint64_t field_map_size(const field_map *m);
+
+/** @brief Usuwa mapę.
+ * Zwalnia pamięć zaalokowaną na mapę i ustawia @p *m na @p NULL.
+ * Nic nie robi, jeśli @p *m ma wartość @p NULL.
+ * @param[in,out] m     – wskaźnik na wskaźnik na strukturę mapy.
  */
-void field_queue_init(field_queue **q);
+void field_map_clear(field_map **m);
+
+/** @brief Tworzy kolejkę.
+ * Alokuje strukturę kolejki wraz z tablicą na @p capacity elementów.
+ * Kolejka mieści jednocześnie co najwyżej @p capacity elementów.
+ * @param[out] q        – wskaźnik na wskaźnik na strukturę kolejki,
+ * @param[in] capacity  – maksymalna liczba elementów w kolejce.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku, wtedy @p *q ma wartość @p NULL.
+ */
+bool field_queue_init(field_queue **q, uint64_t capacity);
 
 /** @brief Dodaje pole do kolejki.
- * Tworzy element kolejki zawierający pole, na które wskazuje @p element
- * oraz dodaje go do kolejki.
+ * Dodaje indeks pola @p element na koniec kolejki.
+ * Kolejka nie może być pełna.
  * @param[in,out] q         – wskaźnik na strukturę kolejki,
- * @param[in] element       – wskaźnik na pole.
+ * @param[in] element       – indeks pola.
  */
-void field_queue_push(field_queue *q, gamma_field *element);
+void field_queue_push(field_queue *q, uint32_t element);
 
 /** @brief Wyjmuje pierwszy element z kolejki.
  * Usuwa z kolejki pierwszy element i ustanawia kolejny element jako pierwszy.
+ * Kolejka nie może być pusta.
  * @param[in,out] q     – wskaźnik na strukturę kolejki.
- * @return Wskaźnik na pole będące pierwszym elementem w kolejce,
- * lub @p NULL jeśli kolejka jest pusta.
+ * @return Indeks pola będącego pierwszym elementem w kolejce.
  */
-gamma_field* field_queue_pop(field_queue *q);
+uint32_t field_queue_pop(field_queue *q);
 
 /** @brief Sprawdza, czy kolejka jest pusta.
- * Sprawdza, czy kolejka nie zawiera żadnych elementów poprzez
- * sprawdzenie, czy wskaźnik na pierwszy element nie jest równy @p NULL.
  * @param[in] q     – wskaźnik na strukturę kolejki.
  * @return Wartość @p true, jeśli w kolejce nie ma elementów
  * lub wartość @p false jeśli kolejka zawiera elementy.
  */
 bool field_queue_is_empty(field_queue *q);
 
+/** @brief Opróżnia kolejkę.
+ * Usuwa z kolejki wszystkie elementy w czasie stałym.
+ * @param[in,out] q     – wskaźnik na strukturę kolejki.
+ */
+void field_queue_reset(field_queue *q);
+
 /** @brief Usuwa kolejkę.
- * Usuwa wszystkie elementy w kolejce i zwalnia pamięć zaalokowaną na kolejkę.
- * @param[in,out] q    – wskaźnik na strukturę kolejki.
+ * Zwalnia pamięć zaalokowaną na kolejkę i ustawia @p *q na @p NULL.
+ * Nic nie robi, jeśli @p *q ma wartość @p NULL.
+ * @param[in,out] q    – wskaźnik na wskaźnik na strukturę kolejki.
  */
 void field_queue_clear(field_queue **q);
 
+/** @brief Tworzy pusty dziennik zmian pól.
+ * @param[out] j        – wskaźnik na wskaźnik na strukturę dziennika.
+ * @return Wartość @p true, jeśli alokacja się powiodła
+ * lub @p false w przeciwnym wypadku, wtedy @p *j ma wartość @p NULL.
+ */
+bool field_journal_init(field_journal **j);
+
+/** @brief Zapisuje zmianę w dzienniku.
+ * Jeśli nie uda się powiększyć dziennika, zmiana nie zostaje zapisana,
+ * a dziennik zostaje oznaczony jako niekompletny.
+ * @param[in,out] j         – wskaźnik na strukturę dziennika,
+ * @param[in] kind          – rodzaj zmiany,
+ * @param[in] index         – indeks zmienianego pola lub węzła,
+ * @param[in] old_value     – wartość sprzed zmiany.
+ */
+void field_journal_record(field_journal *j, field_change_kind kind,
+                          uint32_t index, uint32_t old_value);
+
+/** @brief Podaje liczbę zmian zapisanych w dzienniku.
+ * @param[in] j     – wskaźnik na strukturę dziennika.
+ * @return Liczba zapisanych zmian.
+ */
+uint64_t field_journal_size(field_journal *j);
+
+/** @brief Wyjmuje ostatnią zmianę z dziennika.
+ * Dziennik nie może być pusty.
+ * @param[in,out] j     – wskaźnik na strukturę dziennika.
+ * @return Ostatnio zapisana zmiana.
+ */
+field_change field_journal_pop(field_journal *j);
+
+/** @brief Podaje zmianę zapisaną w dzienniku.
+ * @param[in] j     – wskaźnik na strukturę dziennika,
+ * @param[in] i     – numer zmiany, mniejszy od liczby zapisanych zmian.
+ * @return Zmiana o numerze @p i, licząc od najstarszej.
+ */
+field_change field_journal_get(field_journal *j, uint64_t i);
+
+/** @brief Sprawdza, czy któraś zmiana nie została zapisana w dzienniku.
+ * @param[in] j     – wskaźnik na strukturę dziennika.
+ * @return Wartość @p true, jeśli od ostatniego opróżnienia dziennika
+ * nie udało się zapisać którejś zmiany lub @p false w przeciwnym wypadku.
+ */
+bool field_journal_has_failed(field_journal *j);
+
+/** @brief Opróżnia dziennik.
+ * Usuwa wszystkie zapisane zmiany i oznaczenie niekompletności dziennika.
+ * @param[in,out] j     – wskaźnik na strukturę dziennika.
+ */
+void field_journal_reset(field_journal *j);
+
+/** @brief Usuwa dziennik.
+ * Zwalnia pamięć zaalokowaną na dziennik i ustawia @p *j na @p NULL.
+ * Nic nie robi, jeśli @p *j ma wartość @p NULL.
+ * @param[in,out] j    – wskaźnik na wskaźnik na strukturę dziennika.
+ */
+void field_journal_clear(field_journal **j);
+
 /** @brief Znajduje korzeń danego pola.
- * W ramach algorytmu find and union, znajduje korzeń pola, na które wskazuje
- * @p field oraz kompresuje jego ścieżkę do pola poprzez ustanowienie
- * rodzica tego pola na korzeń.
- * @param[in] field     – wskaźnik na pole,
- * @param[in] board     – tablica pól.
- * @return Wskaźnik na korzeń pola @p field.
+ * W ramach algorytmu find and union, znajduje korzeń pola o indeksie
+ * @p index oraz kompresuje ścieżkę do niego poprzez ustanowienie
+ * rodzica każdego pola na tej ścieżce na korzeń. Ścieżka musi być
+ * wcześniej sprawdzona funkcją @ref field_board_reserve_path, więc
+ * kończy się korzeniem.
+ * @param[in,out] board   – wskaźnik na strukturę tablicy pól,
+ * @param[in] index       – indeks pola,
+ * @param[in,out] journal – dziennik, w którym zapisywane są zmiany
+ *                          lub @p NULL.
+ * @return Indeks korzenia pola @p index.
  */
-gamma_field* find_root_field(gamma_field *field, gamma_field **board);
+uint32_t find_root_field(field_board *board, uint32_t index,
+                         field_journal *journal);
 
 /** @brief Łączy zbiory, do których należą pola.
- * Łączy zbiory, do których należą pola wskazywane przez @p f1 i @p f2,
- * poprzez podpięcie jednego z korzeni do drugiego.
- * @param[in,out] f1        – pierwsze pole,
- * @param[in,out] f2        – drugie pole,
- * @param[in] board         – tablica pól.
+ * Łączy zbiory, do których należą pola o indeksach @p i1 i @p i2,
+ * poprzez podpięcie jednego z korzeni do drugiego. Ścieżki obu pól muszą
+ * być wcześniej sprawdzone funkcją @ref field_board_reserve_path.
+ * @param[in,out] board     – wskaźnik na strukturę tablicy pól,
+ * @param[in] i1            – indeks pierwszego pola,
+ * @param[in] i2            – indeks drugiego pola,
+ * @param[in,out] journal   – dziennik, w którym zapisywane są zmiany
+ *                            lub @p NULL.
  * @return Wartość @p true, jeśli pola znajdowały się w różnych zbiorach
  * lub wartość @p false, jeśli znajdowały się w tym samym zbiorze.
  */
-bool unite_fields(gamma_field *f1, gamma_field *f2, gamma_field **board);
+bool unite_fields(field_board *board, uint32_t i1, uint32_t i2,
+                  field_journal *journal);
 
 /** @brief Sprawdza, czy pole jest korzeniem.
- * Sprawdza, czy współrzędne tego pola są równe współrzędnym jego rodzica.
+ * Sprawdza, czy składowa @p parent pola nie ma ustawionej flagi
+ * @ref FIELD_PARENT_FLAG.
  * @param[in] f     – wskaźnik na pole.
  * @return Wartość @p true, jeśli pole jest korzeniem
  * lub wartość @p false w przeciwnym wypadku.
  */
-bool is_field_root(gamma_field *f);
+bool is_field_root(const gamma_field *f);
+
+/** @brief Ustanawia pole korzeniem jednoelementowego zbioru.
+ * Ustawia składową @p parent pola na @ref FIELD_SINGLE_ROOT,
+ * czyli zerową rangę bez flagi @ref FIELD_PARENT_FLAG.
+ * @param[out] f    – wskaźnik na pole.
+ */
+void set_field_as_root(gamma_field *f);
 
 #endif //GAMMA_GAMMA_FIELD_H
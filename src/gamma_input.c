@@ -8,171 +8,361 @@
 #define _GNU_SOURCE
 
 #include "gamma_input.h"
+#include "gamma_output.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
 #include <limits.h>
-#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-inline void print_error(uint32_t lines) {
-    fprintf(stderr, "ERROR %u\n", lines);
-}
+/**
+ * Początkowy rozmiar bufora wejścia czytanego blokami. Bufor rośnie,
+ * jeśli pojedyncza linia się w nim nie mieści.
+ */
+#define INPUT_BLOCK_SIZE ((size_t) 1 << 20)
 
-/** @brief Sprawdza, czy linię wejścia należy pominąć.
- * Sprawdza, czy linia nie składa się z komentarza
- * lub pojedyczego znaku końca linii.
- * @param line           – linia wejścia.
- * @return Wartość @p true jeśli znak komendy jest
- * znakiem komentarza lub znakiem końca linii.
+/**
+ * Największa wartość parametru, którą rozróżnia parser. Większe liczby
+ * są zamieniane na @ref PARAMETER_OUT_OF_RANGE.
+ */
+#define MAX_PARAMETER_VALUE ((uint64_t) LONG_MAX)
+
+/**
+ * Wartość parametru, którego liczba przekracza @ref MAX_PARAMETER_VALUE.
+ * Wcześniejszy parser zwracał w tym przypadku UINT32_MAX + 1, co w typie
+ * uint32_t daje zero; zachowujemy to zachowanie.
+ */
+#define PARAMETER_OUT_OF_RANGE 0
+
+/**
+ * Źródło wejścia: bufor, do którego dane są wczytywane dużymi blokami,
+ * albo cały plik zwykły odwzorowany w pamięci.
  */
-static inline bool should_line_be_skipped(const char *line) {
-    return(line != NULL && line[0] != '\0' &&
-          (line[0] == COMMENT_SIGN || line[0] == '\n'));
+static struct {
+    char *data;         ///< Wczytane dane lub NULL przed pierwszym odczytem.
+    size_t capacity;    ///< Rozmiar tablicy @p data.
+    size_t begin;       ///< Początek nieprzetworzonej części danych.
+    size_t scanned;     ///< Koniec części danych przeszukanej już
+                        ///< w poszukiwaniu znaku końca linii.
+    size_t end;         ///< Koniec wczytanych danych.
+    bool finished;      ///< Czy wejście się skończyło.
+    bool mapped;        ///< Czy @p data jest odwzorowanym w pamięci plikiem.
+    int fd;             ///< Deskryptor, z którego czytane jest wejście.
+    void (*before_read)(); ///< Funkcja wywoływana przed odczytem lub NULL.
+} input = {.fd = STDIN_FILENO, .before_read = flush_output};
+
+inline void print_error(uint32_t lines) {
+    error_text("ERROR ");
+    error_number(lines);
+    error_text("\n");
 }
 
-/** @brief Zamienia ciąg cyfr na liczbę.
- * Zamienia ciąg cyfr zapisany w parametrze @p parameter
- * na liczbę, jeśli jest to możliwe. Liczba nie powinna wykraczać
- * poza zasięg typu uint32_t.
- * @param[in] parameter         – łańcuch znaków.
- * @return Liczba zakodowana wcześniej jako ciąg znaków
- * lub @p BLANK_PARAMETER_NUMBER, jeśli ciąg jest pusty.
+/** @brief Zwalnia bufor wejścia.
+ * Zamyka również plik otwarty funkcją @ref open_input.
  */
-static long parse_number(char *parameter) {
-    if(parameter == NULL) {
-        return BLANK_PARAMETER_NUMBER;
+static void free_input() {
+    if(input.mapped) {
+        munmap(input.data, input.capacity);
+        input.mapped = false;
     }
     else {
-        char *ch;
-        unsigned long result = strtoul(parameter, &ch, 10);
-        if(result > LONG_MAX) {
-            return UINT32_MAX + 1;
-        }
-        else {
-            return (long) result;
+        free(input.data);
+    }
+    input.data = NULL;
+    if(input.fd != STDIN_FILENO) {
+        close(input.fd);
+        input.fd = STDIN_FILENO;
+    }
+}
+
+bool open_input(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+    input.fd = fd;
+    atexit(free_input);
+
+    // Plik zwykły jest przetwarzany bezpośrednio w pamięci, bez kopiowania.
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+       file_stat.st_size > 0 && (uint64_t) file_stat.st_size <= SIZE_MAX) {
+        void *data = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE,
+                          fd, 0);
+        if(data != MAP_FAILED) {
+            madvise(data, file_stat.st_size, MADV_SEQUENTIAL);
+            input.data = data;
+            input.capacity = input.end = file_stat.st_size;
+            input.mapped = true;
+            input.finished = true;
         }
     }
+    return true;
 }
 
-/** @brief Sprawdza, czy linia składa się tylko z prawidłowych znaków.
- * Sprawdza czy pierwszy znak linii jest osobnym słowem
- * oraz czy pozostałe znaki są znakami białymi lub cyframi.
- * @param line                  – sprawdzana linia.
- * @return Wartość @p true jeśli znaki w linii spełniają powyższe warunki
- * lub @p false w przeciwnym wypadku.
+/** @brief Wczytuje kolejny blok wejścia.
+ * Przesuwa nieprzetworzone dane na początek bufora, w razie potrzeby
+ * powiększa bufor, a następnie dopisuje do niego kolejny blok wejścia
+ * wczytany jednym wywołaniem funkcji read.
+ * @return Wartość @p true, jeśli wczytano jakieś dane, lub @p false,
+ * jeśli wejście się skończyło lub wystąpił błąd.
  */
-static bool is_line_correct(const char *line) {
-    if(line == NULL) {
+static bool fill_input() {
+    if(input.finished || input.mapped) {
         return false;
     }
-    else {
-        int i = 0;
-        while (line[i] != '\n') {
-            if (i == 0) {
-                char next = line[1];
-                if (isspace(line[0]) || (!isspace(next) && next != '\0')) {
-                    return false;
-                }
-            }
-            else {
-                char curr = line[i];
-                if (!isspace(curr) && !isdigit(curr)) {
-                    return false;
-                }
-            }
-            i++;
+    else if(input.data == NULL) {
+        input.data = malloc(INPUT_BLOCK_SIZE);
+        if(input.data == NULL) {
+            input.finished = true;
+            return false;
+        }
+        input.capacity = INPUT_BLOCK_SIZE;
+        atexit(free_input);
+    }
+
+    if(input.begin > 0) {
+        memmove(input.data, input.data + input.begin, input.end - input.begin);
+        input.end -= input.begin;
+        input.scanned -= input.begin;
+        input.begin = 0;
+    }
+    if(input.end == input.capacity) {
+        char *data = realloc(input.data, 2 * input.capacity);
+        if(data == NULL) {
+            input.finished = true;
+            return false;
         }
-        return true;
+        input.data = data;
+        input.capacity *= 2;
     }
+
+    // Wyniki dotychczasowych poleceń muszą być widoczne, zanim
+    // zaczniemy czekać na kolejne.
+    if(input.before_read != NULL) {
+        input.before_read();
+    }
+    ssize_t count;
+    do {
+        count = read(input.fd, input.data + input.end,
+                     input.capacity - input.end);
+    } while(count < 0 && errno == EINTR);
+    if(count <= 0) {
+        input.finished = true;
+        return false;
+    }
+    input.end += count;
+    return true;
 }
 
-/** @brief Czyta jeden parametr za pomocą strtok.
- * Sczytuje za pomocą strtok następny wyraz
- * i przetwarza go na liczbę.
- * Funkcja zakłada, że następny wyraz to same liczby,
- * w momencie wywołania funkcji powinno to już być sprawdzone.
- * @param[in]  delim        – ograniczniki dla strtok.
- * @return Wartość @p true jeśli poprawnie zamieniono
- * wyraz na liczbę lub @p false w przeciwnym razie.
+/** @brief Daje kolejną linię wejścia.
+ * Szuka końca linii funkcją memchr, doczytując kolejne bloki wejścia,
+ * dopóki go nie znajdzie. Linia pozostaje w buforze wejścia do następnego
+ * wywołania tej funkcji.
+ * @param[out] line          – początek linii, bez znaku końca linii,
+ * @param[out] length        – długość linii,
+ * @param[out] has_newline   – czy linia kończyła się znakiem końca linii.
+ * @return Wartość @p true, jeśli wczytano linię, lub @p false, jeśli
+ * wejście się skończyło.
  */
-static long read_parameter(char *delim) {
-    char *p = strtok(NULL, delim);
-    return parse_number(p);
+static bool next_line(const char **line, size_t *length, bool *has_newline) {
+    while(true) {
+        char *newline = NULL;
+        if(input.scanned < input.end) {
+            newline = memchr(input.data + input.scanned, '\n',
+                             input.end - input.scanned);
+        }
+        if(newline != NULL) {
+            *line = input.data + input.begin;
+            *length = newline - *line;
+            *has_newline = true;
+            input.begin = newline - input.data + 1;
+            input.scanned = input.begin;
+            return true;
+        }
+        input.scanned = input.end;
+        if(!fill_input()) {
+            if(input.begin == input.end) {
+                return false;
+            }
+            *line = input.data + input.begin;
+            *length = input.end - input.begin;
+            *has_newline = false;
+            input.begin = input.scanned = input.end;
+            return true;
+        }
+    }
 }
 
-/** @brief Sczytuje aktualną linię wejścia.
- * Sczytuje aktualną linię wejścia.
- * @return Aktualna linia wejścia
- * lub @p NULL jeśli wczytywanie się nie powiodło.
- */
-static char * get_current_line() {
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t temp = getline(&line, &len, stdin);
-    if(temp == -1) {
-        free(line);
-        return NULL;
+int read_input_character() {
+    if(input.begin == input.end && !fill_input()) {
+        return EOF;
     }
-    else {
-        return line;
+    input.scanned = input.begin + 1;
+    return (unsigned char) input.data[input.begin++];
+}
+
+void unread_input_character(int character) {
+    if(character == EOF) {
+        return;
     }
+    else if(input.mapped) {
+        // Odwzorowany plik nie jest zmieniany, a zwracany znak
+        // jest wciąż w nim zapisany tuż przed początkiem danych.
+        if(input.begin > 0) {
+            input.begin--;
+            input.scanned = input.begin;
+        }
+        return;
+    }
+    else if(input.begin == 0) {
+        if(input.data == NULL || input.end == input.capacity) {
+            return;
+        }
+        memmove(input.data + 1, input.data, input.end);
+        input.end++;
+        input.begin++;
+    }
+    input.begin--;
+    input.scanned = input.begin;
+    input.data[input.begin] = (char) character;
+}
+
+bool is_input_finished() {
+    return input.finished && input.begin == input.end;
+}
+
+bool read_input_records(const char **records, size_t *count,
+                        size_t record_size) {
+    while(input.end - input.begin < record_size) {
+        if(!fill_input()) {
+            return false;
+        }
+    }
+    *records = input.data + input.begin;
+    *count = (input.end - input.begin) / record_size;
+    input.begin += *count * record_size;
+    input.scanned = input.begin;
+    return true;
+}
+
+/** @brief Sprawdza, czy znak jest znakiem białym.
+ * Odpowiada funkcji isspace w domyślnych ustawieniach regionalnych.
+ * @param[in] character  – sprawdzany znak.
+ * @return Wartość @p true, jeśli znak jest znakiem białym,
+ * lub @p false w przeciwnym wypadku.
+ */
+static inline bool is_blank(char character) {
+    return character == ' ' || (character >= '\t' && character <= '\r');
+}
+
+/** @brief Sprawdza, czy linię wejścia należy pominąć.
+ * Sprawdza, czy linia nie składa się z komentarza
+ * lub pojedyczego znaku końca linii.
+ * @param[in] line           – linia wejścia,
+ * @param[in] length         – długość linii,
+ * @param[in] has_newline    – czy linia kończyła się znakiem końca linii.
+ * @return Wartość @p true jeśli znak komendy jest
+ * znakiem komentarza lub znakiem końca linii.
+ */
+static inline bool should_line_be_skipped(const char *line, size_t length,
+                                          bool has_newline) {
+    return (length > 0 && line[0] == COMMENT_SIGN) ||
+           (length == 0 && has_newline);
 }
 
 /** @brief Przetwarza wczytaną linię na parametry.
- * Sczytuje z wczytanej linii pojedynczy znak komendy
- * oraz maksymalnie 4 parametry liczbowe.
+ * W jednym przejściu sprawdza, czy pierwszy znak linii jest osobnym słowem,
+ * a pozostałe znaki są znakami białymi lub cyframi, oraz odczytuje
+ * maksymalnie 4 parametry liczbowe. Linia bez znaku końca linii
+ * jest niepoprawna.
  * @param[out] command       – struktura komendy,
- * @param[in] line           – wczytana linia.
+ * @param[in] line           – wczytana linia,
+ * @param[in] length         – długość linii,
+ * @param[in] has_newline    – czy linia kończyła się znakiem końca linii.
  * @return Wartość @p true jeśli parametry były poprawne
  * lub @p false w przeciwnym wypadku.
  */
-static bool set_command(command_t *command, char *line) {
-    char first = line[0];
-    if(!is_line_correct(line)) {
-        return false;
-    }
-    char delim[] = " \n\t\v\f\r";
-    char *com = strtok(line, delim);
-    if(com[0] != first) {
+static bool set_command(command_t *command, const char *line, size_t length,
+                        bool has_newline) {
+    if(!has_newline || line[0] == '\0' || is_blank(line[0]) ||
+       (length > 1 && !is_blank(line[1]))) {
         return false;
     }
 
-    command->type = com[0];
+    long params[4] = {BLANK_PARAMETER_NUMBER, BLANK_PARAMETER_NUMBER,
+                      BLANK_PARAMETER_NUMBER, BLANK_PARAMETER_NUMBER};
+    int count = 0;
+    size_t i = 1;
+    while(i < length) {
+        if(is_blank(line[i])) {
+            i++;
+            continue;
+        }
+        else if(line[i] < '0' || line[i] > '9' || count == 4) {
+            return false;
+        }
 
-    long *params[4] = {&command->first_par, &command->second_par,
-                       &command->third_par, &command->fourth_par};
-    for(int i = 0; i < 4; i++) {
-        *params[i] = read_parameter(delim);
+        uint64_t value = 0;
+        bool out_of_range = false;
+        for(; i < length && line[i] >= '0' && line[i] <= '9'; i++) {
+            uint64_t digit = line[i] - '0';
+            if(value > (MAX_PARAMETER_VALUE - digit) / 10) {
+                out_of_range = true;
+            }
+            else {
+                value = 10 * value + digit;
+            }
+        }
+        params[count++] = out_of_range ? PARAMETER_OUT_OF_RANGE : (long) value;
     }
 
-    return (strtok(NULL, delim) == NULL);
+    command->type = line[0];
+    command->first_par = params[0];
+    command->second_par = params[1];
+    command->third_par = params[2];
+    command->fourth_par = params[3];
+    return true;
+}
+
+input_line_kind read_input_line(command_t *command) {
+    const char *line;
+    size_t length;
+    bool has_newline;
+    if(!next_line(&line, &length, &has_newline)) {
+        return INPUT_END;
+    }
+    else if(should_line_be_skipped(line, length, has_newline)) {
+        return INPUT_SKIPPED;
+    }
+    else if(set_command(command, line, length, has_newline)) {
+        return INPUT_COMMAND;
+    }
+    else {
+        return INPUT_WRONG;
+    }
 }
 
 bool read_command(command_t *command, uint32_t *lines) {
-    bool is_reading_command_finished = false;
-    char *line = NULL;
-    while(!is_reading_command_finished) {
-        line = get_current_line();
-        if(line == NULL) {
-            is_reading_command_finished = true;
+    input_line_kind kind;
+    while((kind = read_input_line(command)) != INPUT_END) {
+        if(kind == INPUT_COMMAND) {
+            return true;
         }
-        else if(should_line_be_skipped(line)) {
-            (*lines)++;
-        }
-        else {
-            if(set_command(command, line)) {
-                is_reading_command_finished = true;
-            }
-            else {
-                print_error(*lines);
-                (*lines)++;
-            }
-        }
-        if(line != NULL) {
-            free(line);
+        else if(kind == INPUT_WRONG) {
+            print_error(*lines);
         }
+        (*lines)++;
     }
 
-    return line != NULL;
-}
\ No newline at end of file
+    return false;
+}
+
+void set_before_read(void (*before_read)()) {
+    input.before_read = before_read;
+}
@@ -8,6 +8,7 @@
 #ifndef GAMMA_GAMMA_INPUT_H
 #define GAMMA_GAMMA_INPUT_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -32,6 +33,15 @@ typedef struct {
     long fourth_par;    ///< Czwarty parametr.
 } command_t;
 
+/**
+ * Rodzaje linii wejścia rozpoznawane przez funkcję @ref read_input_line.
+ */
+typedef enum {
+    INPUT_COMMAND,  ///< linia z poleceniem o poprawnej składni
+    INPUT_SKIPPED,  ///< komentarz lub pusta linia
+    INPUT_WRONG,    ///< linia niepoprawna
+    INPUT_END       ///< koniec wejścia
+} input_line_kind;
 
 /** @brief Wypisuje informacje o błędzie.
  * Wypisuje informację o błędzie oraz numer linii, w którym wystąpił.
@@ -39,6 +49,17 @@ typedef struct {
  */
 void print_error(uint32_t lines);
 
+/** @brief Ustawia plik jako źródło wejścia.
+ * Od tej pory polecenia są czytane z pliku @p path zamiast ze standardowego
+ * wejścia. Plik zwykły jest odwzorowywany w pamięci i przetwarzany bez
+ * kopiowania, a inne pliki, np. potoki, są czytane dużymi blokami.
+ * Funkcję należy wywołać przed pierwszym odczytem wejścia.
+ * @param[in] path          – ścieżka do pliku.
+ * @return Wartość @p true, jeśli udało się otworzyć plik,
+ * lub @p false w przeciwnym wypadku.
+ */
+bool open_input(const char *path);
+
 /** @brief Czyta linię z wejścia i przetwarza ją na komendę.
  * Czyta daną linię z wejścia i zapisuje
  * odczytane dane na zmiennej @p command.
@@ -49,4 +70,58 @@ void print_error(uint32_t lines);
  */
 bool read_command(command_t *command, uint32_t *lines);
 
+/** @brief Czyta jedną linię wejścia.
+ * W odróżnieniu od funkcji @ref read_command niczego nie wypisuje,
+ * więc może ją wywoływać wątek inny niż ten, który wykonuje polecenia.
+ * @param[out] command      – komenda, ustawiana tylko dla linii
+ *                            rodzaju @ref INPUT_COMMAND.
+ * @return Rodzaj wczytanej linii lub @ref INPUT_END,
+ * jeśli wejście się skończyło.
+ */
+input_line_kind read_input_line(command_t *command);
+
+/** @brief Ustala funkcję wywoływaną przed czekaniem na wejście.
+ * Moduł wejścia wywołuje ją przed każdym odczytem, który może czekać
+ * na dane. Domyślnie jest to @ref flush_output. Należy ją zmienić,
+ * zanim wejście zacznie czytać inny wątek niż ten, który pisze na wyjście.
+ * @param[in] before_read   – wywoływana funkcja lub NULL.
+ */
+void set_before_read(void (*before_read)());
+
+/** @brief Czyta z wejścia jeden znak.
+ * Czyta znak z tego samego bufora wejścia co funkcja @ref read_command,
+ * więc nie pomija danych wczytanych już z wyprzedzeniem.
+ * @return Wczytany znak jako unsigned char zamieniony na int
+ * lub EOF, jeśli wejście się skończyło.
+ */
+int read_input_character();
+
+/** @brief Zwraca znak na wejście.
+ * Następne wywołanie funkcji @ref read_input_character zwróci
+ * znak @p character. Można zwrócić kilka znaków z rzędu.
+ * @param[in] character    – zwracany znak lub EOF, który jest pomijany.
+ */
+void unread_input_character(int character);
+
+/** @brief Sprawdza, czy wejście się skończyło.
+ * @return Wartość @p true, jeśli nie ma już nic do wczytania,
+ * lub @p false w przeciwnym wypadku.
+ */
+bool is_input_finished();
+
+/** @brief Daje kolejne rekordy binarne z wejścia.
+ * Daje wszystkie pełne rekordy, które są już w buforze wejścia, a jeśli
+ * nie ma żadnego, najpierw doczytuje wejście. Plik odwzorowany w pamięci
+ * jest oddawany w całości naraz. Niepełny rekord zostaje w buforze.
+ * Rekordy pozostają ważne do następnego odczytu wejścia i nie muszą być
+ * wyrównane w pamięci.
+ * @param[out] records      – początek pierwszego rekordu,
+ * @param[out] count        – liczba rekordów, co najmniej jeden,
+ * @param[in] record_size   – rozmiar rekordu w bajtach.
+ * @return Wartość @p true, jeśli wczytano rekordy, lub @p false, jeśli
+ * wejście skończyło się przed końcem kolejnego rekordu.
+ */
+bool read_input_records(const char **records, size_t *count,
+                        size_t record_size);
+
 #endif //GAMMA_GAMMA_INPUT_H
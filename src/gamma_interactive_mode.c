@@ -9,9 +9,9 @@
 #include "gamma_interactive_mode.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
 #include <ctype.h>
 #include "raw_mode.h"
+#include "gamma_output.h"
 
 /**
  * Makro używane do usuwania wszystkich znaków z ekranu
@@ -174,27 +174,12 @@ typedef struct {
     uint32_t max_width;     ///< Maksymalna szerokość planszy.
     uint32_t max_height;    ///< Maksymalna wysokość planszy.
     uint32_t max_players;   ///< Ilość graczy.
+    uint32_t player_width;  ///< Liczba cyfr numeru ostatniego gracza.
     gamma_t *game;          ///< Wskaźnik na strukturę gry.
     uint32_t curr_x;        ///< Obecna kolumna, w której znajduje się kursor.
     uint32_t curr_y;        ///< Obecny wiersz, w którym znajduje się kursor.
-    char* board;            ///< Wskaźnik na obecny wypis stanu planszy.
 } game_information;
 
-/**
- * Wskaźnik na obecny wypis stanu planszy.
- * Zasięg pliku, aby w razie błędu móc
- * zwolnić tę pamięć za pomocą atexit.
- */
-static char* board_pointer = NULL;
-
-/** @brief Zwalnia pamięć zaalokowaną na wypis stanu planszy.
- */
-static void free_board_pointer() {
-    if(board_pointer != NULL) {
-        free(board_pointer);
-    }
-}
-
 /** @brief Przywraca widoczność kursora.
  */
 static inline void show_cursor() {
@@ -253,21 +238,27 @@ static void print_lower_border(uint32_t board_width) {
 
 /** @brief Wypisuje aktualny stan planszy z zaznaczonym polem.
  * Wypisuje aktualny stan planszy na podstawie informacji
- * zawartych w strukturze @p game_info. Jeśli składowa
- * @p board tej struktury ma wartość NULL, wywołuje funkcję
- * @ref gamma_board.
+ * zawartych w strukturze @p game_info. Opis planszy pobiera
+ * za pomocą funkcji @ref gamma_board_view. Jeśli nie udało się go
+ * utworzyć, wypisuje planszę bez ramki i zaznaczenia pola funkcją
+ * @ref gamma_board_write, tak jak polecenie wypisania planszy w trybie
+ * wsadowym.
  * @param[in] game_info          – informacje na temat gry,
  * @param[in] curr_player        - numer gracza, który ma teraz ruch.
  */
 static void print_board(game_information *game_info, uint32_t curr_player) {
     clear_screen();
-    if(game_info->board == NULL) {
-        game_info->board = gamma_board(game_info->game);
-        board_pointer = game_info->board;
+    const char *board = gamma_board_view(game_info->game);
+    if(board == NULL) {
+        // Opis trafia do wyjścia z pominięciem bufora printf.
+        fflush(stdout);
+        gamma_board_write(game_info->game, STDOUT_FILENO);
+        print_player_message(game_info, curr_player);
+        return;
     }
     uint32_t line = game_info->max_height - game_info->curr_y - 1;
     uint32_t column = game_info->curr_x;
-    uint32_t player_width = log10(game_info->max_players) + 1;
+    uint32_t player_width = game_info->player_width;
     uint32_t l = 0;
     uint32_t field_width = player_width + (game_info->max_players >= 10);
 
@@ -279,18 +270,18 @@ static void print_board(game_information *game_info, uint32_t curr_player) {
                 set_background_color_light_blue();
             }
             for(uint32_t k = 0; k < player_width; k++) {
-                printf("%c", game_info->board[l]);
+                printf("%c", board[l]);
                 l++;
             }
             reset_text_color();
             if(game_info->max_players > 9) {
-                printf("%c", game_info->board[l]);
+                printf("%c", board[l]);
                 l++;
             }
         }
         print_vertical_edge();
         // Wypisywanie końca linii.
-        printf("%c", game_info->board[l]);
+        printf("%c", board[l]);
         l++;
     }
     print_lower_border(field_width * game_info->max_width);
@@ -356,19 +347,19 @@ static void move_cursor(int ch, game_information *game_info, uint32_t curr_playe
  * @param[in] curr_player       - indeks obecnego gracza.
  */
 static void read_arrow_key(game_information *game_info, uint32_t curr_player) {
-    int d = getchar();
+    int d = read_input_character();
     if(d == LEFT_BRACKET) {
-        int f = getchar();
+        int f = read_input_character();
         if(is_character_arrow_symbol(f)) {
             move_cursor(f, game_info, curr_player);
         }
         else {
-            ungetc(f, stdin);
-            ungetc(d, stdin);
+            unread_input_character(f);
+            unread_input_character(d);
         }
     }
     else {
-        ungetc(d, stdin);
+        unread_input_character(d);
     }
 }
 
@@ -389,12 +380,7 @@ static inline void print_move_error() {
 static bool make_move(game_information *game_info, uint32_t curr_player) {
     bool was_move_successful = gamma_move(game_info->game, curr_player,
                                 game_info->curr_x, game_info->curr_y);
-    if(was_move_successful) {
-        free(game_info->board);
-        game_info->board = NULL;
-        board_pointer = NULL;
-    }
-    else {
+    if(!was_move_successful) {
         print_move_error();
     }
 
@@ -411,12 +397,7 @@ static bool make_move(game_information *game_info, uint32_t curr_player) {
 static bool make_golden_move(game_information *game_info, uint32_t curr_player) {
     bool was_move_successful = gamma_golden_move(game_info->game, curr_player,
                                         game_info->curr_x, game_info->curr_y);
-    if(was_move_successful) {
-        free(game_info->board);
-        game_info->board = NULL;
-        board_pointer = NULL;
-    }
-    else {
+    if(!was_move_successful) {
         print_move_error();
     }
 
@@ -437,7 +418,7 @@ static bool play_turn(game_information *game_info, uint32_t curr_player) {
     bool finished = false;
     print_board(game_info, curr_player);
     do {
-        ch = tolower(getchar());
+        ch = tolower(read_input_character());
         switch (ch) {
             case ESCAPE_SYMBOL:
                 read_arrow_key(game_info, curr_player);
@@ -526,19 +507,33 @@ static void initialize_game(game_information *game_info,
     game_info->max_width = command->first_par;
     game_info->max_height = command->second_par;
     game_info->max_players = command->third_par;
+    game_info->player_width = 1;
+    for(uint32_t i = game_info->max_players; i >= 10; i /= 10) {
+        game_info->player_width++;
+    }
     game_info->game = game;
     game_info->curr_x = 0;
     game_info->curr_y = 0;
-    game_info->board = NULL;
-    atexit(free_board_pointer);
     clear_screen_without_deleting();
 }
 
+/** @brief Wypisuje wszystko, co czeka w buforach wyjścia.
+ * Tryb interaktywny pisze funkcją printf, więc przed czekaniem na klawisz
+ * trzeba opróżnić także bufor standardowego wyjścia, inaczej komunikat
+ * bez znaku końca linii nie pojawiłby się na ekranie.
+ */
+static void flush_screen() {
+    flush_output();
+    fflush(stdout);
+}
+
 void run_interactive_mode(gamma_t *game, command_t *command) {
     enableRawMode();
     hide_cursor();
+    set_before_read(flush_screen);
 
     game_information game_info;
     initialize_game(&game_info, game, command);
     run_game(&game_info);
+    set_before_read(flush_output);
 }
\ No newline at end of file
@@ -6,6 +6,8 @@
  * @date 5.04.2020
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
@@ -13,8 +15,10 @@
 #include <unistd.h>
 #include "gamma.h"
 #include "gamma_batch_mode.h"
+#include "gamma_binary_mode.h"
 #include "gamma_interactive_mode.h"
 #include "gamma_input.h"
+#include "gamma_output.h"
 
 /**
  * Symbol informujący o tym, że powinien zostać uruchomiony tryb wsadowy.
@@ -26,6 +30,17 @@
  */
 #define INTERACTIVE_MODE_SYMBOL 'I'
 
+/**
+ * Symbol informujący o tym, że powinien zostać uruchomiony
+ * binarny tryb wsadowy.
+ */
+#define BINARY_MODE_SYMBOL 'R'
+
+/**
+ * Opcja programu włączająca potokowy tryb wsadowy.
+ */
+#define PIPELINED_OPTION 'p'
+
 /**
  * Z góry ustalona minimalna szerokość terminala,
  * dla której komunikaty trybu interaktywnego będą wypisywane poprawnie.
@@ -44,6 +59,11 @@
  */
 static gamma_t *game_pointer = NULL;
 
+/**
+ * Czy tryb wsadowy ma być uruchomiony jako potokowy.
+ */
+static bool is_batch_mode_pipelined = false;
+
 /** @brief Zwalnia pamięć odpowiadającą za grę.
  * Zwalnia strukturę gry poprzez wywołanie @ref gamma_delete.
  * Funkcja używana jedynie przez funkcję atexit.
@@ -76,14 +96,15 @@ static bool are_parameters_in_bound(command_t *command) {
 
 /** @brief Sprawdza poprawność symbolu trybu.
  * Sprawdza, czy symbol oznaczający tryb jest poprawny,
- * czyli równy @p INTERACTIVE_MODE_SYMBOL
- * lub @p BATCH_MODE_SYMBOL.
+ * czyli równy @p INTERACTIVE_MODE_SYMBOL, @p BATCH_MODE_SYMBOL
+ * lub @p BINARY_MODE_SYMBOL.
  * @param[in] sign          – symbol.
  * @return Wartość @p true jeśli symbol jest poprawny
  * lub @p false w przeciwnym wypadku.
  */
 static inline bool is_command_sign_correct(char sign) {
-    return (sign == INTERACTIVE_MODE_SYMBOL || sign == BATCH_MODE_SYMBOL);
+    return (sign == INTERACTIVE_MODE_SYMBOL || sign == BATCH_MODE_SYMBOL ||
+            sign == BINARY_MODE_SYMBOL);
 }
 
 /** @brief Sprawdza poprawność polecenia utworzenia nowej gry.
@@ -163,10 +184,24 @@ static bool run_mode(command_t *command, uint32_t *lines) {
         return false;
     }
     else if(command->type == BATCH_MODE_SYMBOL) {
-        printf("OK %u\n", *lines);
-        run_batch_mode(game_pointer, lines);
+        output_text("OK ");
+        output_result(*lines);
+        if(is_batch_mode_pipelined) {
+            run_pipelined_batch_mode(&game_pointer, lines);
+        }
+        else {
+            run_batch_mode(&game_pointer, lines);
+        }
+    }
+    else if(command->type == BINARY_MODE_SYMBOL) {
+        // Po tej linii wejście i wyjście składają się z rekordów binarnych.
+        output_text("OK ");
+        output_result(*lines);
+        run_binary_mode(game_pointer);
     }
     else {
+        // Tryb interaktywny wypisuje bezpośrednio na standardowe wyjście.
+        flush_output();
         if(is_terminal_size_ok(command->first_par, command->second_par,
                                command->third_par)) {
             run_interactive_mode(game_pointer, command);
@@ -184,21 +219,48 @@ static bool run_mode(command_t *command, uint32_t *lines) {
 
 /** @brief Główna funkcja programu.
  * Sczytuje komendy do momentu uruchomienia któregoś z trybów gry.
- * @return 0, jeśli program zakończył się w poprawny sposób.
+ * Polecenia są czytane z pliku podanego jako jedyny argument programu
+ * lub ze standardowego wejścia, jeśli go nie podano. Opcja -p włącza
+ * potokowy tryb wsadowy.
+ * @param[in] argc          – liczba argumentów programu,
+ * @param[in] argv          – argumenty programu.
+ * @return 0, jeśli program zakończył się w poprawny sposób,
+ * lub EXIT_FAILURE, jeśli argumenty są niepoprawne
+ * lub nie udało się otworzyć pliku z poleceniami.
  * W innym wypadku następuje wyjście z programu w innym miejscu.
  */
-int main() {
+int main(int argc, char *argv[]) {
+    int option;
+    bool are_arguments_correct = true;
+    while((option = getopt(argc, argv, "p")) != -1) {
+        if(option == PIPELINED_OPTION) {
+            is_batch_mode_pipelined = true;
+        }
+        else {
+            are_arguments_correct = false;
+        }
+    }
+    if(!are_arguments_correct || argc - optind > 1) {
+        fprintf(stderr, "Usage: %s [-p] [command file]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    else if(optind < argc && !open_input(argv[optind])) {
+        perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+    atexit(flush_output);
     atexit(free_game_memory);
+    set_errors_coalesced(!isatty(STDERR_FILENO));
 
     uint32_t lines = 0;
     bool right_command = false;
     command_t command;
-    while(!feof(stdin) && !right_command) {
+    while(!is_input_finished() && !right_command) {
         lines++;
         if(read_command(&command, &lines)) {
             right_command = check_command_correctness(&command, lines);
         }
-        else if(!feof(stdin)){
+        else if(!is_input_finished()){
             print_error(lines);
         }
 
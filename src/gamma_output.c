@@ -0,0 +1,303 @@
+/** @file
+ * Implementacja modułu buforującego wyjście gry gamma.
+ *
+ * @author Adam Boguszewski <ab417730@students.mimuw.edu.pl>
+ * @copyright Uniwersytet Warszawski
+ * @date 3.05.2020
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "gamma_output.h"
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/**
+ * Rozmiar bufora każdego ze strumieni wyjścia.
+ */
+#define OUTPUT_BUFFER_SIZE 65536
+
+/**
+ * Liczba buforów. Bez wątku zapisującego używane są tylko dwa pierwsze,
+ * po jednym na strumień. Z wątkiem pozostałe czekają na zapis
+ * lub na ponowne użycie.
+ */
+#define OUTPUT_BUFFERS_COUNT 8
+
+/**
+ * Największa liczba cyfr liczby typu uint64_t.
+ */
+#define MAX_NUMBER_DIGITS 20
+
+/**
+ * Struktura przechowująca bufor danych wyjścia.
+ */
+typedef struct {
+    int fd;                         ///< Deskryptor, do którego trafia bufor.
+    size_t used;                    ///< Liczba zajętych bajtów bufora.
+    char data[OUTPUT_BUFFER_SIZE];  ///< Bufor.
+} output_buffer;
+
+/**
+ * Struktura przechowująca stan jednego strumienia wyjścia.
+ */
+typedef struct {
+    bool line_buffered;             ///< Czy zapisywać każdą dokończoną linię.
+    output_buffer *buffer;          ///< Aktualnie wypełniany bufor.
+} output_stream;
+
+/**
+ * Wszystkie bufory wyjścia.
+ */
+static output_buffer buffers[OUTPUT_BUFFERS_COUNT] = {
+    [0] = {.fd = STDOUT_FILENO}, [1] = {.fd = STDERR_FILENO}
+};
+
+/**
+ * Standardowe wyjście.
+ */
+static output_stream standard_output = {.buffer = &buffers[0]};
+
+/**
+ * Standardowe wyjście diagnostyczne. Domyślnie każdy komunikat
+ * jest zapisywany od razu, jak przy niebuforowanym strumieniu stderr.
+ */
+static output_stream error_output = {.line_buffered = true,
+                                     .buffer = &buffers[1]};
+
+/**
+ * Stan wątku zapisującego. Wszystkie pola poza @p is_running
+ * są chronione blokadą @p mutex.
+ */
+static struct {
+    bool is_running;                ///< Czy wątek działa; zmieniane tylko
+                                    ///< przez wątek piszący na wyjście.
+    pthread_t thread;               ///< Wątek zapisujący.
+    pthread_mutex_t mutex;          ///< Blokada stanu wątku.
+    pthread_cond_t changed;         ///< Zmienna warunkowa zmiany stanu.
+    output_buffer *pending[OUTPUT_BUFFERS_COUNT]; ///< Kolejka buforów
+                                                  ///< czekających na zapis.
+    size_t pending_begin;           ///< Początek kolejki @p pending.
+    size_t pending_count;           ///< Długość kolejki @p pending.
+    output_buffer *spare[OUTPUT_BUFFERS_COUNT];   ///< Wolne bufory.
+    size_t spare_count;             ///< Liczba wolnych buforów.
+    bool is_writing;                ///< Czy wątek zapisuje właśnie bufor.
+    bool should_stop;               ///< Czy wątek ma się zakończyć.
+} writer = {.mutex = PTHREAD_MUTEX_INITIALIZER,
+            .changed = PTHREAD_COND_INITIALIZER};
+
+/** @brief Zapisuje zawartość bufora.
+ * Ponawia zapis po częściowym zapisie lub przerwaniu przez sygnał.
+ * Jeśli zapis się nie powiedzie, zawartość bufora jest porzucana,
+ * tak jak w przypadku strumieni biblioteki standardowej.
+ * @param[in,out] buffer    – bufor.
+ */
+static void write_buffer(output_buffer *buffer) {
+    const char *data = buffer->data;
+    size_t size = buffer->used;
+    while (size > 0) {
+        ssize_t written = write(buffer->fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (written < 0) {
+            break;
+        }
+        data += written;
+        size -= written;
+    }
+    buffer->used = 0;
+}
+
+/** @brief Zapisuje kolejne bufory przekazane wątkowi zapisującemu.
+ * Kończy działanie, gdy kolejka jest pusta, a wątek ma się zakończyć.
+ * @param[in] argument      – nieużywany.
+ * @return Wartość NULL.
+ */
+static void* run_writer(void *argument) {
+    (void) argument;
+    pthread_mutex_lock(&writer.mutex);
+    while (true) {
+        while (writer.pending_count == 0 && !writer.should_stop) {
+            pthread_cond_wait(&writer.changed, &writer.mutex);
+        }
+        if (writer.pending_count == 0) {
+            break;
+        }
+        output_buffer *buffer = writer.pending[writer.pending_begin];
+        writer.pending_begin = (writer.pending_begin + 1) % OUTPUT_BUFFERS_COUNT;
+        writer.pending_count--;
+        writer.is_writing = true;
+        pthread_mutex_unlock(&writer.mutex);
+
+        write_buffer(buffer);
+
+        pthread_mutex_lock(&writer.mutex);
+        writer.spare[writer.spare_count++] = buffer;
+        writer.is_writing = false;
+        pthread_cond_broadcast(&writer.changed);
+    }
+    pthread_mutex_unlock(&writer.mutex);
+    return NULL;
+}
+
+/** @brief Zapisuje bufor strumienia.
+ * Bez wątku zapisującego zapisuje bufor od razu. W przeciwnym wypadku
+ * przekazuje bufor wątkowi i bierze do wypełniania wolny bufor, czekając
+ * na niego tylko wtedy, gdy wszystkie czekają na zapis.
+ * @param[in,out] stream    – strumień.
+ */
+static void flush_stream(output_stream *stream) {
+    output_buffer *buffer = stream->buffer;
+    if (buffer->used == 0) {
+        return;
+    }
+    else if (!writer.is_running) {
+        write_buffer(buffer);
+        return;
+    }
+
+    pthread_mutex_lock(&writer.mutex);
+    writer.pending[(writer.pending_begin + writer.pending_count) %
+                   OUTPUT_BUFFERS_COUNT] = buffer;
+    writer.pending_count++;
+    pthread_cond_broadcast(&writer.changed);
+    while (writer.spare_count == 0) {
+        pthread_cond_wait(&writer.changed, &writer.mutex);
+    }
+    stream->buffer = writer.spare[--writer.spare_count];
+    pthread_mutex_unlock(&writer.mutex);
+
+    stream->buffer->fd = buffer->fd;
+}
+
+/** @brief Dopisuje dane do strumienia.
+ * Zapisuje bufor, gdy się zapełni, a w przypadku strumienia buforowanego
+ * liniami także wtedy, gdy dane kończą się znakiem końca linii.
+ * @param[in,out] stream    – strumień,
+ * @param[in] data          – dopisywane dane,
+ * @param[in] size          – liczba bajtów danych.
+ */
+static void append(output_stream *stream, const char *data, size_t size) {
+    while (size > 0) {
+        if (stream->buffer->used == OUTPUT_BUFFER_SIZE) {
+            flush_stream(stream);
+        }
+        output_buffer *buffer = stream->buffer;
+        size_t chunk = OUTPUT_BUFFER_SIZE - buffer->used;
+        if (chunk > size) {
+            chunk = size;
+        }
+        memcpy(buffer->data + buffer->used, data, chunk);
+        buffer->used += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+    if (stream->line_buffered && stream->buffer->used > 0 &&
+        stream->buffer->data[stream->buffer->used - 1] == '\n') {
+        flush_stream(stream);
+    }
+}
+
+/** @brief Dopisuje liczbę do strumienia.
+ * Zamienia liczbę na cyfry od najmniej znaczącej, bez użycia printf.
+ * @param[in,out] stream    – strumień,
+ * @param[in] number        – liczba,
+ * @param[in] newline       – czy dopisać po liczbie znak końca linii.
+ */
+static void append_number(output_stream *stream, uint64_t number,
+                          bool newline) {
+    char digits[MAX_NUMBER_DIGITS + 1];
+    size_t begin = MAX_NUMBER_DIGITS;
+    if (newline) {
+        digits[MAX_NUMBER_DIGITS] = '\n';
+    }
+    do {
+        digits[--begin] = (char) ('0' + number % 10);
+        number /= 10;
+    } while (number > 0);
+    append(stream, digits + begin, MAX_NUMBER_DIGITS - begin + newline);
+}
+
+void output_text(const char *text) {
+    append(&standard_output, text, strlen(text));
+}
+
+void output_number(uint64_t number) {
+    append_number(&standard_output, number, false);
+}
+
+void output_result(uint64_t result) {
+    // Większość wyników to 0 lub 1, które nie wymagają zamiany.
+    if (result <= 1) {
+        append(&standard_output, result ? "1\n" : "0\n", 2);
+    }
+    else {
+        append_number(&standard_output, result, true);
+    }
+}
+
+void output_data(const void *data, size_t size) {
+    append(&standard_output, data, size);
+}
+
+void error_text(const char *text) {
+    append(&error_output, text, strlen(text));
+}
+
+void error_number(uint64_t number) {
+    append_number(&error_output, number, false);
+}
+
+void set_errors_coalesced(bool coalesce) {
+    flush_stream(&error_output);
+    error_output.line_buffered = !coalesce;
+}
+
+void flush_output() {
+    flush_stream(&standard_output);
+    flush_stream(&error_output);
+    if (writer.is_running) {
+        pthread_mutex_lock(&writer.mutex);
+        while (writer.pending_count > 0 || writer.is_writing) {
+            pthread_cond_wait(&writer.changed, &writer.mutex);
+        }
+        pthread_mutex_unlock(&writer.mutex);
+    }
+}
+
+bool start_output_writer() {
+    if (writer.is_running) {
+        return true;
+    }
+
+    writer.spare_count = 0;
+    for (size_t i = 0; i < OUTPUT_BUFFERS_COUNT; i++) {
+        if (&buffers[i] != standard_output.buffer &&
+            &buffers[i] != error_output.buffer) {
+            writer.spare[writer.spare_count++] = &buffers[i];
+        }
+    }
+    writer.pending_begin = writer.pending_count = 0;
+    writer.should_stop = false;
+    if (pthread_create(&writer.thread, NULL, run_writer, NULL) != 0) {
+        return false;
+    }
+    writer.is_running = true;
+    return true;
+}
+
+void stop_output_writer() {
+    if (!writer.is_running) {
+        return;
+    }
+
+    flush_output();
+    pthread_mutex_lock(&writer.mutex);
+    writer.should_stop = true;
+    pthread_cond_broadcast(&writer.changed);
+    pthread_mutex_unlock(&writer.mutex);
+    pthread_join(writer.thread, NULL);
+    writer.is_running = false;
+}
@@ -0,0 +1,81 @@
+/** @file
+ * Interfejs modułu buforującego wyjście gry gamma.
+ *
+ * @author Adam Boguszewski <ab417730@students.mimuw.edu.pl>
+ * @copyright Uniwersytet Warszawski
+ * @date 3.05.2020
+ */
+#ifndef GAMMA_GAMMA_OUTPUT_H
+#define GAMMA_GAMMA_OUTPUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Dopisuje napis do standardowego wyjścia.
+ * Napis trafia do bufora, który jest zapisywany, gdy się zapełni
+ * lub przy wywołaniu funkcji @ref flush_output.
+ * @param[in] text          – napis.
+ */
+void output_text(const char *text);
+
+/** @brief Dopisuje liczbę do standardowego wyjścia.
+ * @param[in] number        – liczba zapisywana dziesiętnie.
+ */
+void output_number(uint64_t number);
+
+/** @brief Dopisuje do standardowego wyjścia wynik polecenia.
+ * Wypisuje liczbę @p result i znak końca linii.
+ * @param[in] result        – wynik polecenia.
+ */
+void output_result(uint64_t result);
+
+/** @brief Dopisuje dane binarne do standardowego wyjścia.
+ * @param[in] data          – wskaźnik na dane,
+ * @param[in] size          – liczba bajtów danych.
+ */
+void output_data(const void *data, size_t size);
+
+/** @brief Dopisuje napis do standardowego wyjścia diagnostycznego.
+ * Jeśli komunikaty o błędach nie są łączone, każda dokończona linia
+ * jest od razu zapisywana jednym wywołaniem systemowym.
+ * @param[in] text          – napis.
+ */
+void error_text(const char *text);
+
+/** @brief Dopisuje liczbę do standardowego wyjścia diagnostycznego.
+ * @param[in] number        – liczba zapisywana dziesiętnie.
+ */
+void error_number(uint64_t number);
+
+/** @brief Włącza lub wyłącza łączenie komunikatów o błędach.
+ * Połączone komunikaty są zapisywane razem z resztą wyjścia przy wywołaniu
+ * funkcji @ref flush_output lub po zapełnieniu bufora.
+ * @param[in] coalesce      – czy łączyć komunikaty.
+ */
+void set_errors_coalesced(bool coalesce);
+
+/** @brief Zapisuje zawartość buforów wyjścia.
+ * Należy ją wywołać przed czekaniem na wejście oraz przed każdym
+ * zapisem na standardowe wyjście z pominięciem tego modułu.
+ * Jeśli działa wątek zapisujący, czeka, aż zapisze on wszystkie bufory.
+ */
+void flush_output();
+
+/** @brief Uruchamia wątek zapisujący wyjście.
+ * Od tej pory zapełnione bufory są przekazywane temu wątkowi, a wątek
+ * piszący na wyjście od razu wypełnia kolejny bufor. Kolejność zapisu
+ * buforów obu strumieni jest zachowana. Funkcje modułu nadal może
+ * wywoływać tylko jeden wątek.
+ * @return Wartość @p true, jeśli wątek działa, lub @p false, jeśli nie
+ * udało się go utworzyć; wtedy wyjście jest zapisywane jak dotąd.
+ */
+bool start_output_writer();
+
+/** @brief Zatrzymuje wątek zapisujący wyjście.
+ * Zapisuje zawartość buforów i czeka na zakończenie wątku uruchomionego
+ * funkcją @ref start_output_writer. Nic nie robi, jeśli wątek nie działa.
+ */
+void stop_output_writer();
+
+#endif //GAMMA_GAMMA_OUTPUT_H
@@ -0,0 +1,216 @@
+/** @file
+ * Implementacja kolejki cyklicznej dla jednego producenta i jednego konsumenta.
+ *
+ * @author Adam Boguszewski <ab417730@students.mimuw.edu.pl>
+ * @copyright Uniwersytet Warszawski
+ * @date 4.05.2020
+ */
+
+#include "gamma_ring.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/**
+ * Rozmiar linii pamięci podręcznej. Pola zmieniane przez producenta
+ * i przez konsumenta leżą w osobnych liniach, aby wątki nie unieważniały
+ * sobie nawzajem pamięci podręcznej przy każdym elemencie.
+ */
+#define CACHE_LINE_SIZE 64
+
+/**
+ * Liczba sprawdzeń stanu kolejki, zanim czekający wątek zaśnie.
+ */
+#define RING_SPIN_COUNT 1024
+
+/**
+ * Co ile elementów producent udostępnia dodane elementy, a konsument
+ * zwalnia zdjęte. Drugi wątek jest budzony najwyżej raz na tyle
+ * elementów, a nie przy każdym.
+ */
+#define RING_BATCH_SIZE 64
+
+/**
+ * Struktura przechowująca kolejkę. Pozycje @p head i @p tail rosną
+ * bez ograniczeń, a element o pozycji i leży w komórce i & @p mask.
+ */
+struct ring {
+    alignas(CACHE_LINE_SIZE)
+    atomic_size_t head;             ///< Pozycja pierwszego niezwolnionego
+                                    ///< elementu.
+    size_t next_head;               ///< Pozycja pierwszego niezdjętego
+                                    ///< elementu.
+    size_t cached_tail;             ///< Ostatnio odczytana przez konsumenta
+                                    ///< wartość @p tail.
+
+    alignas(CACHE_LINE_SIZE)
+    atomic_size_t tail;             ///< Pozycja za ostatnim udostępnionym
+                                    ///< elementem.
+    size_t next_tail;               ///< Pozycja za ostatnim dodanym
+                                    ///< elementem.
+    size_t cached_head;             ///< Ostatnio odczytana przez producenta
+                                    ///< wartość @p head.
+
+    // Flagi czekania są czytane przy każdym elemencie,
+    // a zmieniane tylko przy zasypianiu.
+    alignas(CACHE_LINE_SIZE)
+    atomic_bool is_consumer_waiting;///< Czy konsument czeka na element.
+    atomic_bool is_producer_waiting;///< Czy producent czeka na miejsce.
+    pthread_mutex_t mutex;          ///< Blokada używana tylko do zaśnięcia.
+    pthread_cond_t changed;         ///< Zmienna warunkowa budząca wątek.
+    size_t mask;                    ///< Liczba komórek pomniejszona o 1.
+    size_t element_size;            ///< Rozmiar elementu w bajtach.
+    char *elements;                 ///< Tablica komórek.
+};
+
+ring_t* ring_new(size_t capacity, size_t element_size) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        element_size == 0 || capacity > SIZE_MAX / element_size) {
+        return NULL;
+    }
+
+    ring_t *ring = aligned_alloc(CACHE_LINE_SIZE, sizeof(ring_t));
+    if (ring == NULL) {
+        return NULL;
+    }
+    ring->elements = malloc(capacity * element_size);
+    if (ring->elements == NULL ||
+        pthread_mutex_init(&ring->mutex, NULL) != 0) {
+        free(ring->elements);
+        free(ring);
+        return NULL;
+    }
+    if (pthread_cond_init(&ring->changed, NULL) != 0) {
+        pthread_mutex_destroy(&ring->mutex);
+        free(ring->elements);
+        free(ring);
+        return NULL;
+    }
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->is_consumer_waiting, false);
+    atomic_init(&ring->is_producer_waiting, false);
+    ring->next_head = ring->next_tail = 0;
+    ring->cached_head = ring->cached_tail = 0;
+    ring->mask = capacity - 1;
+    ring->element_size = element_size;
+    return ring;
+}
+
+void ring_delete(ring_t *ring) {
+    if (ring != NULL) {
+        pthread_cond_destroy(&ring->changed);
+        pthread_mutex_destroy(&ring->mutex);
+        free(ring->elements);
+        free(ring);
+    }
+}
+
+/** @brief Czeka, aż pozycja przestanie mieć daną wartość.
+ * Najpierw sprawdza pozycję w pętli, a potem zasypia na zmiennej
+ * warunkowej. Flaga @p is_waiting jest ustawiana przed ostatnim
+ * sprawdzeniem pozycji, a druga strona czyta ją po przesunięciu pozycji,
+ * więc przy sekwencyjnie spójnych operacjach pobudka nie może zginąć.
+ * @param[in,out] ring      – wskaźnik na kolejkę,
+ * @param[in] position      – pozycja zmieniana przez drugi wątek,
+ * @param[in] value         – wartość, przy której trzeba czekać,
+ * @param[in,out] is_waiting – flaga czekania wątku wywołującego,
+ * @param[in] before_sleep  – funkcja wywoływana przed zaśnięciem lub NULL.
+ */
+static void wait_while_equal(ring_t *ring, atomic_size_t *position,
+                             size_t value, atomic_bool *is_waiting,
+                             void (*before_sleep)()) {
+    for (int i = 0; i < RING_SPIN_COUNT; i++) {
+        if (atomic_load_explicit(position, memory_order_acquire) != value) {
+            return;
+        }
+    }
+
+    if (before_sleep != NULL) {
+        before_sleep();
+    }
+    pthread_mutex_lock(&ring->mutex);
+    atomic_store(is_waiting, true);
+    while (atomic_load(position) == value) {
+        pthread_cond_wait(&ring->changed, &ring->mutex);
+    }
+    atomic_store(is_waiting, false);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+/** @brief Budzi drugi wątek, jeśli na to czeka.
+ * Funkcję należy wywołać po przesunięciu pozycji kolejki.
+ * @param[in,out] ring      – wskaźnik na kolejkę,
+ * @param[in] is_waiting    – flaga czekania drugiego wątku.
+ */
+static void wake_up(ring_t *ring, atomic_bool *is_waiting) {
+    if (atomic_load(is_waiting)) {
+        pthread_mutex_lock(&ring->mutex);
+        pthread_cond_broadcast(&ring->changed);
+        pthread_mutex_unlock(&ring->mutex);
+    }
+}
+
+/** @brief Zwalnia zdjęte elementy.
+ * Udostępnia producentowi komórki elementów zdjętych przez konsumenta.
+ * @param[in,out] ring      – wskaźnik na kolejkę.
+ */
+static void release(ring_t *ring) {
+    atomic_store(&ring->head, ring->next_head);
+    wake_up(ring, &ring->is_producer_waiting);
+}
+
+void ring_publish(ring_t *ring) {
+    if (atomic_load_explicit(&ring->tail, memory_order_relaxed) !=
+        ring->next_tail) {
+        atomic_store(&ring->tail, ring->next_tail);
+        wake_up(ring, &ring->is_consumer_waiting);
+    }
+}
+
+void ring_push(ring_t *ring, const void *element) {
+    size_t tail = ring->next_tail;
+    if (tail - ring->cached_head > ring->mask) {
+        // Konsument musi widzieć wszystkie elementy, aby zwolnić miejsce.
+        ring_publish(ring);
+        wait_while_equal(ring, &ring->head, tail - ring->mask - 1,
+                         &ring->is_producer_waiting, NULL);
+        ring->cached_head = atomic_load_explicit(&ring->head,
+                                                 memory_order_acquire);
+    }
+
+    memcpy(ring->elements + (tail & ring->mask) * ring->element_size,
+           element, ring->element_size);
+    ring->next_tail = tail + 1;
+    if (ring->next_tail - atomic_load_explicit(&ring->tail,
+                                               memory_order_relaxed) >=
+        RING_BATCH_SIZE) {
+        ring_publish(ring);
+    }
+}
+
+void ring_pop(ring_t *ring, void *element, void (*before_sleep)()) {
+    size_t head = ring->next_head;
+    if (head == ring->cached_tail) {
+        // Producent musi mieć całe wolne miejsce, aby dodać kolejne.
+        release(ring);
+        wait_while_equal(ring, &ring->tail, head, &ring->is_consumer_waiting,
+                         before_sleep);
+        ring->cached_tail = atomic_load_explicit(&ring->tail,
+                                                 memory_order_acquire);
+    }
+
+    memcpy(element, ring->elements + (head & ring->mask) * ring->element_size,
+           ring->element_size);
+    ring->next_head = head + 1;
+    if (ring->next_head - atomic_load_explicit(&ring->head,
+                                               memory_order_relaxed) >=
+        RING_BATCH_SIZE) {
+        release(ring);
+    }
+}
@@ -0,0 +1,65 @@
+/** @file
+ * Interfejs kolejki cyklicznej dla jednego producenta i jednego konsumenta.
+ *
+ * @author Adam Boguszewski <ab417730@students.mimuw.edu.pl>
+ * @copyright Uniwersytet Warszawski
+ * @date 4.05.2020
+ */
+#ifndef GAMMA_GAMMA_RING_H
+#define GAMMA_GAMMA_RING_H
+
+#include <stddef.h>
+
+/**
+ * Struktura przechowująca kolejkę.
+ */
+typedef struct ring ring_t;
+
+/** @brief Tworzy kolejkę.
+ * Alokuje pamięć na kolejkę mieszczącą @p capacity elementów
+ * o rozmiarze @p element_size bajtów każdy. Elementy może dodawać
+ * jeden wątek i zdejmować jeden, inny wątek. Żaden z nich nie zakłada
+ * blokady, dopóki kolejka nie jest pusta ani pełna.
+ * @param[in] capacity      – liczba elementów, potęga dwójki,
+ * @param[in] element_size  – rozmiar elementu w bajtach.
+ * @return Wskaźnik na utworzoną kolejkę lub NULL, gdy nie udało się
+ * zaalokować pamięci lub któryś z parametrów jest niepoprawny.
+ */
+ring_t* ring_new(size_t capacity, size_t element_size);
+
+/** @brief Usuwa kolejkę.
+ * Usuwa z pamięci kolejkę wskazywaną przez @p ring.
+ * Nic nie robi, jeśli wskaźnik ten ma wartość NULL.
+ * @param[in] ring          – wskaźnik na usuwaną kolejkę.
+ */
+void ring_delete(ring_t *ring);
+
+/** @brief Dodaje element na koniec kolejki.
+ * Dodane elementy są udostępniane konsumentowi grupami, więc element może
+ * nie być widoczny dla konsumenta do wywołania funkcji @ref ring_publish.
+ * Jeśli kolejka jest pełna, czeka, aż konsument zdejmie z niej elementy.
+ * Funkcję może wywoływać tylko wątek producenta.
+ * @param[in,out] ring      – wskaźnik na kolejkę,
+ * @param[in] element       – wskaźnik na kopiowany element.
+ */
+void ring_push(ring_t *ring, const void *element);
+
+/** @brief Udostępnia konsumentowi wszystkie dodane elementy.
+ * Producent powinien ją wywołać, zanim zacznie na coś czekać, oraz
+ * po dodaniu ostatniego elementu. Funkcję może wywoływać tylko wątek
+ * producenta.
+ * @param[in,out] ring      – wskaźnik na kolejkę.
+ */
+void ring_publish(ring_t *ring);
+
+/** @brief Zdejmuje element z początku kolejki.
+ * Jeśli kolejka jest pusta, czeka, aż producent doda do niej element.
+ * Zanim wątek zaśnie, wywołuje funkcję @p before_sleep, o ile nie jest
+ * ona równa NULL. Funkcję może wywoływać tylko wątek konsumenta.
+ * @param[in,out] ring      – wskaźnik na kolejkę,
+ * @param[out] element      – wskaźnik, pod który kopiowany jest element,
+ * @param[in] before_sleep  – funkcja wywoływana przed zaśnięciem lub NULL.
+ */
+void ring_pop(ring_t *ring, void *element, void (*before_sleep)());
+
+#endif //GAMMA_GAMMA_RING_H
@@ -11,11 +11,20 @@
 #undef NDEBUG
 #endif
 
+#define _GNU_SOURCE
+
 #include "gamma.h"
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 
 /**
  * Tak ma wyglądać plansza po wykonaniu wszystkich testów.
@@ -32,6 +41,672 @@ static const char board[] =
   "1221......\n"
   "1.........\n";
 
+#ifdef GAMMA_PROGRAM
+/**
+ * Rozmiar buforów na wyjścia programu gamma zbierane przez funkcję
+ * @ref run_program.
+ */
+#define PROGRAM_OUTPUT_SIZE 65536
+
+/**
+ * Wzorzec nazwy pliku tymczasowego z poleceniami dla funkcji mkstemp.
+ */
+#define COMMAND_FILE_TEMPLATE "/tmp/gamma_test_XXXXXX"
+
+/**
+ * Wyjścia programu gamma zebrane przez funkcję @ref run_program.
+ */
+typedef struct {
+  char output[PROGRAM_OUTPUT_SIZE]; ///< standardowe wyjście
+  size_t output_size;               ///< liczba bajtów standardowego wyjścia
+  char errors[PROGRAM_OUTPUT_SIZE]; ///< wyjście diagnostyczne
+  size_t errors_size;               ///< liczba bajtów wyjścia diagnostycznego
+} program_result;
+
+/** @brief Uruchamia program gamma.
+ * Łączy standardowe wejście i wyjście programu z potokami, a deskryptor
+ * @p journal udostępnia mu pod numerem 9.
+ * @param[in] option     – opcja programu lub NULL,
+ * @param[in] path       – plik z poleceniami podawany jako argument
+ *                         programu lub NULL,
+ * @param[out] input     – deskryptor do pisania na wejście programu,
+ * @param[out] output    – deskryptor do czytania wyjścia programu,
+ * @param[out] errors    – deskryptor do czytania wyjścia diagnostycznego
+ *                         programu lub NULL, jeśli program ma pisać
+ *                         na wyjście diagnostyczne testu,
+ * @param[in] journal    – deskryptor pliku przekazywanego programowi.
+ * @return Identyfikator procesu programu.
+ */
+static pid_t start_program(const char *option, const char *path, int *input,
+                           int *output, int *errors, int journal) {
+  int to_program[2], from_program[2], errors_pipe[2];
+  assert(pipe(to_program) == 0 && pipe(from_program) == 0);
+  assert(errors == NULL || pipe(errors_pipe) == 0);
+  pid_t pid = fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    dup2(to_program[0], STDIN_FILENO);
+    dup2(from_program[1], STDOUT_FILENO);
+    if (errors != NULL) {
+      dup2(errors_pipe[1], STDERR_FILENO);
+      close(errors_pipe[0]);
+    }
+    dup2(journal, 9);
+    close(to_program[1]);
+    close(from_program[0]);
+    const char *arguments[4] = {GAMMA_PROGRAM};
+    int count = 1;
+    if (option != NULL) {
+      arguments[count++] = option;
+    }
+    if (path != NULL) {
+      arguments[count++] = path;
+    }
+    arguments[count] = NULL;
+    execv(GAMMA_PROGRAM, (char *const *) arguments);
+    _exit(EXIT_FAILURE);
+  }
+  close(to_program[0]);
+  close(from_program[1]);
+  *input = to_program[1];
+  *output = from_program[0];
+  if (errors != NULL) {
+    close(errors_pipe[1]);
+    *errors = errors_pipe[0];
+  }
+  return pid;
+}
+
+/** @brief Uruchamia program gamma i zbiera jego wyjścia.
+ * Pisze @p size bajtów danych @p data na wejście programu, a następnie
+ * je zamyka, i czyta oba wyjścia programu aż do ich zamknięcia.
+ * @param[in] option     – opcja programu lub NULL,
+ * @param[in] path       – plik z poleceniami podawany jako argument
+ *                         programu lub NULL,
+ * @param[in] data       – dane wejścia,
+ * @param[in] size       – liczba bajtów danych wejścia,
+ * @param[in] journal    – deskryptor pliku przekazywanego programowi,
+ * @param[out] result    – wyjścia programu.
+ */
+static void run_program(const char *option, const char *path,
+                        const char *data, size_t size, int journal,
+                        program_result *result) {
+  int input, output, errors;
+  pid_t pid = start_program(option, path, &input, &output, &errors, journal);
+  // Program może skończyć, zanim przeczyta całe wejście.
+  signal(SIGPIPE, SIG_IGN);
+  result->output_size = result->errors_size = 0;
+  struct pollfd fds[3] = {{.fd = input, .events = POLLOUT},
+                          {.fd = output, .events = POLLIN},
+                          {.fd = errors, .events = POLLIN}};
+  if (size == 0) {
+    close(input);
+    fds[0].fd = -1;
+  }
+  while (fds[0].fd >= 0 || fds[1].fd >= 0 || fds[2].fd >= 0) {
+    assert(poll(fds, 3, 10000) > 0);
+    if (fds[0].revents != 0) {
+      ssize_t count = write(input, data, size);
+      if (count > 0) {
+        data += count;
+        size -= count;
+      }
+      if (count <= 0 || size == 0) {
+        close(input);
+        fds[0].fd = -1;
+      }
+    }
+    for (int i = 1; i < 3; i++) {
+      char *buffer = (i == 1) ? result->output : result->errors;
+      size_t *used = (i == 1) ? &result->output_size : &result->errors_size;
+      if (fds[i].revents != 0) {
+        assert(*used < PROGRAM_OUTPUT_SIZE);
+        ssize_t count = read(fds[i].fd, buffer + *used,
+                             PROGRAM_OUTPUT_SIZE - *used);
+        if (count <= 0) {
+          close(fds[i].fd);
+          fds[i].fd = -1;
+        }
+        else {
+          *used += count;
+        }
+      }
+    }
+  }
+  int status;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+/** @brief Sprawdza wyjścia programu gamma.
+ * @param[in] result     – wyjścia programu,
+ * @param[in] output     – oczekiwane standardowe wyjście,
+ * @param[in] errors     – oczekiwane wyjście diagnostyczne.
+ * @return Wartość @p true, jeśli wyjścia są równe oczekiwanym,
+ * a @p false w przeciwnym przypadku.
+ */
+static bool has_output(const program_result *result, const char *output,
+                       const char *errors) {
+  return result->output_size == strlen(output) &&
+         memcmp(result->output, output, result->output_size) == 0 &&
+         result->errors_size == strlen(errors) &&
+         memcmp(result->errors, errors, result->errors_size) == 0;
+}
+
+/** @brief Testuje przetwarzanie linii wejścia trybu wsadowego.
+ * Sprawdza pomijanie komentarzy i pustych linii, w tym pustej pierwszej
+ * linii, linie zakończone znakami \r\n, polecenia bez spacji po literze,
+ * z nadmiarowym parametrem, ze znakiem '\0' i bez znaku końca linii,
+ * oraz liczby poza zakresem typu uint32_t i typu long, z których
+ * te drugie parser zamienia na zero.
+ */
+static void test_batch_parser() {
+  static const char commands[] =
+    "\n"
+    "# komentarz\n"
+    "B 3 3 2 2\r\n"
+    "m1\n"
+    "m 1 0 0\r\n"
+    "\n"
+    "#\n"
+    "m 1 1 0 0 0\n"
+    "m 1 4294967296 0\n"
+    "m 2 1 99999999999999999999\n"
+    "m 2 1\0 1\n"
+    "b 1\n"
+    "p\n"
+    "m 2 2 2";
+  static program_result result;
+  run_program(NULL, NULL, commands, sizeof(commands) - 1, -1, &result);
+  assert(has_output(&result, "OK 3\n1\n1\n1\n...\n...\n12.\n",
+                    "ERROR 4\nERROR 8\nERROR 9\nERROR 11\nERROR 14\n"));
+}
+
+/** @brief Zapisuje polecenia do pliku tymczasowego.
+ * @param[in] data       – polecenia,
+ * @param[in] size       – liczba bajtów poleceń,
+ * @param[out] path      – tablica na ścieżkę pliku, który należy usunąć
+ *                         po zakończeniu testu.
+ */
+static void create_command_file(const char *data, size_t size,
+                                char path[sizeof(COMMAND_FILE_TEMPLATE)]) {
+  strcpy(path, COMMAND_FILE_TEMPLATE);
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  assert(write(fd, data, size) == (ssize_t) size);
+  close(fd);
+}
+
+/** @brief Usuwa numery procesów z linii zapisu w tle.
+ * Numer procesu zapisującego grę w tle jest inny przy każdym
+ * uruchomieniu programu, więc przed porównaniem wyjść linie
+ * "SNAPSHOT pid ..." są zamieniane na "SNAPSHOT ...".
+ * @param[in, out] result – wyjścia programu.
+ */
+static void remove_snapshot_pids(program_result *result) {
+  static const char prefix[] = "SNAPSHOT ";
+  size_t used = 0;
+  for (size_t i = 0; i < result->errors_size;) {
+    if (result->errors_size - i >= sizeof(prefix) - 1 &&
+        memcmp(result->errors + i, prefix, sizeof(prefix) - 1) == 0) {
+      memmove(result->errors + used, prefix, sizeof(prefix) - 1);
+      used += sizeof(prefix) - 1;
+      i += sizeof(prefix) - 1;
+      while (i < result->errors_size && result->errors[i] >= '0' &&
+             result->errors[i] <= '9') {
+        i++;
+      }
+      i += (i < result->errors_size && result->errors[i] == ' ');
+    }
+    else {
+      result->errors[used++] = result->errors[i++];
+    }
+  }
+  result->errors_size = used;
+}
+
+/** @brief Testuje potokowy tryb wsadowy.
+ * Wykonuje ten sam skrypt z opcją -p i bez niej, czytając polecenia
+ * z potoku i z pliku podanego jako argument, i sprawdza, czy oba wyjścia,
+ * razem z wynikami, numerami błędnych linii, opisami planszy i postępem
+ * zapisu w tle, są we wszystkich przypadkach identyczne.
+ */
+static void test_pipelined_batch_mode() {
+  static const char commands[] =
+    "B 4 4 3 2\n"
+    "m 1 0 0\n"
+    "m1\n"
+    "m 2 1 1\n"
+    "g 2 0 0\n"
+    "p\n"
+    "#\n"
+    "q 1\n"
+    "x 1\n"
+    "b 2\n"
+    "f 3\n"
+    "m 3 3 3\n"
+    "m 3 5 5\n"
+    "p\n"
+    "w 9\n";
+  char path[sizeof(COMMAND_FILE_TEMPLATE)];
+  create_command_file(commands, sizeof(commands) - 1, path);
+  static program_result results[4];
+  const char *options[] = {NULL, "-p"};
+  for (int i = 0; i < 4; i++) {
+    FILE *snapshot = tmpfile();
+    assert(snapshot != NULL);
+    bool from_file = i >= 2;
+    run_program(options[i % 2], from_file ? path : NULL, commands,
+                from_file ? 0 : sizeof(commands) - 1, fileno(snapshot),
+                &results[i]);
+    fclose(snapshot);
+    remove_snapshot_pids(&results[i]);
+  }
+  unlink(path);
+
+  static const char output[] = "OK 1\n1\n1\n1\n"
+                               "....\n....\n.2..\n2...\n"
+                               "1\n2\n14\n1\n0\n"
+                               "...3\n....\n.2..\n2...\n1\n";
+  static const char errors[] = "ERROR 3\nERROR 9\nSNAPSHOT ";
+  static const char done[] = "SNAPSHOT DONE\n";
+  program_result *expected = &results[0];
+  assert(expected->output_size == sizeof(output) - 1 &&
+         memcmp(expected->output, output, sizeof(output) - 1) == 0);
+  assert(expected->errors_size > sizeof(errors) + sizeof(done) &&
+         memcmp(expected->errors, errors, sizeof(errors) - 1) == 0 &&
+         memcmp(expected->errors + expected->errors_size - sizeof(done) + 1,
+                done, sizeof(done) - 1) == 0);
+  for (int i = 1; i < 4; i++) {
+    assert(results[i].output_size == expected->output_size &&
+           memcmp(results[i].output, expected->output,
+                  expected->output_size) == 0);
+    assert(results[i].errors_size == expected->errors_size &&
+           memcmp(results[i].errors, expected->errors,
+                  expected->errors_size) == 0);
+  }
+}
+
+/** @brief Wykonuje polecenia z pliku i z potoku.
+ * Uruchamia program z plikiem poleceń podanym jako argument, który
+ * program odwzorowuje w pamięci, i z tymi samymi poleceniami
+ * na standardowym wejściu, i sprawdza, czy wyjścia są identyczne.
+ * @param[in] commands   – polecenia,
+ * @param[in] size       – liczba bajtów poleceń,
+ * @param[out] result    – wyjścia programu.
+ */
+static void run_file_and_pipe(const char *commands, size_t size,
+                              program_result *result) {
+  static program_result piped;
+  char path[sizeof(COMMAND_FILE_TEMPLATE)];
+  create_command_file(commands, size, path);
+  run_program(NULL, path, "", 0, -1, result);
+  unlink(path);
+  run_program(NULL, NULL, commands, size, -1, &piped);
+  assert(result->output_size == piped.output_size &&
+         memcmp(result->output, piped.output, piped.output_size) == 0);
+  assert(result->errors_size == piped.errors_size &&
+         memcmp(result->errors, piped.errors, piped.errors_size) == 0);
+}
+
+/** @brief Testuje czytanie poleceń z pliku podanego jako argument.
+ * Porównuje wyjścia programu dla pliku i potoku z poleceniami,
+ * w tym bez znaku końca linii na końcu, dla pustego pliku oraz dla
+ * pliku dłuższego od bloku wejścia czytanego z potoku, z linią,
+ * która się w takim bloku nie mieści.
+ */
+static void test_command_file() {
+  static program_result result;
+  static const char commands[] = "B 3 2 2 2\nm 1 0 0\nm 2 1\0 1\np\nb 1";
+  run_file_and_pipe(commands, sizeof(commands) - 1, &result);
+  assert(has_output(&result, "OK 1\n1\n...\n1..\n", "ERROR 3\nERROR 5\n"));
+
+  static const char last_line[] = "B 3 2 2 2\nm 1 0 0\np";
+  run_file_and_pipe(last_line, sizeof(last_line) - 1, &result);
+  assert(has_output(&result, "OK 1\n1\n", "ERROR 3\n"));
+
+  run_file_and_pipe("", 0, &result);
+  assert(has_output(&result, "", ""));
+
+  // Komentarze zajmują kilka bloków wejścia, a ostatni z nich jest
+  // dłuższy od bloku.
+  const size_t short_comments = 500000, comments = 3000000;
+  static const char tail[] = "\nB 2 2 2 2\nm 2 1 1\nb 2\nq 3";
+  size_t size = comments + sizeof(tail) - 1;
+  char *long_commands = malloc(size);
+  assert(long_commands != NULL);
+  memset(long_commands, 'c', comments);
+  for (size_t i = 0; i <= short_comments; i += 100) {
+    long_commands[i] = '#';
+    if (i < short_comments) {
+      long_commands[i + 99] = '\n';
+    }
+  }
+  memcpy(long_commands + comments, tail, sizeof(tail) - 1);
+  run_file_and_pipe(long_commands, size, &result);
+  free(long_commands);
+  assert(has_output(&result, "OK 5002\n1\n1\n", "ERROR 5005\n"));
+}
+
+/** @brief Zapisuje liczbę w kolejności little-endian.
+ * @param[out] bytes     – tablica na @p size bajtów,
+ * @param[in] number     – liczba,
+ * @param[in] size       – liczba bajtów zapisu.
+ */
+static void write_le(char *bytes, uint64_t number, int size) {
+  for (int i = 0; i < size; i++) {
+    bytes[i] = (char) (number >> (8 * i));
+  }
+}
+
+/** @brief Testuje binarny tryb wsadowy.
+ * Wysyła rekordy poleceń w kolejności little-endian, w tym polecenie
+ * o nieznanym kodzie i niepełny rekord na końcu wejścia, i sprawdza
+ * linię OK oraz 8-bajtowe rekordy wyników.
+ */
+static void test_binary_mode() {
+  static const char header[] = "# binarny\nR 3 3 2 2\n";
+  static const uint32_t commands[][4] = {
+    {'m', 1, 0, 0}, {'m', 1, 0, 0}, {'b', 1, 0, 0}, {'f', 2, 7, 7},
+    {'x', 1, 1, 1}, {'m', 2, 1, 0}, {'g', 2, 0, 0}, {'q', 2, 0, 0},
+    {'b', 1, 0, 0}, {'b', 2, 0, 0}
+  };
+  static const uint64_t results[] = {1, 0, 1, 8, UINT64_MAX, 1, 1, 0, 0, 2};
+  const size_t count = sizeof(commands) / sizeof(commands[0]);
+  const size_t partial = 7;
+  char input[sizeof(header) - 1 + sizeof(commands) + 16];
+  memcpy(input, header, sizeof(header) - 1);
+  size_t size = sizeof(header) - 1;
+  for (size_t i = 0; i < count; i++) {
+    for (int j = 0; j < 4; j++) {
+      write_le(input + size, commands[i][j], 4);
+      size += 4;
+    }
+  }
+  // Początek rekordu bez reszty zostaje pominięty.
+  write_le(input + size, 'b', 4);
+  write_le(input + size + 4, 1, partial - 4);
+  size += partial;
+
+  static program_result result;
+  run_program(NULL, NULL, input, size, -1, &result);
+  static const char ok[] = "OK 2\n";
+  char expected[sizeof(ok) - 1 + sizeof(results)];
+  memcpy(expected, ok, sizeof(ok) - 1);
+  for (size_t i = 0; i < count; i++) {
+    write_le(expected + sizeof(ok) - 1 + 8 * i, results[i], 8);
+  }
+  assert(result.output_size == sizeof(expected) &&
+         memcmp(result.output, expected, sizeof(expected)) == 0);
+  assert(result.errors_size == 0);
+}
+
+/** @brief Czyta z deskryptora podaną liczbę linii.
+ * @param[in] fd         – deskryptor,
+ * @param[in] lines      – liczba linii.
+ */
+static void read_lines(int fd, int lines) {
+  char c;
+  while (lines > 0) {
+    assert(read(fd, &c, 1) == 1);
+    lines -= (c == '\n');
+  }
+}
+
+/** @brief Testuje zapis ostatniego ruchu dziennika, gdy brak poleceń.
+ * Dziennik grupuje do 100 ruchów bez ograniczenia czasu, ale program
+ * czekający na kolejne polecenie powinien zapisać już wykonany ruch.
+ * @param[in] option     – opcja programu lub NULL.
+ */
+static void test_idle_wal_sync(const char *option) {
+  FILE *journal = tmpfile();
+  assert(journal != NULL);
+  int input, output;
+  pid_t pid = start_program(option, NULL, &input, &output, NULL,
+                            fileno(journal));
+  const char commands[] = "B 5 5 2 2\nj 9 100 0\nm 1 0 0\n";
+  assert(write(input, commands, strlen(commands)) == (ssize_t) strlen(commands));
+  read_lines(output, 3);
+  struct stat journal_stat;
+  assert(fstat(fileno(journal), &journal_stat) == 0);
+  // Początek segmentu i jeden ruch, po 16 bajtów.
+  assert(journal_stat.st_size == 32);
+  close(input);
+  int status;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+  close(output);
+  fclose(journal);
+}
+
+/** @brief Czyta z deskryptora oczekiwany napis.
+ * @param[in] fd         – deskryptor,
+ * @param[in] text       – oczekiwany napis.
+ * @return Wartość @p true, jeśli przed upływem 5 sekund bez nowych danych
+ * przeczytano tyle bajtów, ile ma napis, i są one równe napisowi,
+ * a @p false w przeciwnym przypadku.
+ */
+static bool read_text(int fd, const char *text) {
+  static char data[PROGRAM_OUTPUT_SIZE];
+  size_t size = strlen(text), used = 0;
+  assert(size <= PROGRAM_OUTPUT_SIZE);
+  struct pollfd pipe_end = {.fd = fd, .events = POLLIN};
+  while (used < size && poll(&pipe_end, 1, 5000) == 1) {
+    ssize_t count = read(fd, data + used, size - used);
+    if (count <= 0) {
+      return false;
+    }
+    used += count;
+  }
+  return used == size && memcmp(data, text, size) == 0;
+}
+
+/** @brief Testuje wypisywanie serii błędów na potok.
+ * Gdy wyjście diagnostyczne jest potokiem, błędy są łączone w bufor,
+ * ale wszystkie, w kolejności linii, muszą zostać wypisane, zanim program
+ * zacznie czekać na kolejne polecenia.
+ * @param[in] option     – opcja programu lub NULL.
+ */
+static void test_error_burst(const char *option) {
+  int input, output, errors;
+  pid_t pid = start_program(option, NULL, &input, &output, &errors, -1);
+  static char commands[16 + 4 * 2000];
+  static char expected[16 * 2000];
+  strcpy(commands, "B 2 2 2 2\n");
+  expected[0] = '\0';
+  for (int i = 2; i <= 2001; i++) {
+    // Co druga linia ma poprawną postać, ale złą liczbę parametrów.
+    strcat(commands, i % 2 ? "x\n" : "m 1\n");
+    sprintf(expected + strlen(expected), "ERROR %d\n", i);
+  }
+  size_t size = strlen(commands);
+  assert(write(input, commands, size) == (ssize_t) size);
+  assert(read_text(output, "OK 1\n"));
+  assert(read_text(errors, expected));
+  const char move[] = "m 1 0 0\nm 3 0 0 0\n";
+  assert(write(input, move, strlen(move)) == (ssize_t) strlen(move));
+  assert(read_text(output, "1\n"));
+  assert(read_text(errors, "ERROR 2003\n"));
+  close(input);
+  int status;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+  close(output);
+  close(errors);
+}
+
+/** @brief Przepisuje dane z deskryptora do pliku aż do końca danych.
+ * @param[in] fd         – deskryptor,
+ * @param[in, out] file  – plik.
+ */
+static void copy_to_file(int fd, FILE *file) {
+  char data[65536];
+  ssize_t count;
+  while ((count = read(fd, data, sizeof(data))) > 0) {
+    assert(write(fileno(file), data, count) == count);
+  }
+  assert(count == 0);
+}
+
+/** @brief Testuje zapis gry w tle.
+ * Zapis trafia do potoku, z którego test nie czyta, dopóki nie sprawdzi,
+ * że drugi zapis w tle jest odrzucany, a gra przyjmuje kolejne ruchy.
+ * Następnie sprawdza linie postępu i zakończenia zapisu oraz wczytuje
+ * zapisany plik poleceniem l, które nie widzi ruchu wykonanego
+ * w trakcie zapisu.
+ */
+static void test_background_save() {
+  int snapshot_pipe[2];
+  assert(pipe(snapshot_pipe) == 0);
+  int input, output, errors;
+  pid_t pid = start_program(NULL, NULL, &input, &output, &errors,
+                            snapshot_pipe[1]);
+  close(snapshot_pipe[1]);
+  // Dane 100000 graczy nie mieszczą się w buforze potoku, więc zapis
+  // trwa, dopóki test nie zacznie go czytać.
+  const char commands[] = "B 10 10 100000 2\nm 1 0 0\nm 1 1 0\nm 2 5 5\n"
+                          "w 9\nw 9\nm 2 5 6\nb 2\n";
+  assert(write(input, commands, strlen(commands)) == (ssize_t) strlen(commands));
+  assert(read_text(output, "OK 1\n1\n1\n1\n1\n0\n1\n2\n"));
+
+  FILE *snapshot = tmpfile();
+  assert(snapshot != NULL);
+  static char progress[PROGRAM_OUTPUT_SIZE];
+  size_t progress_size = 0;
+  struct pollfd fds[2] = {{.fd = snapshot_pipe[0], .events = POLLIN},
+                          {.fd = errors, .events = POLLIN}};
+  while (strstr(progress, "100%\n") == NULL) {
+    assert(poll(fds, 2, 5000) > 0);
+    if (fds[0].revents != 0) {
+      char data[65536];
+      ssize_t count = read(snapshot_pipe[0], data, sizeof(data));
+      assert(count > 0);
+      assert(write(fileno(snapshot), data, count) == count);
+    }
+    if (fds[1].revents != 0) {
+      ssize_t count = read(errors, progress + progress_size,
+                           PROGRAM_OUTPUT_SIZE - 1 - progress_size);
+      assert(count > 0);
+      progress_size += count;
+      progress[progress_size] = '\0';
+    }
+  }
+  close(input);
+  char data;
+  assert(read(output, &data, 1) == 0);
+  while (progress_size < PROGRAM_OUTPUT_SIZE - 1) {
+    ssize_t count = read(errors, progress + progress_size,
+                         PROGRAM_OUTPUT_SIZE - 1 - progress_size);
+    assert(count >= 0);
+    if (count == 0) {
+      break;
+    }
+    progress_size += count;
+  }
+  progress[progress_size] = '\0';
+  int status;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+  close(output);
+  close(errors);
+  // Po zakończeniu programu potok zawiera resztę zapisu.
+  copy_to_file(snapshot_pipe[0], snapshot);
+  close(snapshot_pipe[0]);
+
+  // Wszystkie linie dotyczą tego samego procesu, procent rośnie do 100,
+  // a ostatnia linia informuje o pomyślnym zakończeniu zapisu.
+  char *line = progress;
+  long save_pid = -1;
+  int last_percent = -1;
+  while (true) {
+    char *end;
+    assert(strncmp(line, "SNAPSHOT ", 9) == 0);
+    long line_pid = strtol(line + 9, &end, 10);
+    assert(line_pid > 0 && (save_pid < 0 || line_pid == save_pid));
+    save_pid = line_pid;
+    if (strcmp(end, " DONE\n") == 0) {
+      break;
+    }
+    assert(*end == ' ');
+    int percent = strtol(end + 1, &end, 10);
+    assert(percent > last_percent && percent <= 100 &&
+           strncmp(end, "%\n", 2) == 0);
+    last_percent = percent;
+    line = end + 2;
+  }
+  assert(last_percent == 100);
+
+  assert(lseek(fileno(snapshot), 0, SEEK_SET) == 0);
+  static const char load[] = "B 1 1 1 1\nl 9\nb 1\nb 2\nm 2 5 6\nb 2\n";
+  static program_result result;
+  run_program(NULL, NULL, load, sizeof(load) - 1, fileno(snapshot), &result);
+  assert(has_output(&result, "OK 1\n1\n2\n1\n1\n2\n", ""));
+  fclose(snapshot);
+}
+
+/** @brief Czeka, aż na terminalu pojawi się napis.
+ * @param[in] fd         – deskryptor strony nadrzędnej pseudoterminala,
+ * @param[in] text       – oczekiwany napis.
+ * @return Wartość @p true, jeśli napis pojawił się przed upływem
+ * 5 sekund bez nowych danych, a @p false w przeciwnym przypadku.
+ */
+static bool wait_for_text(int fd, const char *text) {
+  static char screen[65536];
+  size_t used = 0;
+  struct pollfd terminal = {.fd = fd, .events = POLLIN};
+  while (poll(&terminal, 1, 5000) == 1) {
+    ssize_t count = read(fd, screen + used, sizeof(screen) - used - 1);
+    if (count <= 0) {
+      return false;
+    }
+    used += count;
+    screen[used] = '\0';
+    if (strstr(screen, text) != NULL) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** @brief Testuje wypisywanie komunikatów trybu interaktywnego.
+ * Uruchamia program na pseudoterminalu i sprawdza, czy komunikat
+ * o niemożliwym ruchu, niezakończony znakiem końca linii, pojawia się,
+ * zanim program zacznie czekać na kolejny klawisz.
+ */
+static void test_interactive_messages() {
+  int terminal = posix_openpt(O_RDWR | O_NOCTTY);
+  assert(terminal >= 0 && grantpt(terminal) == 0 && unlockpt(terminal) == 0);
+  const char *name = ptsname(terminal);
+  assert(name != NULL);
+  pid_t pid = fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    setsid();
+    int slave = open(name, O_RDWR);
+    struct winsize size = {.ws_row = 50, .ws_col = 120};
+    ioctl(slave, TIOCSWINSZ, &size);
+    dup2(slave, STDIN_FILENO);
+    dup2(slave, STDOUT_FILENO);
+    dup2(slave, STDERR_FILENO);
+    close(terminal);
+    execl(GAMMA_PROGRAM, GAMMA_PROGRAM, (char *) NULL);
+    _exit(EXIT_FAILURE);
+  }
+
+  const char command[] = "I 3 3 2 2\n";
+  assert(write(terminal, command, strlen(command)) == (ssize_t) strlen(command));
+  assert(wait_for_text(terminal, "TURN OF PLAYER 1"));
+  assert(write(terminal, " ", 1) == 1);
+  assert(wait_for_text(terminal, "TURN OF PLAYER 2"));
+  // Drugi gracz próbuje zająć to samo pole.
+  assert(write(terminal, " ", 1) == 1);
+  assert(wait_for_text(terminal, "MOVE NOT POSSIBLE. TRY AGAIN."));
+  kill(pid, SIGKILL);
+  assert(waitpid(pid, NULL, 0) == pid);
+  close(terminal);
+}
+#endif
+
 /** @brief Testuje silnik gry gamma.
  * Przeprowadza przykładowe testy silnika gry gamma.
  * @return Zero, gdy wszystkie testy przebiegły poprawnie,
@@ -95,5 +770,435 @@ int main() {
   free(p);
 
   gamma_delete(g);
+
+  uint64_t count;
+  uint32_t *targets;
+  g = gamma_new(3, 3, 2, 1);
+  assert(g != NULL);
+  assert(gamma_move(g, 1, 0, 1));
+  assert(gamma_move(g, 1, 1, 1));
+  assert(gamma_move(g, 1, 2, 1));
+  assert(gamma_move(g, 2, 1, 0));
+  targets = gamma_golden_targets(g, 2, &count);
+  assert(targets == NULL && count == 0);
+  assert(!gamma_golden_possible(g, 2));
+  assert(gamma_move(g, 2, 0, 0));
+  targets = gamma_golden_targets(g, 2, &count);
+  assert(count == 1 && targets[0] == 0 && targets[1] == 1);
+  free(targets);
+  assert(gamma_golden_possible(g, 2));
+  gamma_delete(g);
+
+  g = gamma_new(3, 3, 2, 1);
+  assert(g != NULL);
+  assert(!gamma_undo(g));
+  assert(gamma_undo_enable(g, true));
+  assert(!gamma_undo(g));
+  assert(gamma_move(g, 1, 0, 1));
+  assert(gamma_move(g, 1, 1, 1));
+  assert(gamma_move(g, 1, 2, 1));
+  assert(gamma_move(g, 2, 2, 0));
+  p = gamma_board(g);
+  assert(!gamma_golden_move(g, 2, 1, 1));
+  assert(gamma_golden_move(g, 2, 2, 1));
+  assert(gamma_busy_fields(g, 1) == 2);
+  assert(!gamma_golden_possible(g, 2));
+  assert(gamma_undo(g));
+  char *undone = gamma_board(g);
+  assert(strcmp(p, undone) == 0);
+  free(p);
+  free(undone);
+  assert(gamma_busy_fields(g, 1) == 3);
+  assert(gamma_free_fields(g, 1) == 5);
+  assert(gamma_golden_possible(g, 2));
+  for (int i = 0; i < 4; i++) {
+    assert(gamma_undo(g));
+  }
+  assert(!gamma_undo(g));
+  assert(gamma_busy_fields(g, 1) == 0);
+  assert(gamma_free_fields(g, 2) == 9);
+  gamma_delete(g);
+
+  g = gamma_new(5, 3, 2, 3);
+  assert(g != NULL);
+  assert(gamma_undo_enable(g, true));
+  assert(gamma_move(g, 1, 0, 0));
+  assert(gamma_move(g, 1, 2, 0));
+  assert(gamma_move(g, 1, 0, 2));
+  assert(gamma_move(g, 2, 3, 0));
+  assert(gamma_move(g, 2, 4, 0));
+  assert(gamma_move(g, 2, 3, 1));
+  assert(gamma_golden_possible(g, 1));
+  assert(gamma_move(g, 1, 1, 0));
+  assert(gamma_move(g, 1, 4, 2));
+  assert(gamma_golden_possible(g, 1));
+  assert(gamma_undo(g));
+  assert(gamma_undo(g));
+  assert(gamma_golden_possible(g, 1));
+  gamma_delete(g);
+
+  g = gamma_new(3, 2, 12, 2);
+  assert(g != NULL);
+  assert(gamma_board_view(NULL) == NULL);
+  assert(gamma_undo_enable(g, true));
+  const char *view = gamma_board_view(g);
+  assert(view != NULL && strcmp(view, ".  .  .  \n.  .  .  \n") == 0);
+  assert(gamma_move(g, 12, 2, 1));
+  assert(gamma_move(g, 3, 0, 0));
+  assert(gamma_board_view(g) == view);
+  assert(strcmp(view, ".  .  12 \n3  .  .  \n") == 0);
+  assert(gamma_golden_move(g, 3, 2, 1));
+  assert(strcmp(view, ".  .  3  \n3  .  .  \n") == 0);
+  p = gamma_board(g);
+  assert(p != view && strcmp(p, view) == 0);
+  free(p);
+  assert(gamma_undo(g));
+  assert(strcmp(view, ".  .  12 \n3  .  .  \n") == 0);
+  gamma_t *copy = gamma_clone(g);
+  assert(copy != NULL && gamma_move(copy, 1, 1, 1));
+  assert(strcmp(gamma_board_view(copy), ".  1  12 \n3  .  .  \n") == 0);
+  assert(strcmp(view, ".  .  12 \n3  .  .  \n") == 0);
+  gamma_delete(copy);
+  gamma_delete(g);
+
+  g = gamma_new(300, 300, 12, 5);
+  assert(g != NULL);
+  assert(!gamma_board_write(NULL, 1) && !gamma_board_write(g, -1));
+  for (uint32_t i = 0; i < 12 * 5; i++) {
+    assert(gamma_move(g, 1 + i % 12, 7 * i % 300, 299 - i));
+  }
+  p = gamma_board(g);
+  size_t length = strlen(p);
+  char *written = malloc(length + 1);
+  assert(written != NULL);
+  for (int cached = 0; cached < 2; cached++) {
+    FILE *board_file = tmpfile();
+    assert(board_file != NULL);
+    assert(gamma_board_write(g, fileno(board_file)));
+    assert(lseek(fileno(board_file), 0, SEEK_END) == (off_t) length);
+    assert(pread(fileno(board_file), written, length + 1, 0) ==
+           (ssize_t) length);
+    assert(memcmp(p, written, length) == 0);
+    fclose(board_file);
+    assert(gamma_board_view(g) != NULL);
+  }
+  free(written);
+  free(p);
+  gamma_delete(g);
+
+  uint32_t many_players[] = {1234, (1 << 20) + 5};
+  const char *many_boards[] = {
+    "1234 1234 \n1233 10   \n",
+    "1048581 1048581 \n1048580 10      \n"
+  };
+  for (int i = 0; i < 2; i++) {
+    g = gamma_new(2, 2, many_players[i], 1);
+    assert(g != NULL);
+    assert(gamma_move(g, many_players[i] - 1, 0, 0));
+    assert(gamma_move(g, 10, 1, 0));
+    assert(gamma_move(g, 5, 0, 1));
+    view = gamma_board_view(g);
+    assert(gamma_move(g, many_players[i], 1, 1));
+    assert(gamma_golden_move(g, many_players[i], 0, 1));
+    assert(strcmp(view, many_boards[i]) == 0);
+    gamma_delete(g);
+  }
+
+  g = gamma_new(100, 100, 2, 2);
+  assert(g != NULL);
+  assert(gamma_clone(NULL) == NULL);
+  assert(gamma_move(g, 1, 0, 0));
+  assert(gamma_move(g, 2, 99, 99));
+  copy = gamma_clone(g);
+  assert(copy != NULL);
+  p = gamma_board(g);
+  char *copied = gamma_board(copy);
+  assert(strcmp(p, copied) == 0);
+  free(copied);
+  assert(gamma_move(copy, 1, 1, 0));
+  assert(gamma_golden_move(copy, 2, 0, 0));
+  assert(gamma_busy_fields(copy, 1) == 1);
+  assert(gamma_busy_fields(g, 1) == 1);
+  assert(gamma_golden_possible(g, 2));
+  char *after = gamma_board(g);
+  assert(strcmp(p, after) == 0);
+  free(after);
+  free(p);
+  assert(gamma_move(g, 1, 99, 98));
+  assert(gamma_busy_fields(copy, 2) == 2);
+  gamma_delete(g);
+  assert(gamma_move(copy, 2, 98, 99));
+  assert(gamma_busy_fields(copy, 2) == 3);
+  gamma_delete(copy);
+
+  g = gamma_new(UINT32_MAX, UINT32_MAX, 12, 2);
+  assert(g != NULL);
+  assert(gamma_move(g, 1, UINT32_MAX - 1, UINT32_MAX - 1));
+  assert(gamma_move(g, 1, UINT32_MAX - 2, UINT32_MAX - 1));
+  assert(gamma_move(g, 1, UINT32_MAX - 3, UINT32_MAX - 1));
+  assert(gamma_move(g, 1, 5, 5));
+  assert(gamma_move(g, 2, 0, 0));
+  assert(!gamma_move(g, 1, 7, 7));
+  assert(gamma_busy_fields(g, 1) == 4);
+  assert(gamma_free_fields(g, 1) == 8);
+  assert(gamma_golden_possible(g, 2));
+  targets = gamma_golden_targets(g, 2, &count);
+  assert(targets != NULL && count == 3);
+  assert(targets[0] == 5 && targets[1] == 5);
+  assert(targets[2] == UINT32_MAX - 3 && targets[3] == UINT32_MAX - 1);
+  assert(targets[4] == UINT32_MAX - 1 && targets[5] == UINT32_MAX - 1);
+  free(targets);
+  copy = gamma_clone(g);
+  assert(copy != NULL);
+  assert(!gamma_golden_move(g, 2, UINT32_MAX - 2, UINT32_MAX - 1));
+  assert(gamma_golden_move(g, 2, UINT32_MAX - 1, UINT32_MAX - 1));
+  assert(gamma_board(g) == NULL);
+  assert(gamma_busy_fields(copy, 1) == 4);
+  assert(gamma_move(copy, 1, UINT32_MAX - 2, UINT32_MAX - 2));
+  assert(gamma_busy_fields(copy, 1) == 5);
+  assert(gamma_player_owned_areas(copy, 1) == 2);
+  FILE *snapshot = tmpfile();
+  assert(snapshot != NULL);
+  assert(gamma_save(copy, fileno(snapshot)));
+  gamma_delete(copy);
+  gamma_delete(g);
+  assert(lseek(fileno(snapshot), 0, SEEK_SET) == 0);
+  g = gamma_load(fileno(snapshot));
+  assert(g != NULL);
+  assert(gamma_busy_fields(g, 1) == 5);
+  assert(gamma_free_fields(g, 1) == 8);
+  assert(gamma_golden_possible(g, 2));
+  assert(gamma_golden_move(g, 2, UINT32_MAX - 1, UINT32_MAX - 1));
+  assert(gamma_player_owned_areas(g, 1) == 2);
+  gamma_delete(g);
+  assert(gamma_load(fileno(snapshot)) == NULL);
+  g = gamma_map(fileno(snapshot));
+  assert(g != NULL);
+  assert(gamma_busy_fields(g, 1) == 5);
+  assert(gamma_golden_move(g, 2, UINT32_MAX - 1, UINT32_MAX - 1));
+  assert(gamma_player_owned_areas(g, 1) == 2);
+  gamma_delete(g);
+  fclose(snapshot);
+
+  g = gamma_new(10, 10, 2, 3);
+  assert(g != NULL);
+  assert(gamma_move(g, 1, 0, 0));
+  assert(gamma_move(g, 1, 0, 1));
+  assert(gamma_move(g, 2, 5, 5));
+  snapshot = tmpfile();
+  assert(snapshot != NULL);
+  assert(gamma_save(g, fileno(snapshot)));
+  // Zapis małej planszy nie jest dopełniany do pełnego kafelka.
+  assert(lseek(fileno(snapshot), 0, SEEK_END) < 4096);
+  assert(lseek(fileno(snapshot), 0, SEEK_SET) == 0);
+  copy = gamma_load(fileno(snapshot));
+  assert(copy != NULL);
+  gamma_t *mapped = gamma_map(fileno(snapshot));
+  assert(mapped != NULL);
+  fclose(snapshot);
+  p = gamma_board(g);
+  copied = gamma_board(copy);
+  assert(strcmp(p, copied) == 0);
+  free(copied);
+  copied = gamma_board(mapped);
+  assert(strcmp(p, copied) == 0);
+  free(copied);
+  assert(gamma_golden_move(copy, 2, 0, 0));
+  assert(gamma_busy_fields(copy, 1) == 1);
+  assert(gamma_busy_fields(g, 1) == 2);
+  gamma_t *mapped_copy = gamma_clone(mapped);
+  assert(mapped_copy != NULL);
+  assert(gamma_move(mapped, 1, 0, 2));
+  assert(gamma_busy_fields(mapped, 1) == 3);
+  gamma_delete(mapped);
+  assert(gamma_busy_fields(mapped_copy, 1) == 2);
+  copied = gamma_board(mapped_copy);
+  assert(strcmp(p, copied) == 0);
+  free(copied);
+  free(p);
+  assert(gamma_golden_move(mapped_copy, 2, 0, 0));
+  assert(gamma_busy_fields(mapped_copy, 2) == 2);
+  gamma_delete(mapped_copy);
+  gamma_delete(copy);
+  // Uszkodzone pola odrzuca jedynie gamma_load, a cykl w zbiorze
+  // find and union sprawia, że korzystający z niego ruch się nie udaje.
+  snapshot = tmpfile();
+  assert(snapshot != NULL);
+  assert(gamma_save(g, fileno(snapshot)));
+  off_t first_field = lseek(fileno(snapshot), 0, SEEK_END) - 100 * 2 * sizeof(uint32_t);
+  uint32_t saved_field[2];
+  assert(pread(fileno(snapshot), saved_field, sizeof(saved_field), first_field) ==
+         sizeof(saved_field));
+  assert(saved_field[0] == 1);
+  off_t next_field = first_field + 10 * sizeof(saved_field);
+  uint32_t saved_next[2];
+  assert(pread(fileno(snapshot), saved_next, sizeof(saved_next), next_field) ==
+         sizeof(saved_next));
+  uint32_t corrupted[2] = {3, UINT32_MAX};
+  assert(pwrite(fileno(snapshot), corrupted, sizeof(uint32_t), first_field) ==
+         sizeof(uint32_t));
+  assert(lseek(fileno(snapshot), 0, SEEK_SET) == 0);
+  assert(gamma_load(fileno(snapshot)) == NULL);
+  // Pola (0, 0) i (0, 1) wskazują na siebie nawzajem.
+  uint32_t cycle[2][2] = {{1, (1u << 31) | 10}, {1, 1u << 31}};
+  assert(pwrite(fileno(snapshot), cycle, sizeof(cycle[0]), first_field) ==
+         sizeof(cycle[0]));
+  assert(pwrite(fileno(snapshot), cycle[1], sizeof(cycle[1]), next_field) ==
+         sizeof(cycle[1]));
+  for (int loaded = 0; loaded < 2; loaded++) {
+    assert(lseek(fileno(snapshot), 0, SEEK_SET) == 0);
+    mapped = loaded ? gamma_load(fileno(snapshot)) : gamma_map(fileno(snapshot));
+    assert(mapped != NULL);
+    assert(!gamma_move(mapped, 1, 1, 0) && !gamma_move(mapped, 1, 0, 2));
+    assert(gamma_move(mapped, 1, 5, 4) && gamma_busy_fields(mapped, 1) == 3);
+    gamma_delete(mapped);
+  }
+  assert(pwrite(fileno(snapshot), saved_field, sizeof(saved_field), first_field) ==
+         sizeof(saved_field));
+  assert(pwrite(fileno(snapshot), saved_next, sizeof(saved_next), next_field) ==
+         sizeof(saved_next));
+  mapped = gamma_map(fileno(snapshot));
+  assert(mapped != NULL);
+  assert(gamma_move(mapped, 1, 1, 0) && gamma_busy_fields(mapped, 1) == 3);
+  gamma_delete(mapped);
+  fclose(snapshot);
+  gamma_delete(g);
+  // Pełne kafelki są używane bezpośrednio z pliku bez sprawdzania.
+  g = gamma_new(100, 100, 2, 3);
+  assert(g != NULL);
+  assert(gamma_move(g, 1, 0, 0));
+  assert(gamma_move(g, 1, 0, 50));
+  assert(gamma_move(g, 2, 0, 99));
+  snapshot = tmpfile();
+  assert(snapshot != NULL);
+  assert(gamma_save(g, fileno(snapshot)));
+  gamma_delete(g);
+  size_t full_tile = sizeof(uint32_t) + 4096 * 2 * sizeof(uint32_t);
+  size_t last_tile = sizeof(uint32_t) + (10000 - 2 * 4096) * 2 * sizeof(uint32_t);
+  first_field = lseek(fileno(snapshot), 0, SEEK_END) - last_tile - 2 * full_tile +
+                sizeof(uint32_t);
+  assert(pread(fileno(snapshot), saved_field, sizeof(saved_field), first_field) ==
+         sizeof(saved_field));
+  assert(saved_field[0] == 1);
+  corrupted[0] = 1;
+  assert(pwrite(fileno(snapshot), corrupted, sizeof(corrupted), first_field) ==
+         sizeof(corrupted));
+  assert(lseek(fileno(snapshot), 0, SEEK_SET) == 0);
+  assert(gamma_load(fileno(snapshot)) == NULL);
+  mapped = gamma_map(fileno(snapshot));
+  assert(mapped != NULL);
+  assert(gamma_busy_fields(mapped, 1) == 2);
+  assert(gamma_busy_fields(mapped, 2) == 1);
+  // Rodzic spoza tablicy pól zostaje wykryty przy ruchu.
+  assert(!gamma_move(mapped, 1, 1, 0));
+  assert(gamma_move(mapped, 1, 0, 51));
+  gamma_delete(mapped);
+  fclose(snapshot);
+
+  g = gamma_new(5, 5, 2, 2);
+  assert(g != NULL);
+  FILE *journal = tmpfile();
+  assert(journal != NULL);
+  assert(!gamma_wal_open(g, fileno(journal), 0, 0));
+  assert(gamma_wal_open(g, fileno(journal), 2, 0));
+  assert(gamma_undo_enable(g, true));
+  assert(gamma_move(g, 1, 0, 0));
+  assert(!gamma_undo(g));
+  assert(gamma_move(g, 2, 4, 4));
+  assert(gamma_move(g, 1, 1, 0));
+  snapshot = tmpfile();
+  assert(snapshot != NULL);
+  assert(gamma_save(g, fileno(snapshot)));
+  assert(gamma_golden_move(g, 2, 1, 0));
+  assert(gamma_move(g, 1, 3, 3));
+  assert(gamma_wal_close(g));
+  assert(!gamma_wal_sync(g));
+  assert(lseek(fileno(snapshot), 0, SEEK_SET) == 0);
+  copy = gamma_load(fileno(snapshot));
+  assert(copy != NULL);
+  fclose(snapshot);
+  assert(lseek(fileno(journal), 0, SEEK_SET) == 0);
+  assert(gamma_wal_replay(copy, fileno(journal)));
+  p = gamma_board(g);
+  copied = gamma_board(copy);
+  assert(strcmp(p, copied) == 0);
+  free(copied);
+  assert(!gamma_golden_possible(copy, 2));
+  gamma_delete(copy);
+  // Uszkodzony ostatni ruch jest obcinany, a nowy segment trafia na jego miejsce.
+  assert(ftruncate(fileno(journal), lseek(fileno(journal), 0, SEEK_END) - 1) == 0);
+  assert(lseek(fileno(journal), 0, SEEK_SET) == 0);
+  copy = gamma_new(5, 5, 2, 2);
+  assert(copy != NULL);
+  assert(gamma_wal_replay(copy, fileno(journal)));
+  assert(gamma_busy_fields(copy, 1) == 1);
+  assert(gamma_wal_open(copy, fileno(journal), 1, 1000));
+  assert(gamma_move(copy, 1, 3, 3));
+  gamma_delete(copy);
+  assert(lseek(fileno(journal), 0, SEEK_SET) == 0);
+  copy = gamma_new(5, 5, 2, 2);
+  assert(copy != NULL);
+  assert(gamma_wal_replay(copy, fileno(journal)));
+  copied = gamma_board(copy);
+  assert(strcmp(p, copied) == 0);
+  free(copied);
+  free(p);
+  gamma_delete(copy);
+  fclose(journal);
+  gamma_delete(g);
+
+  gamma_replay_t *replay = gamma_replay_new(4, 4, 2, 2, 3);
+  assert(replay != NULL);
+  assert(gamma_replay_new(4, 4, 2, 2, 0) == NULL);
+  g = gamma_new(4, 4, 2, 2);
+  assert(g != NULL);
+  char *boards[8];
+  boards[0] = gamma_board(g);
+  const uint32_t moves[7][4] = {{1, 0, 0}, {2, 1, 1}, {1, 3, 3}, {2, 2, 2},
+                                {1, 0, 1}, {2, 0, 1, 1}, {1, 3, 2}};
+  for (int i = 0; i < 7; i++) {
+    if (moves[i][3]) {
+      assert(gamma_replay_golden_move(replay, moves[i][0], moves[i][1], moves[i][2]));
+      assert(gamma_golden_move(g, moves[i][0], moves[i][1], moves[i][2]));
+    }
+    else {
+      assert(gamma_replay_move(replay, moves[i][0], moves[i][1], moves[i][2]));
+      assert(gamma_move(g, moves[i][0], moves[i][1], moves[i][2]));
+    }
+    boards[i + 1] = gamma_board(g);
+  }
+  assert(!gamma_replay_move(replay, 1, 1, 1));
+  assert(gamma_replay_length(replay) == 7);
+  assert(gamma_replay_seek(replay, 8) == NULL);
+  const int seeks[] = {7, 2, 5, 6, 0, 4, 4, 1, 7};
+  for (size_t i = 0; i < sizeof(seeks) / sizeof(seeks[0]); i++) {
+    gamma_t *state = gamma_replay_seek(replay, seeks[i]);
+    assert(state != NULL);
+    p = gamma_board(state);
+    assert(strcmp(p, boards[seeks[i]]) == 0);
+    free(p);
+    if (seeks[i] == 4) {
+      assert(gamma_move(state, 2, 2, 1));
+    }
+  }
+  assert(gamma_busy_fields(gamma_replay_seek(replay, 6), 2) == 3);
+  for (int i = 0; i < 8; i++) {
+    free(boards[i]);
+  }
+  gamma_delete(g);
+  gamma_replay_delete(replay);
+
+#ifdef GAMMA_PROGRAM
+  test_batch_parser();
+  test_pipelined_batch_mode();
+  test_binary_mode();
+  test_command_file();
+  test_error_burst(NULL);
+  test_error_burst("-p");
+  test_background_save();
+  test_idle_wal_sync(NULL);
+  test_idle_wal_sync("-p");
+  test_interactive_messages();
+#endif
   return 0;
 }